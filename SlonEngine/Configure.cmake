@@ -14,6 +14,9 @@ IF (NOT SLON_ENGINE_CONFIGURE_INTRUSIVE)
 	OPTION (SLON_ENGINE_BUILD_TESTS "Set ON to build library tests" OFF)
 	MESSAGE ( "Build tests: " ${SLON_ENGINE_BUILD_TESTS} )
 
+	OPTION (SLON_ENGINE_BUILD_BENCHMARKS "Set ON to build library benchmarks, requires tests" OFF)
+	MESSAGE ( "Build benchmarks: " ${SLON_ENGINE_BUILD_BENCHMARKS} )
+
 	OPTION (INSTALL_EXAMPLES "Set to ON to install examples" OFF)
 	MESSAGE ("Install examples: " ${INSTALL_EXAMPLES})
     
@@ -32,6 +35,9 @@ MESSAGE ("Use SSE: " ${SLON_ENGINE_USE_SSE})
 OPTION (SLON_ENGINE_USE_DOUBLE_PRECISION_PHYSICS "Set to ON to use double precision physics" OFF)
 MESSAGE ("Use double precision physics: " ${SLON_ENGINE_USE_DOUBLE_PRECISION_PHYSICS})
 
+OPTION (SLON_ENGINE_THREAD_STATISTICS "Set to ON to collect lock contention statistics" OFF)
+MESSAGE ("Collect thread statistics: " ${SLON_ENGINE_THREAD_STATISTICS})
+
 OPTION_DEPENDENT_ON_PACKAGE ( SLON_ENGINE_USE_BULLET "Set ON to enable bullet physics support" BULLET_FOUND )
 MESSAGE ( "Using bullet physics: " ${SLON_ENGINE_USE_BULLET} )
 
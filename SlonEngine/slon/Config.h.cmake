@@ -14,6 +14,7 @@
 #cmakedefine SLON_ENGINE_USE_SSE4
 #cmakedefine SLON_ENGINE_USE_GNUPLOT
 #cmakedefine SLON_ENGINE_USE_DOUBLE_PRECISION_PHYSICS
+#cmakedefine SLON_ENGINE_THREAD_STATISTICS
 
 #ifdef SLON_ENGINE_BUILD_SHARED
 #   ifdef WIN32
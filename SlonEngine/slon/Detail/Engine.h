@@ -9,6 +9,8 @@
 #include "../FileSystem/Detail/FileSystemManager.h"
 #include "../Realm/World.h"
 #include "../Thread/Detail/ThreadManager.h"
+#include "../Thread/LockFreeQueue.h"
+#include "../Thread/ManualTimer.h"
 #include "../Thread/StartStopTimer.h"
 #ifdef SLON_ENGINE_USE_PHYSICS
 #   include "../Physics/Detail/PhysicsManager.h"
@@ -47,7 +49,7 @@ public:
     void setWorld(const realm::world_ptr& world_) { world = world_; }
 
     /** Get timer measuring time from start of the simulation. */
-    Timer& getSimulationTimer() { return *simulationTimer; }
+    Timer& getSimulationTimer() { return *activeTimer; }
 
     /** Get database manager */
     database::DatabaseManager& getDatabaseManager() { return databaseManager; }
@@ -72,7 +74,7 @@ public:
 	/** Get file system manager */
     filesystem::FileSystemManager& getFileSystemManager() { return *filesystemManager; }
 
-    /** Add node to update quene */
+    /** Add node to update quene. Lock free, can be called from any thread. */
     void addToUpdateQueue(scene::Node* node);
 
     /** Get singleton engine instance */
@@ -95,14 +97,15 @@ private:
     filesystem::detail::file_system_manager_ptr filesystemManager;
     realm::world_ptr						    world;
     start_stop_timer_ptr                        simulationTimer;
+    manual_timer_ptr                            frameTimer;     /// simulation time sampled once per frame, when recording or replaying
+    timer_ptr                                   activeTimer;
 #ifdef SLON_ENGINE_USE_PHYSICS
     physics::detail::PhysicsManager             physicsManager;
 #endif
     
     // node waiting update function to be called
-    update_queue updateQueue;
-    update_queue updateQueueTemp;
-    boost::mutex updateQueueMutex;
+    thread::mpsc_queue<scene::Node> updateQueue;
+    update_queue                    updateQueueTemp;
 
     // misc
     DESC    desc;
@@ -14,6 +14,7 @@
 #include "Realm/World.h"
 #include "Thread/ThreadManager.h"
 #include "Thread/Timer.h"
+#include <string>
 
 namespace slon {
 
@@ -25,12 +26,18 @@ class SLON_PUBLIC Engine
 public:
     struct DESC
     {
-        bool multithreaded;
-        bool grabInput;
+        bool    multithreaded;
+        bool    grabInput;
+        double  physicsTimeStep;        /// time step of the physics thread, if running multithreaded
+        double  maxPhysicsLag;          /// max number of steps physics thread may catch up, rest time is dropped
+        std::string recordFile;         /// record input events and frame times into the file
+        std::string replayFile;         /// replay input events and frame times from the file, engine stops when record is over
 
         DESC() :
             multithreaded(false),
-            grabInput(true)
+            grabInput(true),
+            physicsTimeStep(1.0 / 60.0),
+            maxPhysicsLag(3.0)
         {}
     };
 
@@ -50,7 +57,9 @@ public:
     /** Get the number of the frame */
     virtual unsigned int getFrameNumber() const = 0;
     
-    /** Get timer measuring time from start of the simulation. */
+    /** Get timer measuring time from start of the simulation. When recording or replaying
+     * input, time is constant during the frame.
+     */
     virtual Timer& getSimulationTimer() = 0;
 
     /** Get simulation world */
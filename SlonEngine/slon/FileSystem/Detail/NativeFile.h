@@ -29,6 +29,7 @@ public:
 	bool			eof() const;
 	std::streampos	tell() const; 
 	std::streamsize	size() const;
+	std::time_t		lastWriteTime() const;
 	std::streampos  seek(std::streamoff off, std::ios_base::seekdir way);
 
 	std::streamsize	read(char* buffer, std::streamsize size);
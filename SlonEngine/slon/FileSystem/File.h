@@ -3,6 +3,7 @@
 
 #include <boost/iostreams/categories.hpp>
 #include <boost/iostreams/stream_buffer.hpp>
+#include <ctime>
 #include "Node.h"
 
 namespace slon {
@@ -44,6 +45,9 @@ public:
 
 	virtual std::streamsize size() const = 0;
 
+	/** Get time of the last modification of the file, 0 if unknown. */
+	virtual std::time_t lastWriteTime() const = 0;
+
 	virtual std::streampos seek(std::streamoff off, std::ios_base::seekdir way) = 0;
 
 	virtual std::streamsize read(char* buffer, std::streamsize size) = 0;
@@ -0,0 +1,83 @@
+#ifndef __SLON_ENGINE_DEFERRED_RENDERER_H__
+#define __SLON_ENGINE_DEFERRED_RENDERER_H__
+
+#include "Detail/Pass.h"
+#include "ForwardRenderer.h"
+#include "LightingEffect.h"
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+/** DeferredRenderer writes material and normals of the opaque lit objects into the g-buffer,
+ * then accumulates lighting into the camera render target: directional lights are applied
+ * by full screen passes, point lights by rasterizing their bounding volumes, so a light shades
+ * only the pixels it covers. Transparent and unlit objects, reflections use the forward passes,
+ * drawn over the resolved g-buffer depth. G-buffer grows to the largest viewport rendered, the
+ * viewport occupies its corner. Spot lights are not supported: they are removed from the
+ * collected lights, warning is logged once.
+ */
+class DeferredRenderer :
+    public ForwardRenderer
+{
+public:
+    enum DEFERRED_RENDER_PASS
+    {
+        RP_GBUFFER = RP_CLUSTERED_LIGHTING + 1
+    };
+
+public:
+    DeferredRenderer(const DeferredRendererDesc& desc);
+
+    // Override Renderer
+    RENDER_TECHNIQUE    getRenderTechnique() const { return DEFERRED_SHADING; }
+    void                render(realm::World& world, const scene::Camera& mainCamera) const;
+
+private:
+    void initDeferred();
+
+    /** Grow g-buffer if it can't hold the viewport. */
+    void update_gbuffer(const sgl::rectangle& viewport) const;
+
+    /** Remove spot lights from the collected lights, deferred shading has no passes for them. */
+    void reject_spot_lights(light_type_vector& lightTypes) const;
+
+    void render_gbuffer(const scene::Camera& camera) const;
+
+    void render_light_volumes(const scene::Camera& camera) const;
+
+private:
+    DeferredRendererDesc                    deferredDesc;
+
+    // g-buffer
+    sgl::ref_ptr<sgl::SamplerState>         samplerState;
+    mutable sgl::ref_ptr<sgl::RenderTarget> gbufferTarget;
+    mutable sgl::ref_ptr<sgl::Texture2D>    diffuseSpecularMap;
+    mutable sgl::ref_ptr<sgl::Texture2D>    normalShininessMap;
+    mutable sgl::ref_ptr<sgl::Texture2D>    gbufferDepthMap;
+    mutable math::Vector4f                  gbufferScaleBias;
+    mutable math::Matrix4f                  lightVolumeMatrix;
+
+    binding_tex_2d_ptr                      diffuseSpecularMapBinder;
+    binding_tex_2d_ptr                      normalShininessMapBinder;
+    binding_tex_2d_ptr                      gbufferDepthMapBinder;
+    binding_vec4f_ptr                       gbufferScaleBiasBinder;
+    binding_mat4x4f_ptr                     lightVolumeMatrixBinder;
+
+    // screen quad followed by the sphere circumscribing unit sphere
+    sgl::ref_ptr<sgl::VertexBuffer>         volumeBuffer;
+    sgl::ref_ptr<sgl::VertexLayout>         volumeLayout;
+    unsigned                                numSphereVertices;
+
+    // lighting passes
+    pass_ptr                                resolvePass;
+    pass_ptr                                directionalPasses[LightingEffect::MAX_NUM_LIGHTS + 1];
+    pass_ptr                                pointPass;
+    mutable bool                            spotRejectLogged;
+};
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
+
+#endif // __SLON_ENGINE_DEFERRED_RENDERER_H__
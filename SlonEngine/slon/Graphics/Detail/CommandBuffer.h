@@ -0,0 +1,118 @@
+#ifndef __SLON_ENGINE_GRAPHICS_DETAIL_COMMAND_BUFFER_H__
+#define __SLON_ENGINE_GRAPHICS_DETAIL_COMMAND_BUFFER_H__
+
+#include <vector>
+#include "../../Utility/math.hpp"
+#include "../../Utility/Memory/linear_allocator.hpp"
+#include "../Effect.h"
+#include "RenderQueue.h"
+
+namespace slon {
+namespace graphics {
+
+// forward
+class Pass;
+class Renderable;
+
+namespace detail {
+
+/** Sequence of the compact draw, state and uniform commands recorded by the renderer instead of
+ * calling device while it traverses render packets. Recording only reads packets, so buffers
+ * can be recorded by several threads, each thread recording its own buffer. Buffers are
+ * replayed in order by the single command executor. @see CommandExecutor
+ */
+class CommandBuffer
+{
+public:
+    enum COMMAND_TYPE
+    {
+        PUSH_STATES,            /// save blend, depth stencil and rasterizer states of the device
+        POP_STATES,             /// restore saved states
+        INVALIDATE_TEXTURES,    /// forget textures bound by the state table
+        BEGIN_PASS,             /// bind states and upload changed uniforms of the pass
+        END_PASS,               /// finish pass
+        DRAW,                   /// draw renderable
+        BEGIN_WORLD_MATRICES,   /// bind world matrix parameter of the effect shared by the following packets
+        WORLD_MATRIX,           /// set world matrix of the following packet and present effect to update uniforms
+        END_WORLD_MATRICES,     /// restore effect world matrix parameter
+        NUM_COMMAND_TYPES
+    };
+
+    struct command
+    {
+        unsigned    type;       /// COMMAND_TYPE
+        unsigned    param;      /// render group in the high 16 bits, render pass in the low bits
+        const void* object;     /// pass, renderable, effect or world matrix of the command
+    };
+
+    typedef std::vector< command, linear_allocator<command> >   command_vector;
+    typedef command_vector::const_iterator                      const_iterator;
+
+public:
+    /** Create command buffer.
+     * @param arena - arena for the commands, 0 - use heap. Call release before resetting arena.
+     * Buffers recorded by the worker threads must use heap or arena of the thread.
+     */
+    explicit CommandBuffer(linear_arena* arena = 0);
+
+    /** Record commands rendering sorted packets. Packets having world matrix set it through the
+     * parameter of the effect before drawing, subsequent packets of the effect bind parameter once.
+     * @param renderGroup - render group of the packets.
+     * @param renderPass - render pass of the packets.
+     * @param firstPacket - first packet to record.
+     * @param endPacket - packet following the last one.
+     */
+    void recordPackets( render_group_handle         renderGroup,
+                        render_pass_handle          renderPass,
+                        RenderQueue::const_iterator firstPacket,
+                        RenderQueue::const_iterator endPacket );
+
+    void pushStates()                               { push(PUSH_STATES, 0, 0); }
+    void popStates()                                { push(POP_STATES, 0, 0); }
+    void invalidateTextures()                       { push(INVALIDATE_TEXTURES, 0, 0); }
+    void beginPass(const Pass* pass)                { push(BEGIN_PASS, 0, pass); }
+    void endPass(const Pass* pass)                  { push(END_PASS, 0, pass); }
+    void draw(const Renderable* renderable)         { push(DRAW, 0, renderable); }
+    void worldMatrix(const math::Matrix4f* m)       { push(WORLD_MATRIX, 0, m); }
+    void endWorldMatrices()                         { push(END_WORLD_MATRICES, 0, 0); }
+
+    /** Record binding of the world matrix parameter of the effect. */
+    void beginWorldMatrices(graphics::Effect* effect, render_group_handle renderGroup, render_pass_handle renderPass);
+
+    /** Get render group of the BEGIN_WORLD_MATRICES command. */
+    static render_group_handle getRenderGroup(const command& cmd) { return cmd.param >> 16; }
+
+    /** Get render pass of the BEGIN_WORLD_MATRICES command. */
+    static render_pass_handle getRenderPass(const command& cmd) { return cmd.param & 0xFFFF; }
+
+    /** Remove all commands. Keeps storage. */
+    void clear() { commands.clear(); }
+
+    /** Remove all commands and free storage. */
+    void release();
+
+    /** Get begin iterator of the commands */
+    const_iterator begin() const { return commands.begin(); }
+
+    /** Get end iterator of the commands */
+    const_iterator end() const { return commands.end(); }
+
+    /** Get number of recorded commands */
+    size_t size() const { return commands.size(); }
+
+private:
+    void push(COMMAND_TYPE type, unsigned param, const void* object)
+    {
+        command cmd = { type, param, object };
+        commands.push_back(cmd);
+    }
+
+private:
+    command_vector  commands;
+};
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
+
+#endif // __SLON_ENGINE_GRAPHICS_DETAIL_COMMAND_BUFFER_H__
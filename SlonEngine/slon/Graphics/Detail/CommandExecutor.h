@@ -0,0 +1,89 @@
+#ifndef __SLON_ENGINE_GRAPHICS_DETAIL_COMMAND_EXECUTOR_H__
+#define __SLON_ENGINE_GRAPHICS_DETAIL_COMMAND_EXECUTOR_H__
+
+#include <algorithm>
+#include "../../Thread/StartStopTimer.h"
+#include "../ParameterBinding.h"
+#include "CommandBuffer.h"
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+/** Replays recorded command buffers. Executor is used by the single thread owning the device. */
+class CommandExecutor
+{
+public:
+    struct STATISTICS
+    {
+        size_t  numBuffers;                                     /// number of executed buffers
+        size_t  numCommands[CommandBuffer::NUM_COMMAND_TYPES];  /// number of executed commands of every type
+        double  executeTime;                                    /// time spent executing buffers, seconds
+
+        STATISTICS()
+        :   numBuffers(0)
+        ,   executeTime(0.0)
+        {
+            std::fill(numCommands, numCommands + CommandBuffer::NUM_COMMAND_TYPES, 0);
+        }
+    };
+
+public:
+    /** Execute commands of the buffer, count them. */
+    void execute(const CommandBuffer& commandBuffer);
+
+    /** Get statistics accumulated since last reset. */
+    const STATISTICS& getStatistics() const { return statistics; }
+
+    /** Reset statistics. */
+    void resetStatistics() { statistics = STATISTICS(); }
+
+    virtual ~CommandExecutor() {}
+
+protected:
+    /** Perform single command. */
+    virtual void executeCommand(const CommandBuffer::command& cmd) = 0;
+
+private:
+    StartStopTimer  timer;
+    STATISTICS      statistics;
+};
+
+/** Executor performing commands using sgl device. */
+class SGLCommandExecutor :
+    public CommandExecutor
+{
+public:
+    /** Create executor.
+     * @param worldMatrixBinder - binder setting world matrices of the packets, 0 - use effect world matrix.
+     */
+    explicit SGLCommandExecutor(binding_mat4x4f* worldMatrixBinder);
+
+protected:
+    // Override CommandExecutor
+    void executeCommand(const CommandBuffer::command& cmd);
+
+private:
+    binding_mat4x4f*            worldMatrixBinder;
+
+    // effect having world matrix parameter bound to the binder
+    graphics::Effect*           matrixEffect;
+    render_group_handle         matrixRenderGroup;
+    render_pass_handle          matrixRenderPass;
+    const_binding_mat4x4f_ptr   effectWorldMatrix;
+};
+
+/** Executor only counting commands, measures CPU cost of the recording without device. */
+class NullCommandExecutor :
+    public CommandExecutor
+{
+protected:
+    // Override CommandExecutor
+    void executeCommand(const CommandBuffer::command& /*cmd*/) {}
+};
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
+
+#endif // __SLON_ENGINE_GRAPHICS_DETAIL_COMMAND_EXECUTOR_H__
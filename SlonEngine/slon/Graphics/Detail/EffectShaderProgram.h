@@ -94,6 +94,9 @@ public:
                 if ( shaders[i] < rhs.shaders[i] ) {
                     return true;
                 }
+                else if ( shaders[i] > rhs.shaders[i] ) {
+                    return false;
+                }
             }
 
             return false;
@@ -113,6 +116,69 @@ public:
 
     typedef sgl::ref_ptr<sgl::Program>                          program_ptr;
     typedef std::vector<detail::AttributeTable::binding_ptr>    binding_vector;
+    typedef std::vector<uber_program_hash>                      program_manifest;
+
+    struct CACHE_STATISTICS
+    {
+        size_t  numSourceReads;     /// number of shader files read from the file system
+        size_t  numSourceHits;      /// number of shader sources taken from the source cache
+        size_t  numPrograms;        /// number of compiled uber programs
+        size_t  numProgramHits;     /// number of uber programs taken from the program cache
+        double  compileTime;        /// time spent compiling uber programs, seconds
+
+        CACHE_STATISTICS()
+        :   numSourceReads(0)
+        ,   numSourceHits(0)
+        ,   numPrograms(0)
+        ,   numProgramHits(0)
+        ,   compileTime(0.0)
+        {}
+    };
+
+public:
+    /** Drop preprocessed shader sources. Sources are also reread if modification time
+     * of the shader file changes. Compiled programs are kept.
+     */
+    static void clearSourceCache();
+
+    /** Read shader file into the source cache unless it is cached with the same modification time.
+     * @return true if file was read from the file system.
+     */
+    static bool cacheSource(const std::string& fileName);
+
+    /** Save uber programs requested by the effects during the session, in order of the first
+     * request. Manifest is a text file, program is a list of definitions followed by the
+     * shader file names, programs are separated by empty line.
+     * @return true if manifest is saved.
+     */
+    static bool saveManifest(const std::string& fileName);
+
+    /** Save uber programs into the manifest. @see saveManifest */
+    static bool saveManifest(const std::string& fileName, const program_manifest& programs);
+
+    /** Append uber programs requested during the session to the manifest, programs of the
+     * previous sessions are kept. Manifest is created if it doesn't exist.
+     * @return true if manifest is up to date.
+     */
+    static bool updateManifest(const std::string& fileName);
+
+    /** Read uber programs listed in the manifest.
+     * @return false if manifest can't be opened.
+     */
+    static bool loadManifest(const std::string& fileName, program_manifest& programs);
+
+    /** Compile uber programs listed in the manifest, so effects don't compile them on
+     * the first use. Programs failing to compile are logged and skipped. Renderers warm up
+     * "Data/Shaders/manifest" on init if it exists and update it on engine shutdown.
+     * @return number of compiled programs.
+     */
+    static size_t warmup(const std::string& fileName);
+
+    /** Get statistics of the shader source and program caches. */
+    static const CACHE_STATISTICS& getCacheStatistics();
+
+    /** Reset statistics of the shader source and program caches. */
+    static void resetCacheStatistics();
 
 public:
     /** Can throw shader_error, file_not_found_error. Log compilation status if it is not empty. */
@@ -5,6 +5,7 @@
 #include "../GraphicsManager.h"
 #include "../Renderer.h"
 #include "AttributeTable.h"
+#include "StateTable.h"
 #include "UniformTable.h"
 
 namespace slon {
@@ -29,6 +30,9 @@ public:
 
     graphics::Renderer* initRenderer(const ForwardRendererDesc& desc);
     graphics::Renderer* initRenderer(const FFPRendererDesc& desc);
+    graphics::Renderer* initRenderer(const DeferredRendererDesc& desc);
+    graphics::Renderer* initHeadlessRenderer(const ForwardRendererDesc& desc);
+    graphics::Renderer* initHeadlessRenderer(const DeferredRendererDesc& desc);
 
     void            setRenderingSurface(Surface& surface);
     const Surface&  getCurrentRenderingSurface();
@@ -60,6 +64,9 @@ public:
     /** Get uniform table used by effects. */
     detail::UniformTable& getUniformTable() { return *uniformTable; }
 
+    /** Get state table filtering redundant state changes. */
+    detail::StateTable& getStateTable() { return *stateTable; }
+
     // Called by Engine
     void render(realm::World& world);
 
@@ -78,6 +85,7 @@ private:
     detail::attribute_table_ptr attributeTable;
     detail::parameter_table_ptr parameterTable;
     detail::uniform_table_ptr   uniformTable;
+    detail::state_table_ptr     stateTable;
     renderer_ptr                renderer;
     camera_vector               cameras;
 
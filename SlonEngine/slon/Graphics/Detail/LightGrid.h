@@ -0,0 +1,113 @@
+#ifndef __SLON_ENGINE_GRAPHICS_DETAIL_LIGHT_GRID_H__
+#define __SLON_ENGINE_GRAPHICS_DETAIL_LIGHT_GRID_H__
+
+#include <vector>
+#include "../../Thread/StartStopTimer.h"
+#include "../../Utility/math.hpp"
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+/** Grid of the view space clusters (froxels) with the lists of the point lights affecting them.
+ * Clusters split the screen into cluster_x * cluster_y tiles and view depth into cluster_z
+ * exponential slices. Lights are binned by the screen rect and depth range of their spheres.
+ * Grid is stored as texels ready for the upload into RGBA32F textures: grid map texel
+ * (x + z * cluster_x, y) keeps offset and number of the cluster lights in the index map,
+ * index map texel keeps light index in the red channel.
+ */
+class LightGrid
+{
+public:
+    static const unsigned cluster_x       = 16;
+    static const unsigned cluster_y       = 8;
+    static const unsigned cluster_z       = 16;
+    static const unsigned grid_map_width  = cluster_x * cluster_z;
+    static const unsigned index_map_width = 256;
+
+    struct STATISTICS
+    {
+        size_t  numLights;          /// number of binned lights
+        size_t  numLightIndices;    /// number of light indices in the cluster lists
+        size_t  numBinnings;        /// number of grid builds
+        double  binTime;            /// time spent binning lights, seconds
+
+        STATISTICS()
+        :   numLights(0)
+        ,   numLightIndices(0)
+        ,   numBinnings(0)
+        ,   binTime(0.0)
+        {}
+    };
+
+public:
+    LightGrid();
+
+    /** Setup view frustum of the grid.
+     * @param projection - projection matrix of the camera, camera looks along -z in view space.
+     */
+    void setProjection(const math::Matrix4f& projection);
+
+    /** Bin lights into the clusters.
+     * @param viewPositionRadius - view space positions and radii of the point lights.
+     * @param numLights - number of lights.
+     */
+    void bin(const math::Vector4f* viewPositionRadius, size_t numLights);
+
+    /** Get offset of the cluster light list in the index map. */
+    unsigned getClusterOffset(unsigned x, unsigned y, unsigned z) const { return unsigned( gridMap[y * grid_map_width + z * cluster_x + x].x ); }
+
+    /** Get number of lights affecting the cluster. */
+    unsigned getClusterLightCount(unsigned x, unsigned y, unsigned z) const { return unsigned( gridMap[y * grid_map_width + z * cluster_x + x].y ); }
+
+    /** Get light index from the cluster light lists. */
+    unsigned getLightIndex(unsigned i) const { return unsigned( indexMap[i].x ); }
+
+    /** Get depth slice containing view depth. */
+    unsigned getSlice(float depth) const;
+
+    /** Get texels of the grid map, grid_map_width * cluster_y texels. */
+    const math::Vector4f* getGridMap() const { return &gridMap[0]; }
+
+    /** Get texels of the index map, index_map_width * getIndexMapHeight() texels. */
+    const math::Vector4f* getIndexMap() const { return &indexMap[0]; }
+
+    /** Get height of the index map. */
+    unsigned getIndexMapHeight() const { return unsigned(indexMap.size() / index_map_width); }
+
+    /** Get depth parameters for the cluster lookup in the shader:
+     * (1 / near, cluster_z / log(far / near), cluster_z, cluster_x).
+     */
+    math::Vector4f getDepthParams() const;
+
+    /** Get statistics accumulated since last reset. */
+    const STATISTICS& getStatistics() const { return statistics; }
+
+    /** Reset statistics. */
+    void resetStatistics() { statistics = STATISTICS(); }
+
+private:
+    typedef std::vector<math::Vector4f>  texel_vector;
+    typedef std::vector<unsigned>        unsigned_vector;
+
+private:
+    math::Matrix4f  projection;
+    float           zNear;
+    float           zFar;
+    float           sliceScale;
+
+    // grid
+    texel_vector    gridMap;
+    texel_vector    indexMap;
+    unsigned_vector lightRects;
+
+    // statistics
+    StartStopTimer  timer;
+    STATISTICS      statistics;
+};
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
+
+#endif // __SLON_ENGINE_GRAPHICS_DETAIL_LIGHT_GRID_H__
@@ -0,0 +1,120 @@
+#ifndef __SLON_ENGINE_GRAPHICS_DETAIL_RENDER_QUEUE_H__
+#define __SLON_ENGINE_GRAPHICS_DETAIL_RENDER_QUEUE_H__
+
+#include <vector>
+#include "../../Thread/StartStopTimer.h"
+#include "../../Utility/math.hpp"
+#include "../../Utility/Memory/linear_allocator.hpp"
+
+namespace slon {
+namespace graphics {
+
+// forward
+class Pass;
+class Renderable;
+
+namespace detail {
+
+/** Queue of the render packets sorted by packed 64 bit keys. Key layout, from the highest bits:
+ * bin(4), render pass(4), then for the first (opaque) bin: program(20), pass(16), depth(20) -
+ * packets are grouped by state and rendered front to back within the group;
+ * for the other (transparent) bins: inverted depth(24), program(20), pass(12) - packets
+ * are rendered back to front. Queue is sorted using radix sort.
+ */
+class RenderQueue
+{
+public:
+    typedef unsigned long long key_type;
+
+    struct render_packet
+    {
+        key_type                key;
+        const Pass*             pass;
+        const Renderable*       renderable;
+        const math::Matrix4f*   worldMatrix;
+    };
+
+    typedef std::vector< render_packet, 
+                         linear_allocator<render_packet> >  render_packet_vector;
+    typedef render_packet_vector::const_iterator    const_iterator;
+
+    struct STATISTICS
+    {
+        size_t  numPackets;         /// number of sorted packets
+        size_t  numProgramSwitches; /// number of program changes between subsequent packets
+        size_t  numPassSwitches;    /// number of pass changes between subsequent packets
+        double  sortTime;           /// time spent sorting, seconds
+
+        STATISTICS()
+        :   numPackets(0)
+        ,   numProgramSwitches(0)
+        ,   numPassSwitches(0)
+        ,   sortTime(0.0)
+        {}
+    };
+
+public:
+    /** Create render queue.
+     * @param arena - arena for the packets, 0 - use heap. Call release before resetting arena.
+     */
+    explicit RenderQueue(linear_arena* arena = 0);
+
+    /** Make key of the render packet.
+     * @param renderPass - render pass handle, only 4 lower bits are used.
+     * @param priority - priority of the pass, @see ForwardRenderer::makePriority.
+     * @param pass - pass of the packet.
+     * @param depth - view space depth of the renderable.
+     */
+    static key_type makeKey(unsigned renderPass, long long priority, const Pass* pass, float depth);
+
+    /** Get bin from the render packet key. */
+    static unsigned getBin(key_type key) { return unsigned(key >> 60); }
+
+    /** Get program identifier from the render packet key. Different programs may share identifier. */
+    static unsigned getProgramId(key_type key);
+
+    /** Remove all packets. Keeps storage. */
+    void clear() { packets.clear(); }
+
+    /** Remove all packets and free storage. */
+    void release();
+
+    /** Add packet to the queue.
+     * @param worldMatrix - world matrix of the renderable shared by several nodes, 0 if renderable binds its own.
+     */
+    void push(key_type key, const Pass* pass, const Renderable* renderable, const math::Matrix4f* worldMatrix = 0)
+    {
+        render_packet packet = { key, pass, renderable, worldMatrix };
+        packets.push_back(packet);
+    }
+
+    /** Sort queued packets by key, count state switches of the sorted queue. */
+    void sort();
+
+    /** Get begin iterator of the packets */
+    const_iterator begin() const { return packets.begin(); }
+
+    /** Get end iterator of the packets */
+    const_iterator end() const { return packets.end(); }
+
+    /** Get number of queued packets */
+    size_t size() const { return packets.size(); }
+
+    /** Get statistics accumulated since last reset. */
+    const STATISTICS& getStatistics() const { return statistics; }
+
+    /** Reset statistics. */
+    void resetStatistics() { statistics = STATISTICS(); }
+
+private:
+    render_packet_vector    packets;
+    render_packet_vector    sortBuffer;
+    StartStopTimer          sortTimer;
+    STATISTICS              statistics;
+};
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
+
+#endif // __SLON_ENGINE_GRAPHICS_DETAIL_RENDER_QUEUE_H__
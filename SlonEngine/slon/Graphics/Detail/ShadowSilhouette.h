@@ -0,0 +1,162 @@
+#ifndef __SLON_ENGINE_GRAPHICS_DETAIL_SHADOW_SILHOUETTE_H__
+#define __SLON_ENGINE_GRAPHICS_DETAIL_SHADOW_SILHOUETTE_H__
+
+#include <sgl/Math/Containers.hpp>
+#include <vector>
+#include "../../Thread/StartStopTimer.h"
+#include "../../Utility/math.hpp"
+
+namespace slon {
+
+// forward
+namespace thread {
+    class ThreadPool;
+}
+
+namespace graphics {
+namespace detail {
+
+/** Builds shadow volume geometry of the triangle mesh on CPU. Face planes and edge adjacency
+ * are computed once, then for every light position faces are classified as lit or unlit
+ * (4 faces at once with SSE) and only the silhouette edges are extruded. Volume is stored
+ * as a triangle list of homogeneous object space vertices, extruded vertices have w = 0,
+ * so they are projected to infinity by the regular transform. Volume is rebuilt only if the
+ * object space light position changes, so static lights and objects reuse it.
+ */
+class ShadowSilhouette
+{
+public:
+    static const unsigned invalid_face = ~0u;
+
+    struct edge
+    {
+        unsigned    v0;     /// first vertex, edge goes from v0 to v1 in face0
+        unsigned    v1;     /// second vertex
+        unsigned    face0;  /// face containing the edge
+        unsigned    face1;  /// opposite face or invalid_face if edge is open
+    };
+
+    typedef std::vector<edge>   edge_vector;
+
+    struct STATISTICS
+    {
+        size_t  numExtractions;     /// number of rebuilt volumes
+        size_t  numCached;          /// number of requests served by the cached volume
+        size_t  numSilhouetteEdges; /// number of extruded edges
+        size_t  numTriangles;       /// number of emitted volume triangles
+        double  extractTime;        /// time spent rebuilding volumes, seconds
+        double  setupTime;          /// time spent computing planes and adjacency, seconds
+
+        STATISTICS()
+        :   numExtractions(0)
+        ,   numCached(0)
+        ,   numSilhouetteEdges(0)
+        ,   numTriangles(0)
+        ,   extractTime(0.0)
+        ,   setupTime(0.0)
+        {}
+    };
+
+public:
+    ShadowSilhouette();
+
+    /** Compute face planes and edge adjacency of the mesh. Half edges of the faces are sorted
+     * by their vertex pair, then half edges of opposite orientation within the same pair are
+     * matched. Faces and runs of the sorted half edges are processed by the pool concurrently.
+     * Unmatched half edges of open and non manifold edges become open edges, extruded 
+     * whenever their face is lit.
+     * @param pool - thread pool performing setup.
+     * @param vertices - object space positions.
+     * @param numVertices - number of vertices.
+     * @param indices - triangle list indices.
+     * @param numIndices - number of indices.
+     */
+    void setup( thread::ThreadPool&     pool,
+                const math::Vector3f*   vertices, 
+                size_t                  numVertices, 
+                const unsigned*         indices, 
+                size_t                  numIndices );
+
+    /** Call setup using engine thread pool. */
+    void setup(const math::Vector3f* vertices, size_t numVertices, const unsigned* indices, size_t numIndices);
+
+    /** Build shadow volume for the light, does nothing if volume for the same light is cached.
+     * @param lightPosition - object space position of the point light (w = 1) or
+     * direction to the directional light (w = 0).
+     * @param caps - emit front and back caps, required for depth fail shadows.
+     * @return true if volume was rebuilt.
+     */
+    bool extract(const math::Vector4f& lightPosition, bool caps = true);
+
+    /** Drop cached volume. */
+    void invalidate() { valid = false; }
+
+    /** Get edges of the mesh. */
+    const edge_vector& getEdges() const { return edges; }
+
+    /** Get number of faces of the mesh. */
+    size_t getNumFaces() const { return numFaces; }
+
+    /** Get number of edges having single face. */
+    size_t getNumOpenEdges() const { return numOpenEdges; }
+
+    /** Get number of vertex pairs shared by more than two faces. */
+    size_t getNumNonManifoldEdges() const { return numNonManifoldEdges; }
+
+    /** Check whether face is lit by the last extracted light. */
+    bool isLit(unsigned face) const { return ( (facing[face >> 2] >> (face & 3)) & 1 ) != 0; }
+
+    /** Get number of silhouette edges of the last extracted volume. */
+    size_t getNumSilhouetteEdges() const { return numSilhouetteEdges; }
+
+    /** Get vertices of the volume triangles. */
+    const math::Vector4f* getVertices() const { return vertices.empty() ? 0 : &vertices[0]; }
+
+    /** Get number of vertices of the volume triangles. */
+    size_t getNumVertices() const { return vertices.size(); }
+
+    /** Get statistics accumulated since last reset. */
+    const STATISTICS& getStatistics() const { return statistics; }
+
+    /** Reset statistics. */
+    void resetStatistics() { statistics = STATISTICS(); }
+
+private:
+    typedef std::vector<float>          float_vector;
+    typedef std::vector<unsigned char>  mask_vector;
+
+private:
+    void classifyFaces(const math::Vector4f& lightPosition);
+
+    math::Vector4f extrude(const math::Vector3f& v) const;
+
+private:
+    // mesh
+    math::vector_of_vector3f    positions;
+    std::vector<unsigned>       indices;
+    size_t                      numFaces;
+    edge_vector                 edges;
+    size_t                      numOpenEdges;
+    size_t                      numNonManifoldEdges;
+
+    // face planes, 4 faces per block: x0 x1 x2 x3 y0 ... w3
+    float_vector                planes;
+
+    // volume
+    mask_vector                 facing;
+    math::vector_of_vector4f    vertices;
+    math::Vector4f              light;
+    bool                        lightCaps;
+    bool                        valid;
+    size_t                      numSilhouetteEdges;
+
+    // statistics
+    StartStopTimer              timer;
+    STATISTICS                  statistics;
+};
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
+
+#endif // __SLON_ENGINE_GRAPHICS_DETAIL_SHADOW_SILHOUETTE_H__
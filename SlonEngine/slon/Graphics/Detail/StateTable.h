@@ -1,25 +1,152 @@
-#ifndef __SLON_ENGINE_GRAPHICS_STATE_TABLE_H__
-#define __SLON_ENGINE_GRAPHICS_STATE_TABLE_H__
+#ifndef __SLON_ENGINE_GRAPHICS_DETAIL_STATE_TABLE_H__
+#define __SLON_ENGINE_GRAPHICS_DETAIL_STATE_TABLE_H__
 
+#include <sgl/BlendState.h>
+#include <sgl/DepthStencilState.h>
+#include <sgl/Program.h>
+#include <sgl/RasterizerState.h>
+#include <sgl/Texture.h>
+#include <map>
+#include <vector>
 #include "../../Utility/referenced.hpp"
 #include <boost/intrusive_ptr.hpp>
 
 namespace slon {
 namespace graphics {
+namespace detail {
 
+/** Tracks device states bound by the passes and filters redundant state changes. States
+ * with equal descriptions are shared, so passes of the different effects using same states
+ * don't rebind them. Descriptions are compared field by field, fields of the disabled blending
+ * and depth test are ignored. Descriptions with enabled stencil test are compared bytewise,
+ * so zero them before filling to share the states. Table tracks textures bound to the
+ * stages by the sampler uniforms and keeps them referenced, so address of the tracked texture
+ * can't be reused. Anyone binding textures bypassing the table must call invalidateTextures.
+ */
 class StateTable :
     public Referenced
 {
+public:
+    static const unsigned max_texture_stages = 32;
 
+    struct STATISTICS
+    {
+        size_t  numIssuedStateChanges;    /// number of program, blend, depth stencil and rasterizer states bound
+        size_t  numSkippedStateChanges;   /// number of program, blend, depth stencil and rasterizer states already bound
+        size_t  numIssuedSamplerBinds;    /// number of textures bound to the sampler uniforms
+        size_t  numSkippedSamplerBinds;   /// number of textures already bound to the sampler uniforms
+        size_t  numUniformUploads;        /// number of uniform values uploaded to the programs
+        size_t  numSkippedUniformUploads; /// number of uniform uploads skipped because program has same values
+
+        STATISTICS()
+        :   numIssuedStateChanges(0)
+        ,   numSkippedStateChanges(0)
+        ,   numIssuedSamplerBinds(0)
+        ,   numSkippedSamplerBinds(0)
+        ,   numUniformUploads(0)
+        ,   numSkippedUniformUploads(0)
+        {}
+    };
+
+private:
+    struct blend_desc_less
+    {
+        bool operator () (const sgl::BlendState::DESC& a, const sgl::BlendState::DESC& b) const;
+    };
+
+    struct depth_stencil_desc_less
+    {
+        bool operator () (const sgl::DepthStencilState::DESC& a, const sgl::DepthStencilState::DESC& b) const;
+    };
+
+    struct rasterizer_desc_less
+    {
+        bool operator () (const sgl::RasterizerState::DESC& a, const sgl::RasterizerState::DESC& b) const;
+    };
+
+    typedef std::map< sgl::BlendState::DESC,
+                      sgl::ref_ptr<sgl::BlendState>,
+                      blend_desc_less >                                 blend_state_map;
+    typedef std::map< sgl::DepthStencilState::DESC,
+                      sgl::ref_ptr<sgl::DepthStencilState>,
+                      depth_stencil_desc_less >                         depth_stencil_state_map;
+    typedef std::map< sgl::RasterizerState::DESC,
+                      sgl::ref_ptr<sgl::RasterizerState>,
+                      rasterizer_desc_less >                            rasterizer_state_map;
+
+public:
+    StateTable();
+
+    /** Get blend state with specified description, create if not exists. */
+    const sgl::BlendState* createBlendState(const sgl::BlendState::DESC& desc);
+
+    /** Get depth stencil state with specified description, create if not exists. */
+    const sgl::DepthStencilState* createDepthStencilState(const sgl::DepthStencilState::DESC& desc);
+
+    /** Get rasterizer state with specified description, create if not exists. */
+    const sgl::RasterizerState* createRasterizerState(const sgl::RasterizerState::DESC& desc);
+
+    /** Bind program if it is not bound. Unbinds current program if program is 0. */
+    void bindProgram(const sgl::Program* program);
+
+    /** Bind blend state if it is not bound. */
+    void bindBlendState(const sgl::BlendState* blendState);
+
+    /** Bind depth stencil state if it is not bound. */
+    void bindDepthStencilState(const sgl::DepthStencilState* depthStencilState);
+
+    /** Bind rasterizer state if it is not bound. */
+    void bindRasterizerState(const sgl::RasterizerState* rasterizerState);
+
+    /** Check whether texture is bound to the stage, count skipped bind if it is.
+     * @return true if texture is bound to the stage by the table.
+     */
+    bool isTextureBound(unsigned stage, const sgl::Texture* texture);
+
+    /** Remember texture bound to the stage, count issued bind. */
+    void setTextureBound(unsigned stage, const sgl::Texture* texture);
+
+    /** Count uniform upload.
+     * @param skipped - true if upload was skipped because program already has the values.
+     */
+    void countUniformUpload(bool skipped)
+    {
+        if (skipped) {
+            ++statistics.numSkippedUniformUploads;
+        }
+        else {
+            ++statistics.numUniformUploads;
+        }
+    }
+
+    /** Forget textures bound to the stages. */
+    void invalidateTextures();
+
+    /** Remove all shared states. */
+    void clear();
+
+    /** Get statistics accumulated since last reset. */
+    const STATISTICS& getStatistics() const { return statistics; }
+
+    /** Reset statistics. */
+    void resetStatistics() { statistics = STATISTICS(); }
+
+private:
+    blend_state_map         blendStates;
+    depth_stencil_state_map     depthStencilStates;
+    rasterizer_state_map        rasterizerStates;
+    sgl::ref_ptr<const sgl::Texture>    textures[max_texture_stages];
+    STATISTICS              statistics;
 };
 
 typedef boost::intrusive_ptr<StateTable>        state_table_ptr;
 typedef boost::intrusive_ptr<const StateTable>  const_state_table_ptr;
 
-/** Get AttributeTable used by current GraphicsManager. */
+/** Get StateTable used by current GraphicsManager. */
 StateTable& currentStateTable();
 
+} // namespace detail
 } // namespace graphics
 } // namespace slon
 
-#endif // __SLON_ENGINE_GRAPHICS_STATE_TABLE_H__
+#endif // __SLON_ENGINE_GRAPHICS_DETAIL_STATE_TABLE_H__
@@ -1,8 +1,12 @@
 #ifndef __SLON_ENGINE_GRAPHICS_DETAIL_UNIFORM_TABLE_H__
 #define __SLON_ENGINE_GRAPHICS_DETAIL_UNIFORM_TABLE_H__
 
+#include <algorithm>
+#include <cstring>
 #include <sgl/Uniform.h>
+#include <vector>
 #include "ParameterTable.h"
+#include "StateTable.h"
 
 namespace slon {
 namespace graphics {
@@ -31,7 +35,9 @@ public:
 
 public:
     uniform_binding(sgl::Uniform<T>* uniform_ = 0) :
-        uniform(uniform_)
+        uniform(uniform_),
+        valuesUseCount(0),
+        count(0)
     {
         if (uniform) {
             count = uniform->Size();
@@ -43,6 +49,7 @@ public:
         if (uniform = uniform_) {
             count = uniform->Size();
         }
+        uploadedValues.clear();
     }
 	
 	sgl::AbstractUniform* get_uniform_base()
@@ -60,20 +67,38 @@ public:
         return uniform; 
     }
 
+    /** Upload values of the binder to the uniform if program doesn't have them already. Static binder is
+     * uploaded if it differs from the last uploaded one or was written since. Values of the
+     * other binders are compared with the last uploaded values of the uniform.
+     */
     void bind(const parameter_binding<T>* valuesBinder_)
     {
         assert( uniform && valuesBinder_ && valuesBinder_->values() );
 
-        if (valuesBinder_ != valuesBinder)
+        StateTable& stateTable = currentStateTable();
+        if ( valuesBinder_ == valuesBinder 
+             && !valuesBinder->is_dynamic() 
+             && valuesBinder->use_count() == valuesUseCount )
         {
-            valuesBinder.reset(valuesBinder_);
-            uniform->Set( valuesBinder->values(), valuesBinder->count() > count ? count : valuesBinder->count() );
-        }
-        else if (valuesBinder->use_count() != valuesUseCount) {
-            uniform->Set( valuesBinder->values(), valuesBinder->count() > count ? count : valuesBinder->count() );
+            stateTable.countUniformUpload(true);
+            return;
         }
 
+        valuesBinder.reset(valuesBinder_);
         valuesUseCount = valuesBinder->use_count();
+
+        const T* values      = valuesBinder->values();
+        size_t   valuesCount = valuesBinder->count() > count ? count : valuesBinder->count();
+        if ( valuesCount == uploadedValues.size()
+             && std::equal(uploadedValues.begin(), uploadedValues.end(), values, memory_equal) )
+        {
+            stateTable.countUniformUpload(true);
+            return;
+        }
+
+        uniform->Set(values, valuesCount);
+        uploadedValues.assign(values, values + valuesCount);
+        stateTable.countUniformUpload(false);
     }
 
     virtual ~uniform_binding() {}
@@ -83,12 +108,16 @@ private:
     uniform_binding(const uniform_binding&);
     uniform_binding& operator = (const uniform_binding&);
 
+    // values are uploaded if any bit differs
+    static bool memory_equal(const T& a, const T& b) { return std::memcmp(&a, &b, sizeof(T)) == 0; }
+
 protected:
     sgl::Uniform<T>*    uniform;
     const_binding_ptr   valuesBinder;
     size_t              valuesUseCount;
     size_t              offset;
     size_t              count;
+    std::vector<T>      uploadedValues;
 };
 
 template<typename T>
@@ -100,7 +129,9 @@ public:
 
 public:
     sampler_uniform_binding(sgl::SamplerUniform<T>* uniform_ = 0) :
-        uniform(uniform_)
+        uniform(uniform_),
+        texture(0),
+        stage(unsigned(-1))
     {
     }
     
@@ -124,17 +155,31 @@ public:
 		return uniform;
 	}
 
-    void bind(const parameter_binding<T>* valuesBinder_, unsigned stage)
+    void bind(const parameter_binding<T>* valuesBinder_, unsigned stage_)
     {
         assert( uniform && valuesBinder_ && valuesBinder_->values() );
+
+        // uniform already refers the stage and texture is still bound there
+        StateTable& stateTable = currentStateTable();
+        if ( stage_ == stage
+             && valuesBinder_->values() == texture 
+             && stateTable.isTextureBound(stage, texture) )
+        {
+            return;
+        }
+
         valuesBinder.reset(valuesBinder_);
-        uniform->Set( stage, valuesBinder->values() );
+        texture = valuesBinder->values();
+        stage   = stage_;
+        uniform->Set(stage, valuesBinder->values());
+        stateTable.setTextureBound(stage, texture);
     }
 
     void unbind()
     {
         assert(valuesBinder);
         valuesBinder->values()->Unbind();
+        currentStateTable().invalidateTextures();
     }
 
     virtual ~sampler_uniform_binding() {}
@@ -147,6 +192,8 @@ private:
 protected:
     sgl::SamplerUniform<T>* uniform;
     const_binding_ptr       valuesBinder;
+    const T*                texture;
+    unsigned                stage;
 };
 
 class UniformTable :
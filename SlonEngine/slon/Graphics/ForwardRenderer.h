@@ -4,6 +4,13 @@
 #include <sgl/Device.h>
 #include <vector>
 #include "../Scene/CullVisitor.h"
+#include "../Scene/OcclusionBuffer.h"
+#include "../Thread/StartStopTimer.h"
+#include "Detail/CommandBuffer.h"
+#include "Detail/CommandExecutor.h"
+#include "Detail/LightGrid.h"
+#include "Detail/RenderQueue.h"
+#include "Detail/StateTable.h"
 #include "Detail/Utility.h"
 #include "Pass.h"
 #include "Renderer.h"
@@ -53,15 +60,18 @@ public:
 		RP_DIRECTIONAL_LIGHTING,
 		RP_POINT_LIGHTING,
 		RP_SPOT_LIGHTING,
-		RP_DEBUG
+		RP_DEBUG,
+		RP_CLUSTERED_LIGHTING
 	};
 
-private:
+protected:
     typedef scene::CullVisitor::light_iterator              light_iterator;
     typedef scene::CullVisitor::light_const_iterator        light_const_iterator;
     typedef scene::CullVisitor::renderable_iterator         renderable_iterator;
     typedef scene::CullVisitor::renderable_const_iterator   renderable_const_iterator;
 
+    typedef std::vector< scene::Light::LIGHT_TYPE, linear_allocator<scene::Light::LIGHT_TYPE> > light_type_vector;
+
     class camera_params :
         public referenced
     {
@@ -122,33 +132,85 @@ private:
         int max_light_count() const { return maxLightCount; }
     };
 
+    /** Point lights binned into the view space clusters, @see LightGrid. */
+    class clustered_light_params :
+        public referenced
+    {
+    private:
+        int                                 maxLightCount;
+        LightGrid                           lightGrid;
+        boost::shared_array<math::Vector4f> lightViewPositionRadius;
+        boost::shared_array<math::Vector4f> lightColorIntensity;
+        math::Vector4f                      gridScaleBias;
+        math::Vector4f                      gridDepthParams;
+        math::Vector4f                      gridMapSize;
+        math::Vector4f                      indexMapSize;
+
+        sgl::ref_ptr<sgl::SamplerState>     samplerState;
+        sgl::ref_ptr<sgl::Texture2D>        gridMap;
+        sgl::ref_ptr<sgl::Texture2D>        indexMap;
+
+        binding_vec4f_ptr   lightViewPositionRadiusBinder;
+        binding_vec4f_ptr   lightColorIntensityBinder;
+        binding_vec4f_ptr   gridScaleBiasBinder;
+        binding_vec4f_ptr   gridDepthParamsBinder;
+        binding_vec4f_ptr   gridMapSizeBinder;
+        binding_vec4f_ptr   indexMapSizeBinder;
+        binding_tex_2d_ptr  gridMapBinder;
+        binding_tex_2d_ptr  indexMapBinder;
+
+    public:
+        clustered_light_params(detail::ParameterTable& parameterTable, unsigned maxLightCount);
+
+        void setup_point(const scene::Camera& camera,
+                         light_const_iterator firstLight, 
+                         light_const_iterator endLight);
+
+        int max_light_count() const { return maxLightCount; }
+
+        LightGrid& light_grid() { return lightGrid; }
+    };
+
     typedef std::auto_ptr<camera_params>                camera_params_ptr;
     typedef std::auto_ptr<light_params>                 light_params_ptr;
+    typedef std::auto_ptr<clustered_light_params>       clustered_light_params_ptr;
+    typedef std::auto_ptr<CommandExecutor>              command_executor_ptr;
+    typedef std::vector<CommandBuffer>                  command_buffer_vector;
 
-    // render packet
-    struct render_packet
+public:
+    struct CAMERA_STATISTICS
     {
-        const Pass*         pass;
-        const Renderable*   renderable;
-
-        render_packet( const Pass*          pass_,
-                       const Renderable*    renderable_ ) :
-            pass(pass_),
-            renderable(renderable_)
-        {}
+        const scene::Camera*            camera;
+        scene::CullVisitor::STATISTICS  culling;    /// tested, culled and emitted objects
     };
 
-    typedef std::vector<render_packet>      render_packets;
-    typedef render_packets::iterator        render_packet_iterator;
+    typedef std::vector<CAMERA_STATISTICS>  camera_statistics_vector;
 
-    // predicate for sorting render packets
-    struct sort_by_priority :
-        public std::binary_function<const render_packet&, const render_packet&, bool>
+    struct FRAME_STATISTICS
     {
-        bool operator () (const render_packet& a, const render_packet& b) const 
-        {
-            return a.pass->getPriority() < b.pass->getPriority();
-        }
+        RenderQueue::STATISTICS renderQueue;
+        size_t                  numArenaAllocations;    /// allocations of the frame containers
+        size_t                  numArenaBytes;          /// bytes allocated by the frame containers
+        size_t                  numHeapAllocations;     /// heap allocations performed by the frame arena
+        StateTable::STATISTICS  states;                 /// issued and skipped state changes, uniform uploads
+        scene::OcclusionBuffer::STATISTICS  occlusion;  /// occlusion culling tests and timings
+        LightGrid::STATISTICS   lightGrid;              /// clustered light binning
+        size_t                  numLightingPasses;      /// number of scene lighting passes
+        size_t                  numWorldTraversals;     /// number of world traversals performed by culling
+        double                  cullTime;               /// time spent culling the cameras, seconds
+        double                  recordTime;             /// time spent recording packet commands, seconds
+        CommandExecutor::STATISTICS commands;           /// executed commands and execution time
+        camera_statistics_vector    cameras;            /// culling statistics of the rendered cameras
+
+        FRAME_STATISTICS()
+        :   numArenaAllocations(0)
+        ,   numArenaBytes(0)
+        ,   numHeapAllocations(0)
+        ,   numLightingPasses(0)
+        ,   numWorldTraversals(0)
+        ,   cullTime(0.0)
+        ,   recordTime(0.0)
+        {}
     };
 
 public:
@@ -158,28 +220,85 @@ public:
 
     bool isWireframe() const            { return wireframe; }
 
+    /** Check whether renderer was created without device. @see GraphicsManager::initHeadlessRenderer */
+    bool isHeadless() const             { return headless; }
+
+    /** Append uber programs requested during the session to the shader manifest warmed up
+     * on init. Called by the engine on shutdown, headless renderer saves nothing.
+     * @return true if manifest is up to date.
+     */
+    bool saveShaderManifest() const;
+
+    /** Get statistics of the last rendered frame: render queue packets, state switches, sort time,
+     * frame arena allocations, issued/skipped state changes and uniform uploads, occlusion culling,
+     * light binning and lighting passes, culling time, world traversals and statistics per camera,
+     * recorded and executed commands.
+     */
+    const FRAME_STATISTICS& getFrameStatistics() const { return frameStatistics; }
+
+    /** Set executor replaying commands recorded for the render packets, renderer takes ownership.
+     * @see NullCommandExecutor
+     */
+    void setCommandExecutor(CommandExecutor* executor);
+
+    /** Get executor replaying recorded commands. */
+    CommandExecutor* getCommandExecutor() const { return commandExecutor.get(); }
+
 	// Override Renderer
     void                                handleLight(const scene::Light* light) const;
     RENDER_TECHNIQUE                    getRenderTechnique() const { return FORWARD_RENDERING; }
     void                                render(realm::World& world, const scene::Camera& mainCamera) const;
 
-    /** Make priority for rendering using ForwardRenderer */
+    /** Make priority for rendering using ForwardRenderer: bin in the highest byte, program address in the rest.
+     * @see RenderQueue::makeKey
+     */
     static long long makePriority(RENDER_BIN bin, const void* programPtr);
 
     ~ForwardRenderer() {}
 
-private:
+protected:
     void init();
 
+    void beginFrame();
+
+    /** Gather lights and renderables visible by the camera, store culling statistics. If multi view
+     * culling is enabled, views of all cameras of the graphics manager are culled by the first call
+     * in the frame, following calls pick the view of the camera.
+     */
+    void cull(realm::World& world, const scene::Camera& camera) const;
+
+    /** Cull views of the graphics manager cameras in one world traversal. */
+    void cull_views(realm::World& world) const;
+
+    /** Group gathered lights by type, store types of the groups. */
+    void partition_lights(light_type_vector& lightTypes) const;
+
+    /** Bind render target of the camera or post process render target if camera has post effects.
+     * @return false if render target can't be bound.
+     */
+    bool bind_render_target(const scene::Camera& camera, sgl::RenderTarget*& renderTarget) const;
+
+    /** Render lighting passes for the groups of gathered lights. */
+    void render_lighting(render_group_handle        renderGroup,
+                         const scene::Camera&       camera,
+                         const light_type_vector&   lightTypes) const;
+
+    /** Perform post effect chain of the camera, unbind render target. */
+    void post_process(const scene::Camera& camera, sgl::RenderTarget* renderTarget) const;
+
+    /** Sort packets of the renderables, record commands rendering them and execute. Long queues
+     * are recorded by the thread pool in chunks.
+     */
     void render_pass(render_group_handle        renderGroup,
                      render_pass_handle         renderPass,
                      renderable_const_iterator  firstRenderable, 
                      renderable_const_iterator  endRenderable) const;
 
-private:
+protected:
     // render path setup
     ForwardRendererDesc     desc;
     bool                    initialized;
+    bool                    headless;       /// renderer has no device, commands are only recorded
 
     // properties
     bool    wireframe;
@@ -187,17 +306,38 @@ private:
     // params
     mutable binding_tex_2d_ptr     inputMapBinder;
     mutable binding_tex_2d_ptr     depthMapBinder;
+    mutable binding_mat4x4f_ptr    worldMatrixBinder;
 
     // sgl
     sgl::Texture::FORMAT                    postProcessFormat;
     sgl::ref_ptr<sgl::RasterizerState>      wireframeState;
     mutable sgl::ref_ptr<sgl::RenderTarget> postProcessRenderTarget;
 
-    // frame
+    // frame, containers are allocated from the arena reset every frame
+    mutable linear_arena        frameArena;
     mutable scene::CullVisitor  cv;
+    mutable scene::CullVisitor  viewsCv;
+    mutable const realm::World* viewsWorld;
+    mutable scene::OcclusionBuffer  occlusionBuffer;
     mutable camera_params_ptr   cameraParams;
     mutable light_params_ptr    lightParams;
-    mutable render_packets      renderPackets;
+    mutable clustered_light_params_ptr  clusteredLightParams;
+    mutable RenderQueue         renderQueue;
+    mutable CommandBuffer       commandBuffer;
+    mutable command_buffer_vector   recordBuffers;  // chunks recorded by the thread pool, use heap
+    mutable std::vector<size_t>     recordBounds;
+    command_executor_ptr        commandExecutor;
+
+    // statistics
+    mutable size_t                      numLightingPasses;
+    mutable size_t                      numWorldTraversals;
+    mutable StartStopTimer              cullTimer;
+    mutable double                      cullTime;
+    mutable StartStopTimer              recordTimer;
+    mutable double                      recordTime;
+    mutable camera_statistics_vector    cameraStatistics;
+    FRAME_STATISTICS                    frameStatistics;
+    boost::signals::scoped_connection   preFrameConnection;
 };
 
 } // namespace detail
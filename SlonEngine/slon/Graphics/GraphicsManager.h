@@ -85,6 +85,21 @@ public:
     /** Create fixed pipeline renderer for rendering 3d scenes */
     virtual graphics::Renderer* initRenderer(const FFPRendererDesc& desc) = 0;
 
+    /** Create deferred shading renderer for rendering 3d scenes */
+    virtual graphics::Renderer* initRenderer(const DeferredRendererDesc& desc) = 0;
+
+    /** Create forward renderer without device and window. Renderer performs CPU part of the frame:
+     * culling, light binning, building, sorting and recording of the render packets, but doesn't
+     * execute recorded commands, so frame can be timed on machines without display. Scene must use
+     * device independent effects, e.g. NullEffect, meshes are created without buffers.
+     */
+    virtual graphics::Renderer* initHeadlessRenderer(const ForwardRendererDesc& desc) = 0;
+
+    /** Create deferred shading renderer without device and window. Renderer records the g-buffer
+     * and forward passes, light volumes are only counted. @see initHeadlessRenderer
+     */
+    virtual graphics::Renderer* initHeadlessRenderer(const DeferredRendererDesc& desc) = 0;
+
     /** Get renderer that renders 3d scene */
     virtual graphics::Renderer* getRenderer() = 0;
 
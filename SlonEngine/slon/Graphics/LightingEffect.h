@@ -17,6 +17,9 @@ public:
     static const int MIN_NUM_LIGHTS = 1;
     static const int MAX_NUM_LIGHTS = 3;
 
+    // maximum number of point lights shaded by the clustered lighting pass
+    static const int MAX_NUM_CLUSTERED_LIGHTS = 32;
+
 public:
     typedef TransformEffect base_type;
 
@@ -57,8 +60,11 @@ private:
 
     // technique
     pass_ptr                ffpPass;
-    pass_ptr                passes[scene::Light::NUM_LIGHT_TYPES][MAX_NUM_LIGHTS];
-    pass_ptr                backFacePasses[scene::Light::NUM_LIGHT_TYPES][MAX_NUM_LIGHTS];
+    pass_ptr                passes[scene::Light::NUM_LIGHT_TYPES][MAX_NUM_LIGHTS + 1];
+    pass_ptr                backFacePasses[scene::Light::NUM_LIGHT_TYPES][MAX_NUM_LIGHTS + 1];
+    pass_ptr                clusteredPass;
+    pass_ptr                clusteredBackFacePass;
+    pass_ptr                gbufferPass;
 };
 
 typedef boost::intrusive_ptr<LightingEffect>        lighting_effect_ptr;
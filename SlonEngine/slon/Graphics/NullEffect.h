@@ -0,0 +1,62 @@
+#ifndef __SLON_ENGINE_GRAPHICS_EFFECT_NULL_EFFECT_H__
+#define __SLON_ENGINE_GRAPHICS_EFFECT_NULL_EFFECT_H__
+
+#include "Effect.h"
+#include "ParameterBinding.h"
+#include "Pass.h"
+
+namespace slon {
+namespace graphics {
+
+/** Pass without shaders and states. */
+class SLON_PUBLIC NullPass :
+    public Pass
+{
+public:
+    explicit NullPass(long long priority_ = 0)
+    :   priority(priority_)
+    {}
+
+    // Override Pass
+    long long getPriority() const { return priority; }
+    void      begin() const       {}
+    void      end() const         {}
+
+private:
+    long long   priority;
+};
+
+/** Effect presenting single null pass, doesn't require device. Used by the headless renderer
+ * to measure CPU cost of the frame: world matrix binding is kept, so packets of the effect are
+ * sorted and instanced as packets of the regular effects.
+ */
+class SLON_PUBLIC NullEffect :
+    public Effect
+{
+public:
+    /** Create effect.
+     * @param renderPassMask - bit mask of the render passes effect is presented in.
+     * @param priority - priority of the effect pass in the render queue.
+     */
+    explicit NullEffect(unsigned renderPassMask = ~0u, long long priority = 0);
+
+    // Override Effect
+    int                               present(render_group_handle renderGroup, render_pass_handle renderPass, Pass** passes);
+    const abstract_parameter_binding* getParameter(hash_string name) const;
+    bool                              bindParameter(hash_string                        name,
+                                                    const abstract_parameter_binding*    binding);
+    int                               queryAttribute(hash_string /*name*/) { return -1; }
+
+private:
+    unsigned                    renderPassMask;
+    const_binding_mat4x4f_ptr   worldMatrixBinder;
+    pass_ptr                    pass;
+};
+
+typedef boost::intrusive_ptr<NullEffect>        null_effect_ptr;
+typedef boost::intrusive_ptr<const NullEffect>  const_null_effect_ptr;
+
+} // namespace graphics
+} // namespace slon
+
+#endif // __SLON_ENGINE_GRAPHICS_EFFECT_NULL_EFFECT_H__
@@ -36,6 +36,7 @@ public:
 
     unsigned    count() const               { return valuesCount; }
     unsigned    use_count() const           { return dynamic ? (++useCount) : useCount; }
+    bool        is_dynamic() const          { return dynamic; }
     const T*    values() const              { return valuesPtr; }
     const T&    value(unsigned i = 0) const { return valuesPtr[i]; }
 
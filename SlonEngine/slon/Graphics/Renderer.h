@@ -36,6 +36,10 @@ struct SLON_PUBLIC ForwardRendererDesc
     bool        makeDepthMap;   /// make depth map during depth pass or main pass
     bool        useDepthPass;   /// add depth only pass
     bool        useDebugRender; /// allow debug render
+    bool        useOcclusionCulling; /// cull renderables hidden by the occluders using CPU rasterized depth buffer
+    bool        useClusteredLighting; /// shade point lights in one pass using lights binned into view space clusters
+    bool        useMultiViewCulling; /// cull views of all cameras of the graphics manager in one world traversal
+    float       minScreenArea;  /// cull objects with smaller projected area in pixels, 0 - disabled
 
     ForwardRendererDesc()
     :   bitsPerPixel(32)
@@ -44,6 +48,33 @@ struct SLON_PUBLIC ForwardRendererDesc
     ,   makeDepthMap(false)
     ,   useDepthPass(false)
     ,   useDebugRender(false)
+    ,   useOcclusionCulling(false)
+    ,   useClusteredLighting(false)
+    ,   useMultiViewCulling(false)
+    ,   minScreenArea(0.0f)
+    {}
+};
+
+/** Deferred renderer shades directional and point lights from the g-buffer, spot lights
+ * are not supported and ignored.
+ */
+struct SLON_PUBLIC DeferredRendererDesc
+{
+    unsigned    bitsPerPixel;   /// 16, 24 or 32
+    unsigned    depthBits;      /// 16 or 24
+
+    bool        useDebugRender; /// allow debug render
+    bool        useOcclusionCulling; /// cull renderables hidden by the occluders using CPU rasterized depth buffer
+    bool        useMultiViewCulling; /// cull views of all cameras of the graphics manager in one world traversal
+    float       minScreenArea;  /// cull objects with smaller projected area in pixels, 0 - disabled
+
+    DeferredRendererDesc()
+    :   bitsPerPixel(32)
+    ,   depthBits(24)
+    ,   useDebugRender(false)
+    ,   useOcclusionCulling(false)
+    ,   useMultiViewCulling(false)
+    ,   minScreenArea(0.0f)
     {}
 };
 
@@ -1,50 +1,62 @@
 #ifndef SLON_ENGINE_SHADOW_VOLUME_MESH_H
 #define SLON_ENGINE_SHADOW_VOLUME_MESH_H
 
-#include "../Effect/ExtrudeEffect.h"
-#include "Mesh.h"
-#include <sgl/State.h>
-#include <map>
+#include <sgl/VertexBuffer.h>
+#include "Detail/AttributeTable.h"
+#include "Detail/ShadowSilhouette.h"
+#include "Effect.h"
+#include "Renderable.h"
 
 namespace slon {
 namespace graphics {
 
-/** Mesh with geometry preprocessed to implement
- * shadow volumes on the GPU
+/** Shadow volume of the triangle mesh. Volume is built on CPU from the silhouette
+ * edges of the mesh and caps, vertex buffer is updated only when the light moves
+ * relative to the object. Extruded vertices have w = 0, so effect needs only
+ * regular world view projection transform of the "position" attribute.
  */
-class ShadowVolumeMesh :
+class SLON_PUBLIC ShadowVolumeMesh :
 	public Renderable
 {
-private:
-    typedef boost::intrusive_ptr<ExtrudeEffect> extrude_effect_ptr;
-
 public:
-    ShadowVolumeMesh(graphics::Mesh* mesh = 0);
-
-    /** Get effect that extrudes silhouette edges */
-    extrude_effect_ptr getExtrudeEffect() const { return effect; }
-
-    // Override renderable
-    effect_ptr getAbstractEffect() const { return effect; }
-
-	/** Create shadow volume mesh from the sgl mesh
-	 * @param mesh - sgl mesh for shadow volume
-	 */
-    virtual void setupMesh(graphics::Mesh* mesh);
+    ShadowVolumeMesh(const effect_ptr& effect);
+
+    /** Compute adjacency of the mesh for silhouette extraction.
+     * @param vertices - object space positions.
+     * @param numVertices - number of vertices.
+     * @param indices - triangle list indices.
+     * @param numIndices - number of indices.
+     */
+    void setupMesh(const math::Vector3f* vertices, size_t numVertices, const unsigned* indices, size_t numIndices);
+
+    /** Rebuild volume if light or object moved.
+     * @param invWorldMatrix - world to object space transform.
+     * @param lightPosition - world space position of the point light (w = 1) or 
+     * direction to the directional light (w = 0).
+     * @param caps - build closed volume for depth fail shadows.
+     */
+    void update(const math::Matrix4f& invWorldMatrix, const math::Vector4f& lightPosition, bool caps = true);
+
+    /** Get silhouette of the mesh. */
+    const detail::ShadowSilhouette& getSilhouette() const { return silhouette; }
+
+    // Override Renderable
+    Effect* getEffect() const { return effect.get(); }
+    void    render() const;
+
+    /** Check whether shadow volume has geometry */
+    bool valid() const { return numVertices > 0; }
 
-    /** Render mesh to the device */
-    virtual void render() const;
-
-    /** Check wether shadow volume mesh is constructed */
-    virtual bool valid() const { return svMesh.get() != 0; }
-
-protected:
-	// render data
-	mesh_ptr            svMesh;
-    extrude_effect_ptr  effect;
+private:
+    effect_ptr                          effect;
+    detail::ShadowSilhouette            silhouette;
+    sgl::ref_ptr<sgl::VertexLayout>     vertexLayout;
+    sgl::ref_ptr<sgl::VertexBuffer>     vertexBuffer;
+    detail::AttributeTable::binding_ptr positionBinding;
+    size_t                              numVertices;
 };
 
-} // namespace slon
 } // namespace graphics
+} // namespace slon
 
 #endif // SLON_ENGINE_SHADOW_VOLUME_MESH_H
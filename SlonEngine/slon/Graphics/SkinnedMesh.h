@@ -95,6 +95,7 @@ private:
     scene::skeleton_ptr skeleton;
     joint_vector        joints;
 	bool				cpuSkinning;
+    mutable unsigned    skinningFrame;  /// frame of the last CPU skinning
 
     // helpers for animation
     GPUSideMesh::attribute_const_iterator    positionIter;
@@ -43,6 +43,12 @@ public:
 	/** Setup mesh to be shadow receiver or not */
 	virtual void SetShadowReceiver(bool toggle) { shadowReceiver = toggle; }
 
+	/** Check whenever mesh bounds are used as occluder for the occlusion culling */
+	bool isOccluder() const                     { return occluder; }
+
+	/** Setup mesh bounds to be used as occluder. Use only for meshes filling their bounds, e.g. walls or buildings */
+	void setOccluder(bool toggle)               { occluder = toggle; }
+
 	/** Get geometry of the mesh */
 	virtual const GPUSideMesh* getMesh() const { return mesh.get(); }
 
@@ -56,6 +62,9 @@ private:
 	// lighting
 	bool shadowCaster;
 	bool shadowReceiver;
+
+    // culling
+    bool occluder;
 };
 
 } // namespace graphics
@@ -1,8 +1,10 @@
 #ifndef __SLON_ENGINE_INPUT_DETAIL_INPUT_MANAGER__
 #define __SLON_ENGINE_INPUT_DETAIL_INPUT_MANAGER__
 
+#include <boost/scoped_ptr.hpp>
 #include <sgl/Math/Matrix.hpp>
 #include "../InputManager.h"
+#include "InputRecord.h"
 
 // Forward decl
 union SDL_Event;
@@ -67,6 +69,29 @@ public:
     // Called by engine
     void handleEvents();
 
+    /** Record input events into the file, until endRecord is called. Throws slon_error on failure. */
+    void beginRecord(const std::string& fileName);
+
+    /** Replace input events with the recorded, SDL keyboard and mouse events are ignored.
+     * Quit and window events are still handled. Throws slon_error on failure.
+     */
+    void beginReplay(const std::string& fileName);
+
+    /** Finish recording or replay. */
+    void endRecord();
+
+    /** Start next frame of the record or replay.
+     * @param time - frame time to record. If replaying, receives recorded frame time.
+     * @return false if replay is over.
+     */
+    bool nextRecordFrame(double& time);
+
+    /** Check whether input is recorded. */
+    bool isRecording() const { return recorder.get() != 0; }
+
+    /** Check whether input is replayed. */
+    bool isReplaying() const { return player.get() != 0; }
+
     void handleEvent(const SDL_Event* event);
 
 private:
@@ -74,6 +99,11 @@ private:
     bool                    ignoreSetCursorPositionEvent;
     bool                    cursorPositionFixed;
     math::Vector2ui    		fixedCursorPosition;
+
+    // record & replay
+    boost::scoped_ptr<InputRecorder>    recorder;
+    boost::scoped_ptr<InputPlayer>      player;
+    InputPlayer::input_event_vector     replayEvents;
 };
 
 } // namespace detail
@@ -0,0 +1,98 @@
+#ifndef __SLON_ENGINE_INPUT_DETAIL_INPUT_RECORD_H__
+#define __SLON_ENGINE_INPUT_DETAIL_INPUT_RECORD_H__
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../InputHandler.h"
+
+namespace slon {
+namespace input {
+namespace detail {
+
+/** Packed input event as it is stored in the record file. */
+struct recorded_event
+{
+    enum TYPE
+    {
+        KEYBOARD,
+        MOUSE
+    };
+
+    unsigned char   type;
+    unsigned char   state;      /// key state or mouse button state
+    unsigned short  code;       /// key sym or mouse button
+    unsigned short  modifier;   /// key modifier
+    short           x, y;
+    short           xrel, yrel;
+};
+
+/** Records frame times and input events into the binary file. File consist of the header
+ * and frame records: frame time, number of events, events. Values are stored in the native byte order.
+ */
+class InputRecorder
+{
+public:
+    /** Open record file. Throws slon_error on failure. */
+    InputRecorder(const std::string& fileName);
+    ~InputRecorder();
+
+    /** Start frame record. Events are written to the file with the frame. */
+    void beginFrame(double time);
+
+    /** Record input event of the current frame. */
+    void recordEvent(const InputEvent& event);
+
+    /** Write current frame. */
+    void flush();
+
+    /** Get number of recorded frames */
+    size_t getNumFrames() const { return numFrames; }
+
+private:
+    std::ofstream               file;
+    std::vector<recorded_event> events;
+    double                      frameTime;
+    bool                        frameStarted;
+    size_t                      numFrames;
+};
+
+/** Reads frame times and input events recorded by InputRecorder. Whole record
+ * is loaded on open, so reading doesn't touch file during replay. Events of the frame
+ * are stored by the player and reused by the next frame, so replay doesn't allocate
+ * once the storage grows to the largest frame.
+ */
+class InputPlayer
+{
+public:
+    typedef std::vector<const InputEvent*>  input_event_vector;
+
+public:
+    /** Load record file. Throws slon_error on failure. */
+    InputPlayer(const std::string& fileName);
+
+    /** Read next frame.
+     * @param time [out] - recorded time of the frame.
+     * @param frameEvents [out] - input events of the frame, valid until the next call.
+     * @return false if record is over.
+     */
+    bool nextFrame(double& time, input_event_vector& frameEvents);
+
+    /** Get number of replayed frames */
+    size_t getNumFrames() const { return numFrames; }
+
+private:
+    std::vector<char>           data;
+    size_t                      position;
+    size_t                      numFrames;
+
+    // events of the current frame
+    std::vector<KeyboardEvent>  keyboardEvents;
+    std::vector<MouseEvent>     mouseEvents;
+};
+
+} // namespace detail
+} // namespace input
+} // namespace slon
+
+#endif // __SLON_ENGINE_INPUT_DETAIL_INPUT_RECORD_H__
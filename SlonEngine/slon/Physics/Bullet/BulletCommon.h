@@ -2,6 +2,7 @@
 #define __SLON_ENGINE_PHYSICS_BULLET_BULLET_COMMON_H__
 
 #include "../../Math/RigidTransform.hpp"
+#include "../../Utility/Algorithm/parallel.hpp"
 #include "../CollisionShape.h"
 #include <bullet/btBulletCollisionCommon.h>
 #include <bullet/btBulletDynamicsCommon.h>
@@ -168,8 +169,8 @@ inline btCollisionShape* createBtCollisionShape(const CollisionShape& collisionS
                                                                                            triangleMeshShape.vertices.size(),
                                                                                            (btScalar*)&triangleMeshShape.vertices[0].x,
                                                                                            sizeof(math::Vector3r) );
-		    math::AABBr aabb = compute_aabb<real>( triangleMeshShape.vertices.begin(),
-												   triangleMeshShape.vertices.end() );
+		    math::AABBr aabb = parallel_compute_aabb<real>( triangleMeshShape.vertices.begin(),
+												            triangleMeshShape.vertices.end() );
             float minDimension = std::min(aabb.size().x, std::min(aabb.size().y, aabb.size().z));
 
 		    btBvhTriangleMeshShape* bulletCollisionShape = new btBvhTriangleMeshShape( indexVertexArray, true, to_bt_vec( xyz(aabb.minVec) ), to_bt_vec( xyz(aabb.maxVec) ) );
@@ -1,7 +1,10 @@
 #ifndef __SLON_ENGINE_PHYSICS_DETAIL_PHYSICS_MANAGER_H__
 #define __SLON_ENGINE_PHYSICS_DETAIL_PHYSICS_MANAGER_H__
 
+#include "../../Thread/LockStatistics.h"
 #include "../PhysicsManager.h"
+#include <boost/thread/mutex.hpp>
+#include <vector>
 
 namespace slon {
 namespace physics {
@@ -23,9 +26,21 @@ public:
     void         setTimer(const const_timer_ptr& timer);
     const Timer* getTimer() const { return timer.get(); }
 
-    /** Step simulation. This is called by engine. */
+    real         getInterpolationFactor() const;
+    real         getInterpolationFactor(unsigned& stepCount) const;
+    unsigned     getStepCount() const;
+
+    void         setParallelStepping(bool parallelStepping_) { parallelStepping = parallelStepping_; }
+    bool         isParallelStepping() const                  { return parallelStepping; }
+
+    /** Step simulation for time elapsed from the last step. This is called by engine. */
     void handlePhysics();
 
+    /** Step simulation for fixed time interval without splitting it into world sub steps.
+     * This is called by engine physics thread.
+     */
+    void stepSimulation(real dt);
+
     /** Attach pre frame callback. Calls before physics frame simulation. */
     connection_type connectPreFrameCallback(pre_frame_signal::slot_type slot) {
         return preFrameSignal.connect(slot);
@@ -39,19 +54,35 @@ public:
     thread::lock_ptr lockForReading() const;
     thread::lock_ptr lockForWriting();
 
+private:
+    void   stepWorld(size_t i, real dt, bool force);
+    void   stepWorlds(real dt, bool force);
+    size_t getNumSimulatedSteps() const;
+
 private:
 	dynamics_world_list worlds;
     const_timer_ptr     timer;
     delta_timer         deltaTimer;
     real                unsimulatedTime;
     bool                realtime;
+    bool                parallelStepping;
+
+    // worlds being stepped
+    std::vector<dynamics_world_ptr> steppedWorlds;
+
+    // finished step, written by the physics thread, read by the scene thread
+    mutable boost::mutex    stepMutex;
+    bool                    fixedRate;
+    double                  lastStepTime;
+    real                    lastStepInterval;
+    unsigned                stepCount;
 
     // connections
     pre_frame_signal    preFrameSignal;
     post_frame_signal   postFrameSignal;
 
     // sync
-    mutable boost::shared_mutex accessMutex;
+    mutable thread::instrumented_mutex<boost::shared_mutex> accessMutex;
 };
 
 } // namespace detail
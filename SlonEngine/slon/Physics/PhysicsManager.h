@@ -39,6 +39,30 @@ public:
     /** Get physics timer */
     virtual const Timer* getTimer() const = 0;
 
+    /** Get position of the current time between two last physics steps, in [0, 1]. Physics objects
+     * interpolate their transforms between two last states using this factor. If physics is not stepped 
+     * with fixed rate, factor is always 1.
+     */
+    virtual real getInterpolationFactor() const = 0;
+
+    /** Get interpolation factor together with the number of the finished physics steps, both
+     * are taken from the same step. @see getInterpolationFactor
+     */
+    virtual real getInterpolationFactor(unsigned& stepCount) const = 0;
+
+    /** Get number of the finished physics steps. */
+    virtual unsigned getStepCount() const = 0;
+
+    /** Step independent dynamics worlds concurrently using engine thread pool. Callbacks of the
+     * dynamics worlds and their objects (contacts, transforms) are called from the worker threads then.
+     * Pre and post frame callbacks are always called from the physics thread, post frame callback 
+     * is called after all worlds finished their step.
+     */
+    virtual void setParallelStepping(bool parallelStepping) = 0;
+
+    /** Check whether dynamics worlds are stepped concurrently. */
+    virtual bool isParallelStepping() const = 0;
+
     /** Attach pre frame callback. Calls before physics frame simulation. */
     virtual connection_type connectPreFrameCallback(pre_frame_signal::slot_type slot) = 0;
 
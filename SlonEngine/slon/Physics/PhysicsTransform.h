@@ -6,10 +6,15 @@
 #include "../Scene/AcceptVisitor.hpp"
 #include "../Utility/connection.hpp"
 #include "Forward.h"
+#include <boost/thread/mutex.hpp>
 
 namespace slon {
 namespace physics {
 
+/** Transform driven by the collision object. Physics thread publishes two last states of the
+ * collision object, transform is interpolated between them when physics is stepped with fixed rate.
+ * Object which got no state from the last step (e.g. sleeping body) rests in its current state.
+ */
 class SLON_PUBLIC PhysicsTransform :
 	public scene::Transform,
 	public scene::AcceptVisitor<realm::EventVisitor>
@@ -31,6 +36,7 @@ public:
 
     const math::Matrix4f& getTransform() const;
     const math::Matrix4f& getInverseTransform() const;
+    unsigned int          getModifiedCount() const;
 
     /** Set rigid body which handles transform. */
     void setCollisionObject(const collision_object_ptr& collisionObject_);
@@ -44,12 +50,24 @@ public:
 private:
     void setWorldTransform(const math::RigidTransformr& transform);
 
+    /** Interpolate transform between published states. Called from the scene thread. */
+    void interpolateTransform() const;
+
 protected:
     collision_object_ptr            collisionObject;
     bool                            absolute;
     connection                      transformConnection;
-    math::RigidTransformf           transform;
+    mutable math::RigidTransformf   transform;
     mutable math::RigidTransformf   invTransform;
+
+    // states published by physics: previous and current
+    mutable boost::mutex            stateMutex;
+    mutable math::RigidTransformf   states[2];
+    unsigned int                    stateStamp;
+    unsigned int                    stateStep;          /// physics step which published current state
+    mutable bool                    resting;            /// previous state is collapsed to the current one
+    mutable unsigned int            interpolatedStamp;
+    mutable real                    interpolationFactor;
 };
 
 } // namespace physics
@@ -11,6 +11,8 @@
 #include "Location.h"
 #include "BVHLocationNode.h"
 #include "EventVisitor.h"
+#include "../Thread/LockStatistics.h"
+#include <boost/thread/shared_mutex.hpp>
 
 namespace slon {
 namespace realm {
@@ -78,6 +80,7 @@ public:
     void visit(const body_variant& body, scene::ConstVisitor& nv) const;
     void visitVisible(const math::Frustumf& frustum, scene::Visitor& nv);
     void visitVisible(const math::Frustumf& frustum, scene::ConstVisitor& nv) const;
+    void visitVisible(scene::CullVisitor& cv, unsigned viewMask) const;
 	
 	bool have(const scene::node_ptr& node) const;
     void add(const scene::node_ptr& node, bool dynamic, bool activatePhysics);
@@ -88,12 +91,18 @@ public:
     physics::DynamicsWorld*       getDynamicsWorld()        { return dynamicsWorld.get(); }
     const physics::DynamicsWorld* getDynamicsWorld() const  { return dynamicsWorld.get(); }
 
+    thread::lock_ptr lockForReading() const;
+    thread::lock_ptr lockForWriting();
+    mutex_type&      getAccessMutex() const { return accessMutex; }
+
 private:
     math::AABBf                 aabb;
     object_tree                 staticAABBTree;
     object_tree                 dynamicAABBTree;
     physics::dynamics_world_ptr dynamicsWorld;
-    EventVisitor                eventVisitor;
+
+    // sync
+    mutable mutex_type          accessMutex;
 
     // debug
 #ifdef DEBUG_DBVT_LOCATION
@@ -4,6 +4,8 @@
 #include "EventVisitor.h"
 #include "Location.h"
 #include "World.h"
+#include "../Thread/LockStatistics.h"
+#include <boost/thread/locks.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <vector>
 
@@ -38,6 +40,7 @@ public:
 		// visit others
 		for (size_t i = 0; i<locations.size(); ++i)
 		{
+			boost::shared_lock<Location::mutex_type> lock( locations[i]->getAccessMutex() );
 			if ( test_intersection(locations[i]->getBounds(), body) ) {
 				locations[i]->visit(body, nv);
 			}
@@ -55,6 +58,7 @@ public:
 		// visit others
 		for (size_t i = 0; i<locations.size(); ++i)
 		{
+			boost::shared_lock<Location::mutex_type> lock( locations[i]->getAccessMutex() );
 			if ( test_intersection(locations[i]->getBounds(), body) ) {
 				locations[i]->visit(body, nv);
 			}
@@ -70,6 +74,7 @@ public:
     void visit(const body_variant& body, scene::ConstVisitor& nv) const;
     void visitVisible(const math::Frustumf& frustum, scene::Visitor& nv);
     void visitVisible(const math::Frustumf& frustum, scene::ConstVisitor& nv) const;
+    void visitVisible(scene::CullVisitor& cv) const;
 
     bool removeInfiniteNode(const scene::node_ptr& node);
     void addInfiniteNode(const scene::node_ptr& node);
@@ -85,7 +90,7 @@ private:
     // infinite object
     object_vector	infiniteObjects;
 
-    mutable boost::shared_mutex accessMutex;
+    mutable thread::instrumented_mutex<boost::shared_mutex> accessMutex;
 };
 
 } // namespace realm
@@ -5,9 +5,11 @@
 #include "../Physics/Forward.h"
 #include "../Scene/Forward.h"
 #include "../Thread/Lock.h"
+#include "../Thread/LockStatistics.h"
 #include "../Utility/math.hpp"
 #include "../Utility/referenced.hpp"
 #include "Forward.h"
+#include <boost/thread/shared_mutex.hpp>
 
 namespace slon {
 namespace realm {
@@ -16,6 +18,9 @@ class SLON_PUBLIC Location :
     public Referenced,
     public database::Serializable
 {
+public:
+    typedef thread::instrumented_mutex<boost::shared_mutex>     mutex_type;
+
 public:
     /** Get bounds of the hole location. */
     virtual const math::AABBf& getBounds() const = 0;
@@ -28,6 +33,8 @@ public:
      * nodes for scene graph to store necessary information in them.
 	 * @param dynamic - hint, object transform will be frequently updated during execution.
      * @param activatePhysics - add node physics objects to the dynamics world.
+     * Location takes write lock of itself while inserting the object, so don't call it while holding
+     * lock of the location. Node is notified about the event after the lock is released.
 	 */
     virtual void add(const scene::node_ptr& node, 
                      bool                   dynamic = true,
@@ -41,6 +48,8 @@ public:
     /** Remove object from the location if it is presented. 
 	 * @param node - scene graph node for removal (same as used in add function).
      * @param deactivatePhysics - remove node physics objects from the dynamics world.
+     * Location takes write lock of itself while removing the object, so don't call it while holding
+     * lock of the location. Node is notified about the event after the lock is released.
      * @return true if object removed
      */
     virtual bool remove(const scene::node_ptr& node,
@@ -76,7 +85,16 @@ public:
      */
     virtual void visitVisible(const math::Frustumf& frustum, scene::ConstVisitor& nv) const = 0;
 
-    /** Set dynamics world for location. Physics entities will be added to dynamics world. */
+    /** Visit objects visible by any view of the cull visitor. Location is traversed once,
+     * every object is traversed with the mask of the views it intersects.
+     * @param cv - visitor culling several views. @see scene::CullVisitor::setCameras
+     * @param viewMask - mask of the views seeing the location, other views are not tested.
+     */
+    virtual void visitVisible(scene::CullVisitor& cv, unsigned viewMask) const = 0;
+
+    /** Set dynamics world for location. Physics entities will be moved from the previous dynamics world.
+     * Location takes write lock of itself to collect the objects and switch the world.
+     */
     virtual void setDynamicsWorld(const physics::dynamics_world_ptr& world) = 0;
 
     /** Get location dynamics world. */
@@ -85,16 +103,22 @@ public:
     /** Get location dynamics world. */
     virtual const physics::DynamicsWorld* getDynamicsWorld() const = 0;
 
-
     /** Grant thread read access to the location.
      * @return lock object. Lock is freed whether object is deleted.
-     *
-    virtual thread::lock_ptr lockForReading() const = 0;*/
+     */
+    virtual thread::lock_ptr lockForReading() const = 0;
 
-    /** Grant thread write access to the location.
+    /** Grant thread write access to the location. Take this lock to update objects in the location,
+     * add and remove take it themselves. Locations are locked independently, so updating objects of one location
+     * doesn't block queries of the others.
      * @return lock object. Lock is freed whether object is deleted.
-     *
-    virtual thread::lock_ptr lockForWriting() = 0;*/
+     */
+    virtual thread::lock_ptr lockForWriting() = 0;
+
+    /** Get mutex locked by lockForReading and lockForWriting. World visits the location
+     * under scoped shared lock of it, so visit doesn't allocate lock object.
+     */
+    virtual mutex_type& getAccessMutex() const = 0;
 
     virtual ~Location() {}
 };
@@ -18,7 +18,9 @@ namespace realm {
 /** World stores all locations represented in the application.
  * It handles location loading, storing and updating. World is not 
  * thread safe by itself, you must use lock functions to provide thread
- * safety.
+ * safety. World lock guards only the list of locations and infinite objects,
+ * every location has its own lock. Visit functions lock visited locations for reading,
+ * so holding read lock of the world is enough to query it.
  */
 class SLON_PUBLIC World :
     public Referenced,
@@ -48,6 +50,12 @@ public:
      * @param cb - visitor.
      */
     virtual void visitVisible(const math::Frustumf& frustum, scene::ConstVisitor& nv) const = 0;
+
+    /** Visit objects visible by any view of the cull visitor. World is traversed once for all
+     * views, locations outside of every view frustum are skipped.
+     * @param cv - visitor culling several views. @see scene::CullVisitor::setCameras
+     */
+    virtual void visitVisible(scene::CullVisitor& cv) const = 0;
 	   
 	/** Remove infinite object from the world if it is presented. 
      * @return true if object removed
@@ -71,12 +79,13 @@ public:
     /** Check whether world have specified location */
     virtual bool haveLocation(const location_ptr& location) const = 0;
 
-    /** Grant thread read access to the world.
+    /** Grant thread read access to the world: locations and infinite objects.
      * @return lock object. Lock is freed whether object is deleted.
      */
     virtual thread::lock_ptr lockForReading() const = 0;
 
-    /** Grant thread write access to the world.
+    /** Grant thread write access to the world. Required only for adding and removing 
+     * locations and infinite objects.
      * @return lock object. Lock is freed whether object is deleted.
      */
     virtual thread::lock_ptr lockForWriting() = 0;
@@ -3,6 +3,7 @@
 
 #include "../Utility/math.hpp"
 #include "../Graphics/PostProcessFilter.h"
+#include "../Thread/LockStatistics.h"
 #include "Camera.h"
 
 #define NOMINMAX // thread may include windows.h
@@ -52,7 +53,7 @@ protected:
     mutable math::AABBf             updateArea;
 
     // mutex locks any camera modification
-    mutable boost::shared_mutex     accessMutex;
+    mutable thread::instrumented_mutex<boost::shared_mutex> accessMutex;
 };
 
 typedef boost::intrusive_ptr<CommonCamera>            common_camera_ptr;
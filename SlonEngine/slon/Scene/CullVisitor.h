@@ -1,8 +1,10 @@
 #ifndef __SLON_ENGINE_SCENE_GRAPH_CULL_VISITOR_H__
 #define __SLON_ENGINE_SCENE_GRAPH_CULL_VISITOR_H__
 
+#include "../Utility/math.hpp"
+#include "../Utility/Memory/linear_allocator.hpp"
 #include "VisitorImpl.hpp"
-#include <stack>
+#include <vector>
 
 namespace slon {
 
@@ -13,40 +15,253 @@ namespace graphics {
 
 namespace scene {
 
+// forward
+class LODGroup;
+class OcclusionBuffer;
+
 /** CullVisitor performs some function on the geode renderable
- * that is not culled by the cull function.
+ * that is not culled by the cull function. Visitor can cull several views at once, 
+ * @see setCameras.
  */
 class CullVisitor :
     public ConstVisitor
 {
 public:
-    typedef std::vector<const graphics::Renderable*>        renderable_vector;
+    static const unsigned max_views = 32;
+
+    typedef unsigned                                        view_mask;
+    typedef std::vector<view_mask, linear_allocator<view_mask> >   mask_vector;
+    typedef std::vector<const graphics::Renderable*, 
+                        linear_allocator<const graphics::Renderable*> > renderable_vector;
+    typedef std::vector<float, linear_allocator<float> >    depth_vector;
+    typedef std::vector<const math::Matrix4f*, 
+                        linear_allocator<const math::Matrix4f*> >   transform_vector;
+    typedef std::vector<math::AABBf, 
+                        linear_allocator<math::AABBf> >     bounds_vector;
+
+    struct occluder
+    {
+        math::AABBf             bounds;         /// box filled by the occluder
+        const math::Matrix4f*   worldMatrix;    /// transform of the box, 0 - box is in world space
+    };
+
+    typedef std::vector<occluder, linear_allocator<occluder> >  occluder_vector;
     typedef renderable_vector::iterator                     renderable_iterator;
     typedef renderable_vector::const_iterator               renderable_const_iterator;
 
-    typedef std::vector<const Light*>                       light_vector;
+    typedef std::vector<const Light*, 
+                        linear_allocator<const Light*> >    light_vector;
     typedef light_vector::iterator                          light_iterator;
     typedef light_vector::const_iterator                    light_const_iterator;
 
+    struct STATISTICS
+    {
+        size_t  numTested;          /// number of entity bounds tested
+        size_t  numFrustumCulled;   /// number of entities outside the frustum
+        size_t  numSmallCulled;     /// number of entities with too small projected area
+        size_t  numOccluded;        /// number of renderables removed by the occlusion culling
+        size_t  numEmitted;         /// number of collected renderables
+        size_t  numLODSelections;   /// number of visible LOD groups
+        size_t  numLODSwitches;     /// number of LOD groups changed their level since last cull of the camera
+        size_t  numLODCulled;       /// number of LOD groups too small for any level
+        size_t  numLODTriangles;    /// triangles of the selected levels
+        size_t  numLODBaseTriangles;/// triangles of the most detailed levels of the same groups
+
+        STATISTICS()
+        :   numTested(0)
+        ,   numFrustumCulled(0)
+        ,   numSmallCulled(0)
+        ,   numOccluded(0)
+        ,   numEmitted(0)
+        ,   numLODSelections(0)
+        ,   numLODSwitches(0)
+        ,   numLODCulled(0)
+        ,   numLODTriangles(0)
+        ,   numLODBaseTriangles(0)
+        {}
+    };
+
+protected:
+    struct traverse_node
+    {
+        explicit traverse_node(const Node* node_ = 0, unsigned updateInterval_ = 1, view_mask viewMask_ = ~0u)
+        :   node(node_)
+        ,   updateInterval(updateInterval_)
+        ,   viewMask(viewMask_)
+        {}
+
+        const Node* node;
+        unsigned    updateInterval;
+        view_mask   viewMask;
+    };
+
+    // views of the renderable collected during multi view culling
+    struct renderable_views
+    {
+        view_mask       mask;           /// views seeing the renderable
+        bool            hasPosition;    /// depth of the renderable is the view depth of the position
+        math::Vector3f  position;       /// world space position measured by getViewDepth
+    };
+
+    typedef std::vector<traverse_node, linear_allocator<traverse_node> >        node_vector;
+    typedef std::vector<renderable_views, linear_allocator<renderable_views> >  renderable_views_vector;
+
 public:
-    CullVisitor(const Camera* camera_ = 0) :
-        camera(camera_)
-    {}
+    /** Create cull visitor.
+     * @param camera_ - camera for culling.
+     * @param arena - arena for the collected renderables and lights, 0 - use heap. 
+     * Call release before resetting arena.
+     */
+    CullVisitor(const Camera* camera_ = 0, linear_arena* arena = 0);
 
     // Override NodeVisitor
     void traverse(const scene::Node& node);
 
-    /** Get camera of the CullVisitor */
+    /** Traverse node visible only by some of the views.
+     * @param node - node to traverse.
+     * @param viewMask - views to test node against, bit per view.
+     */
+    void traverse(const scene::Node& node, view_mask viewMask);
+
+    /** Get camera of the CullVisitor, first camera if visitor culls several views. */
     const Camera* getCamera() const { return camera; }
 
     /** Set camera for culling */
-    void setCamera(const Camera* camera_) { camera = camera_; }
+    void setCamera(const Camera* camera_);
+
+    /** Set cameras to cull their views at once. Entities are tested against every view they
+     * may be visible in, so scene is traversed once for all views. Collected renderables, lights 
+     * and occluders remember mask of the views seeing them, lists of the views are built by gatherView.
+     * LOD is selected per view, other camera dependent entities see the first camera.
+     * @param cameras - cameras of the views.
+     * @param numCameras - number of the cameras, at most max_views.
+     */
+    void setCameras(const Camera* const* cameras, unsigned numCameras);
+
+    /** Get number of the culled views. */
+    unsigned getNumViews() const { return numViews; }
+
+    /** Get camera of the view. */
+    const Camera* getViewCamera(unsigned view) const { return cameras[view]; }
+
+    /** Get culling statistics of the view since last clear. */
+    const STATISTICS& getViewStatistics(unsigned view) const { return viewStatistics[view]; }
+
+    /** Replace collected objects with the objects of the view collected by the visitor culled 
+     * several views. Camera of the view becomes culling camera, renderable depths are measured 
+     * from it. Visitor keeps culling statistics of the view.
+     * @param multiView - visitor performed culling of several views.
+     * @param view - index of the view in the multiView visitor.
+     */
+    void gatherView(const CullVisitor& multiView, unsigned view);
+
+    /** Set minimum projected area of the entity bounds in pixels, smaller entities are culled. 0 - disable. */
+    void setMinScreenArea(float minScreenArea_) { minScreenArea = minScreenArea_; }
+
+    /** Get minimum projected area of the entity bounds in pixels. */
+    float getMinScreenArea() const { return minScreenArea; }
 
-    /** Collect Renderable */
-    void addRenderable(const graphics::Renderable* renderable) { renderables.push_back(renderable); }
+    /** Test entity bounds against camera frustum and minimum screen area. Entities
+     * call it before collecting their renderables. If visitor culls several views, objects
+     * collected afterwards are assigned to the views seeing the bounds.
+     * @param worldBounds - world space bounds of the entity.
+     * @return true if entity is visible by any view or there is no camera.
+     */
+    bool isVisible(const math::AABBf& worldBounds);
+
+    /** Select detail level of the LOD group for the culling camera.
+     * @return selected level, LODGroup::getNumLevels() if group is too small to be rendered.
+     */
+    unsigned selectLevel(const LODGroup& lodGroup);
+
+    /** Get skinning and animation update interval of the accepted entity, in frames. Entities
+     * under coarse levels of the LOD groups may update less frequently.
+     */
+    unsigned getUpdateInterval() const { return updateInterval; }
+
+    /** Collect Renderable.
+     * @param renderable - renderable to collect.
+     * @param depth - view space depth of the renderable, used for sorting. @see getViewDepth
+     * @param worldMatrix - world matrix of the renderable. Renderables shared by several nodes
+     * must specify it, so renderer sets it to the shared effect. Must be valid until rendering ends.
+     * @param worldBounds - world space bounds of the renderable, used for occlusion culling.
+     * Empty bounds - renderable is never occluded.
+     */
+    void addRenderable( const graphics::Renderable* renderable, 
+                        float                       depth = 0.0f, 
+                        const math::Matrix4f*       worldMatrix = 0,
+                        const math::AABBf&          worldBounds = bounds<math::AABBf>::inv_infinite() ) 
+    { 
+        renderables.push_back(renderable); 
+        depths.push_back(depth); 
+        worldMatrices.push_back(worldMatrix);
+        renderableBounds.push_back(worldBounds);
+        if (numViews > 1)
+        {
+            renderable_views views = { entityMask, hasDepthPosition, depthPosition };
+            renderableViews.push_back(views);
+        }
+        ++statistics.numEmitted;
+    }
+
+    /** Set buffer for occlusion culling, 0 - disable occlusion culling. */
+    void setOcclusionBuffer(OcclusionBuffer* occlusionBuffer_) { occlusionBuffer = occlusionBuffer_; }
+
+    /** Get buffer for occlusion culling. */
+    OcclusionBuffer* getOcclusionBuffer() const { return occlusionBuffer; }
+
+    /** Collect occluder. Occluders are rasterized into the occlusion buffer by cullOccluded.
+     * @param bounds - box entirely filled by the occluder.
+     * @param worldMatrix - transform of the box, must be valid until occluders are rasterized, 0 - box is in world space.
+     */
+    void addOccluder(const math::AABBf& bounds, const math::Matrix4f* worldMatrix = 0) 
+    { 
+        if (occlusionBuffer) 
+        {
+            occluder o = { bounds, worldMatrix };
+            occluders.push_back(o); 
+            if (numViews > 1) {
+                occluderMasks.push_back(entityMask);
+            }
+        }
+    }
+
+    /** Rasterize collected occluders into the occlusion buffer and remove renderables hidden by them.
+     * Does nothing if there is no occlusion buffer or camera.
+     * @return number of removed renderables.
+     */
+    size_t cullOccluded();
+
+    /** Get view space depth of the point using culling camera. If visitor culls several views,
+     * renderables collected afterwards are sorted by the depth of the point in their views.
+     * @param position - world space position.
+     * @return distance from the camera along view direction or 0 if there is no camera.
+     */
+    float getViewDepth(const math::Vector3f& position) const;
+
+    /** Get view space depth of the collected renderable. */
+    float getRenderableDepth(renderable_const_iterator renderable) const { return depths[renderable - renderables.begin()]; }
+
+    /** Get world matrix of the collected renderable, 0 if renderable binds its own. */
+    const math::Matrix4f* getRenderableWorldMatrix(renderable_const_iterator renderable) const { return worldMatrices[renderable - renderables.begin()]; }
 
     /** Collect Light */
-    void addLight(const Light* light) { lights.push_back(light); }
+    void addLight(const Light* light) 
+    { 
+        lights.push_back(light); 
+        if (numViews > 1) {
+            lightMasks.push_back(entityMask);
+        }
+    }
+
+    /** Remove collected lights in the range. */
+    void removeLights(light_iterator first, light_iterator last)
+    {
+        if ( !lightMasks.empty() ) {
+            lightMasks.erase( lightMasks.begin() + (first - lights.begin()), lightMasks.begin() + (last - lights.begin()) );
+        }
+        lights.erase(first, last);
+    }
 
     /** Get begin iterator of collected lights vector. */
     light_iterator beginLight() { return lights.begin(); }
@@ -72,16 +287,54 @@ public:
     /** Get end iterator of collected renderable vector. */
     renderable_const_iterator endRenderable() const { return renderables.end(); }
 
-    /** Remove all collected lights and renderables */
+    /** Get culling statistics since last clear. */
+    const STATISTICS& getStatistics() const { return statistics; }
+
+    /** Remove all collected lights and renderables, reset statistics. */
     void clear();
 
+    /** Remove all collected lights and renderables and free their storage. */
+    void release();
+
     virtual ~CullVisitor() {}
 
+protected:
+    /** Test bounds against camera frustum and minimum screen area, count tests in the statistics. */
+    bool isVisible(const math::AABBf& worldBounds, const Camera& camera, STATISTICS& statistics) const;
+
+    /** Select detail level of the LOD group for the camera, count selection in the statistics. */
+    unsigned selectLevel(const LODGroup& lodGroup, const Camera& camera, STATISTICS& statistics) const;
+
+    /** Get view space depth of the point using camera. */
+    float getViewDepth(const math::Vector3f& position, const Camera& camera) const;
+
+    /** Get projected radius of the bounds in pixels, -1 if camera is inside bounds. */
+    float getScreenRadius(const math::AABBf& worldBounds, const Camera& camera) const;
+
 protected:
     const Camera*           camera;
-    std::stack<const Node*> forTraverse;
+    node_vector             forTraverse;
     light_vector            lights;
     renderable_vector       renderables;
+    depth_vector            depths;
+    transform_vector        worldMatrices;
+    bounds_vector           renderableBounds;
+    occluder_vector         occluders;
+    OcclusionBuffer*        occlusionBuffer;
+    float                   minScreenArea;
+    unsigned                updateInterval;
+    STATISTICS              statistics;
+
+    // multi view culling
+    const Camera*           cameras[max_views];
+    unsigned                numViews;
+    view_mask               entityMask;
+    mutable bool            hasDepthPosition;
+    mutable math::Vector3f  depthPosition;
+    renderable_views_vector renderableViews;
+    mask_vector             lightMasks;
+    mask_vector             occluderMasks;
+    STATISTICS              viewStatistics[max_views];
 };
 
 } // namespace scene
@@ -19,6 +19,7 @@ namespace scene {
     class Group;
     class Joint;
     class Light;
+    class LODGroup;
     class MatrixTransform;
     class Node;
     class Skeleton;
@@ -52,6 +53,8 @@ namespace scene {
     typedef boost::intrusive_ptr<const Joint>           const_joint_ptr;
     typedef boost::intrusive_ptr<Light>                 light_ptr;
     typedef boost::intrusive_ptr<const Light>           const_light_ptr;
+    typedef boost::intrusive_ptr<LODGroup>              lod_group_ptr;
+    typedef boost::intrusive_ptr<const LODGroup>        const_lod_group_ptr;
     typedef boost::intrusive_ptr<MatrixTransform>       matrix_transform_ptr;
     typedef boost::intrusive_ptr<const MatrixTransform> const_matrix_transform_ptr;
     typedef boost::intrusive_ptr<Node>                  node_ptr;
@@ -0,0 +1,137 @@
+#ifndef __SLON_ENGINE_SCENE_GRAPH_LOD_GROUP_H__
+#define __SLON_ENGINE_SCENE_GRAPH_LOD_GROUP_H__
+
+#include "../Utility/math.hpp"
+#include "CullVisitor.h"
+#include "Group.h"
+#include <vector>
+
+namespace slon {
+namespace scene {
+
+/** Group selecting one of its children for rendering by the projected size of the group bounds.
+ * Children are detail levels, the first child is the most detailed. Level is used while
+ * projected diameter of the bounds relative to the viewport height is not less than the
+ * screen size of the level. Group is not rendered if it is smaller than the screen size
+ * of the last level. To prevent popping at the threshold, switch to the coarser level
+ * happens below (1 - hysteresis) * screenSize and back to the finer level above
+ * (1 + hysteresis) * screenSize of that level. Selection is tracked per camera.
+ */
+class SLON_PUBLIC LODGroup :
+    public Group
+{
+friend class TransformVisitor;
+public:
+    static const unsigned invalid_level = ~0u;
+    static const unsigned max_cameras   = CullVisitor::max_views;
+
+    struct level_desc
+    {
+        float       screenSize;     /// min projected diameter of the bounds relative to the viewport height
+        unsigned    updateInterval; /// skinning and animation update interval of the level, frames
+        size_t      numTriangles;   /// number of triangles of the level, used for statistics
+
+        level_desc(float screenSize_ = 0.0f, unsigned updateInterval_ = 1, size_t numTriangles_ = 0)
+        :   screenSize(screenSize_)
+        ,   updateInterval(updateInterval_)
+        ,   numTriangles(numTriangles_)
+        {}
+    };
+
+public:
+    LODGroup();
+    LODGroup(const hash_string& name);
+
+    // Override Serializable
+    const char* serialize(database::OArchive& ar) const;
+    void        deserialize(database::IArchive& ar);
+
+    // Override Node
+    using Group::accept;
+
+    TYPE getNodeType() const { return LOD_GROUP; }
+
+    /** Setup detail level.
+     * @param level - index of the level, child with the same index keeps level geometry.
+     * @param desc - switch threshold and update rate of the level. Screen sizes of
+     * the levels must decrease.
+     */
+    void setLevel(unsigned level, const level_desc& desc);
+
+    /** Get description of the detail level. Levels without description have zero screen size. */
+    level_desc getLevel(unsigned level) const { return level < levels.size() ? levels[level] : level_desc(); }
+
+    /** Get number of detail levels - number of children of the group. */
+    unsigned getNumLevels() const;
+
+    /** Get node of the detail level, 0 if there is no such child. */
+    const Node* getLevelNode(unsigned level) const;
+
+    /** Set hysteresis of the level switches, relative to the level screen size. */
+    void setHysteresis(float hysteresis_) { hysteresis = hysteresis_; }
+
+    /** Get hysteresis of the level switches. */
+    float getHysteresis() const { return hysteresis; }
+
+    /** Set bounds of the levels in the group space. Empty bounds - merge world bounds of the
+     * entities of the level subtrees during transform traverse.
+     */
+    void setBounds(const math::AABBf& bounds_) { bounds = bounds_; }
+
+    /** Get bounds of the levels in the group space. */
+    const math::AABBf& getBounds() const { return bounds; }
+
+    /** Get world space bounds of the levels computed during last transform traverse. */
+    const math::AABBf& getWorldBounds() const { return worldBounds; }
+
+    /** Select detail level for the projected size without camera tracking.
+     * @param screenSize - projected diameter of the bounds relative to the viewport height.
+     * @param currentLevel - level selected last time or invalid_level.
+     * @return selected level, getNumLevels() if group is too small to be rendered.
+     */
+    unsigned selectLevel(float screenSize, unsigned currentLevel = invalid_level) const;
+
+    /** Select detail level for the camera, uses level previously selected for the camera.
+     * @param camera - camera tracking the selection.
+     * @param screenSize - projected diameter of the bounds relative to the viewport height.
+     * @param switched - set to true if selected level differs from the previous one for the camera.
+     * @return selected level, getNumLevels() if group is too small to be rendered.
+     */
+    unsigned selectLevel(const Camera* camera, float screenSize, bool* switched = 0) const;
+
+    /** Get update interval of the finest level recently selected by the cameras. Animation
+     * of the group can use it to update at the rate of the most detailed view.
+     */
+    unsigned getUpdateInterval() const;
+
+private:
+    /** Compute world bounds from the bounds set by user. */
+    void accept(TransformVisitor& visitor);
+
+    /** Use merged world bounds of the levels if bounds are not set, called after levels are traversed. */
+    void setLevelBounds(const math::AABBf& levelBounds);
+
+private:
+    struct camera_level
+    {
+        const Camera*   camera;
+        unsigned        level;
+    };
+
+    typedef std::vector<level_desc>  level_vector;
+
+private:
+    level_vector            levels;
+    float                   hysteresis;
+    math::AABBf             bounds;
+    math::AABBf             worldBounds;
+
+    // selection of the cameras
+    mutable camera_level    cameraLevels[max_cameras];
+    mutable unsigned        nextCamera;
+};
+
+} // namespace scene
+} // namespace slon
+
+#endif // __SLON_ENGINE_SCENE_GRAPH_LOD_GROUP_H__
@@ -4,6 +4,7 @@
 #include "../Database/Serializable.h"
 #include "../Utility/hash_string.hpp"
 #include "../Log/Forward.h"
+#include "../Thread/LockFreeQueue.h"
 #include "Forward.h"
 
 namespace slon {
@@ -15,6 +16,7 @@ namespace scene {
 class SLON_PUBLIC Node
 :   public Referenced
 ,   public database::Serializable
+,   public thread::mpsc_queue_hook<Node>
 {
 friend class Group;
 public:
@@ -28,7 +30,8 @@ public:
         ENTITY_BIT    = 1 << 4,
         LIGHT_BIT     = 1 << 5,
         CAMERA_BIT    = 1 << 6,
-        GEODE_BIT     = 1 << 7
+        GEODE_BIT     = 1 << 7,
+        LOD_BIT       = 1 << 8
     };
 
     /// Type of the scene graph node
@@ -38,6 +41,7 @@ public:
         SKELETON  = SKELETON_BIT,
         GROUP     = GROUP_BIT,
         TRANSFORM = GROUP | TRANSFORM_BIT,
+        LOD_GROUP = GROUP | LOD_BIT,
         JOINT     = TRANSFORM | JOINT_BIT,
         ENTITY    = ENTITY_BIT,
         LIGHT     = ENTITY | LIGHT_BIT,
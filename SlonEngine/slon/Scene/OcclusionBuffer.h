@@ -0,0 +1,116 @@
+#ifndef __SLON_ENGINE_SCENE_OCCLUSION_BUFFER_H__
+#define __SLON_ENGINE_SCENE_OCCLUSION_BUFFER_H__
+
+#include <vector>
+#include "../Thread/StartStopTimer.h"
+#include "../Utility/math.hpp"
+
+namespace slon {
+namespace scene {
+
+/** Low resolution depth buffer rasterized on CPU. Designated occluders are rasterized into the
+ * buffer, then bounding boxes are tested against hierarchical depth (each level keeps farthest
+ * depth of the 2x2 texels of the previous level). Box is occluded if it is farther than
+ * the farthest occluder depth in every texel it covers. Buffer stores normalized device depth,
+ * so it works with perspective and orthographic projections.
+ */
+class SLON_PUBLIC OcclusionBuffer
+{
+public:
+    struct STATISTICS
+    {
+        size_t  numOccluderTriangles;   /// number of rasterized occluder triangles
+        size_t  numTested;              /// number of tested boxes
+        size_t  numCulled;              /// number of boxes found occluded
+        double  rasterizeTime;          /// time spent rasterizing occluders and building hierarchy, seconds
+        double  testTime;               /// time spent testing boxes, seconds
+
+        STATISTICS()
+        :   numOccluderTriangles(0)
+        ,   numTested(0)
+        ,   numCulled(0)
+        ,   rasterizeTime(0.0)
+        ,   testTime(0.0)
+        {}
+    };
+
+public:
+    /** Create occlusion buffer.
+     * @param width - width of the buffer, rounded up to the multiple of 4.
+     * @param height - height of the buffer.
+     */
+    OcclusionBuffer(unsigned width = 256, unsigned height = 128);
+
+    /** Clear buffer and setup view projection matrix for the rasterized occluders and tested boxes. */
+    void setViewProjection(const math::Matrix4f& viewProjection);
+
+    /** Rasterize occluder triangles. Triangles crossing the near plane are skipped.
+     * @param vertices - world space vertices of the occluder.
+     * @param indices - triangle list indices.
+     * @param numIndices - number of indices.
+     */
+    void rasterize(const math::Vector3f* vertices, const unsigned* indices, size_t numIndices);
+
+    /** Rasterize solid box occluder.
+     * @param box - world space box of the occluder.
+     */
+    void rasterize(const math::AABBf& box);
+
+    /** Rasterize solid box occluder transformed by the matrix. Unlike world space bounds of the
+     * transformed box, rotated box doesn't cover more than the occluder.
+     * @param box - box of the occluder in the space of the world matrix.
+     * @param worldMatrix - transform of the box.
+     */
+    void rasterize(const math::AABBf& box, const math::Matrix4f& worldMatrix);
+
+    /** Build depth hierarchy of the rasterized occluders. Call after rasterizing all occluders. */
+    void buildHierarchy();
+
+    /** Test box against the depth hierarchy.
+     * @param box - world space box.
+     * @return true if box is hidden by the occluders.
+     */
+    bool isOccluded(const math::AABBf& box);
+
+    /** Get width of the buffer. */
+    unsigned getWidth() const { return levels[0].width; }
+
+    /** Get height of the buffer. */
+    unsigned getHeight() const { return levels[0].height; }
+
+    /** Get depth of the rasterized occluders in normalized device coordinates, 1 - nothing rasterized. */
+    float getDepth(unsigned x, unsigned y) const { return levels[0].depth[y * levels[0].width + x]; }
+
+    /** Get statistics accumulated since last reset. */
+    const STATISTICS& getStatistics() const { return statistics; }
+
+    /** Reset statistics. */
+    void resetStatistics() { statistics = STATISTICS(); }
+
+private:
+    struct level
+    {
+        unsigned            width;
+        unsigned            height;
+        std::vector<float>  depth;
+    };
+
+    typedef std::vector<level>  level_vector;
+
+private:
+    // vertices are in the buffer space: x, y - pixels, z - normalized device depth
+    void rasterizeTriangle(const math::Vector4f& a, const math::Vector4f& b, const math::Vector4f& c);
+
+private:
+    level_vector    levels;
+    math::Matrix4f  viewProjection;
+
+    // statistics
+    StartStopTimer  timer;
+    STATISTICS      statistics;
+};
+
+} // namespace scene
+} // namespace slon
+
+#endif // __SLON_ENGINE_SCENE_OCCLUSION_BUFFER_H__
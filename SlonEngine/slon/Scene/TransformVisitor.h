@@ -61,9 +61,16 @@ private:
 	/** Compute skinning matrix. */
 	void visitJoint(Transform* parentTransform, Joint& joint);
 
+    /** Compute group bounds, start merging bounds of the levels. */
+    void beginLODGroup(LODGroup& lodGroup);
+
+    /** Pass merged bounds of the levels to the group. */
+    void endLODGroup(LODGroup& lodGroup);
+
 private:
-    math::AABBf aabb;
-    Transform*  currentTransform;
+    math::AABBf                 aabb;
+    Transform*                  currentTransform;
+    std::vector<math::AABBf>    outerBounds;    /// bounds merged before entering LOD groups
 };
 
 } // namespace scene
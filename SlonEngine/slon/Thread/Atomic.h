@@ -0,0 +1,92 @@
+#ifndef __SLON_ENGINE_THREAD_ATOMIC_H__
+#define __SLON_ENGINE_THREAD_ATOMIC_H__
+
+#ifdef _MSC_VER
+#   include <boost/detail/interlocked.hpp>
+#elif !defined(__GNUC__)
+#   error "Atomic operations are not implemented for this compiler"
+#endif
+
+namespace slon {
+namespace thread {
+
+/** Atomically increment value. Full memory barrier.
+ * @return incremented value.
+ */
+inline long atomic_increment(volatile long* value)
+{
+#ifdef _MSC_VER
+    return BOOST_INTERLOCKED_INCREMENT(value);
+#else
+    return __sync_add_and_fetch(value, 1L);
+#endif
+}
+
+/** Atomically decrement value. Full memory barrier.
+ * @return decremented value.
+ */
+inline long atomic_decrement(volatile long* value)
+{
+#ifdef _MSC_VER
+    return BOOST_INTERLOCKED_DECREMENT(value);
+#else
+    return __sync_sub_and_fetch(value, 1L);
+#endif
+}
+
+/** Atomically compare value with comparand and replace it with exchange if they are equal. Full memory barrier.
+ * @return initial value.
+ */
+inline long atomic_compare_exchange(volatile long* value, long exchange, long comparand)
+{
+#ifdef _MSC_VER
+    return BOOST_INTERLOCKED_COMPARE_EXCHANGE(value, exchange, comparand);
+#else
+    return __sync_val_compare_and_swap(value, comparand, exchange);
+#endif
+}
+
+/** Atomically compare pointer with comparand and replace it with exchange if they are equal. Full memory barrier.
+ * @return initial value.
+ */
+template<typename T>
+inline T* atomic_compare_exchange(T* volatile* value, T* exchange, T* comparand)
+{
+#ifdef _MSC_VER
+    return static_cast<T*>( BOOST_INTERLOCKED_COMPARE_EXCHANGE_POINTER((void* volatile*)value, exchange, comparand) );
+#else
+    return __sync_val_compare_and_swap(value, comparand, exchange);
+#endif
+}
+
+/** Atomically replace value with exchange. Full memory barrier.
+ * @return initial value.
+ */
+inline long atomic_exchange(volatile long* value, long exchange)
+{
+#ifdef _MSC_VER
+    return BOOST_INTERLOCKED_EXCHANGE(value, exchange);
+#else
+    __sync_synchronize(); // __sync_lock_test_and_set is only acquire barrier
+    return __sync_lock_test_and_set(value, exchange);
+#endif
+}
+
+/** Atomically replace pointer with exchange. Full memory barrier.
+ * @return initial value.
+ */
+template<typename T>
+inline T* atomic_exchange(T* volatile* value, T* exchange)
+{
+#ifdef _MSC_VER
+    return static_cast<T*>( BOOST_INTERLOCKED_EXCHANGE_POINTER((void* volatile*)value, exchange) );
+#else
+    __sync_synchronize();
+    return __sync_lock_test_and_set(value, exchange);
+#endif
+}
+
+} // namespace thread
+} // namespace slon
+
+#endif // __SLON_ENGINE_THREAD_ATOMIC_H__
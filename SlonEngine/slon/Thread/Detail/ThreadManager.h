@@ -6,9 +6,11 @@
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <vector>
 #include "../Lock.h"
 #include "../ThreadManager.h"
+#include "../ThreadPool.h"
 
 namespace slon {
 
@@ -32,12 +34,22 @@ public:
 
     void delegateToThread(THREAD_SEMANTIC thread, const void_function& function);
 
+    ThreadPool& getThreadPool();
+
+    void                setThreadDesc(THREAD_SEMANTIC thread, const THREAD_DESC& desc);
+    const THREAD_DESC&  getThreadDesc(THREAD_SEMANTIC thread) const;
+    void                setWorkerThreadDesc(const THREAD_DESC& desc);
+    const THREAD_DESC&  getWorkerThreadDesc() const { return workerDesc; }
+    THREAD_PLACEMENT    getThreadPlacement(THREAD_SEMANTIC thread) const;
 
     // Called by Engine
     bool performDelayedFunctions(THREAD_SEMANTIC thread);
     void startThread(THREAD_SEMANTIC semantic, const void_function& function);
     void joinThread(THREAD_SEMANTIC semantic);
 
+private:
+    void threadEntry(THREAD_SEMANTIC semantic, const void_function& function);
+
 private:
     boost::thread               threads[MAX_THREAD_SEMANTIC];
     boost::thread::id           mainThreadId;
@@ -50,6 +62,16 @@ private:
     boost::mutex                delegateMutexes[MAX_THREAD_SEMANTIC];
     boost::condition_variable   delegateConditions[MAX_THREAD_SEMANTIC];
     delegate_vector             delegates[MAX_THREAD_SEMANTIC];
+
+    // worker threads
+    boost::mutex                threadPoolMutex;
+    boost::scoped_ptr<ThreadPool> threadPool;
+
+    // scheduling, index 0 is main thread
+    mutable boost::mutex        placementMutex;
+    THREAD_DESC                 descs[MAX_THREAD_SEMANTIC + 1];
+    THREAD_PLACEMENT            placements[MAX_THREAD_SEMANTIC + 1];
+    THREAD_DESC                 workerDesc;
 };
 
 } // namespace detail
@@ -0,0 +1,153 @@
+#ifndef __SLON_ENGINE_THREAD_LOCK_FREE_QUEUE_H__
+#define __SLON_ENGINE_THREAD_LOCK_FREE_QUEUE_H__
+
+#include <boost/noncopyable.hpp>
+#include "Atomic.h"
+
+namespace slon {
+namespace thread {
+
+/** Derive from hook to store objects in the mpsc_queue. Object can be stored
+ * in single queue at once.
+ */
+template<typename T>
+class mpsc_queue_hook
+{
+template<typename Y> friend class mpsc_queue;
+public:
+    mpsc_queue_hook()
+    :   queueNext(0)
+    ,   queued(0)
+    {}
+
+    mpsc_queue_hook(const mpsc_queue_hook& /*other*/)
+    :   queueNext(0)
+    ,   queued(0)
+    {}
+
+    mpsc_queue_hook& operator = (const mpsc_queue_hook& /*other*/) { return *this; }
+
+    /** Check whether object is waiting in the queue. */
+    bool in_queue() const { return queued != 0; }
+
+private:
+    T*              queueNext;
+    volatile long   queued;
+};
+
+/** Intrusive lock free multi producer single consumer queue. Producers push objects
+ * with single CAS into the LIFO list, consumer grabs the whole list and restores push order.
+ * Pushing object which is already in the queue does nothing.
+ * @tparam T - type of the queue objects, must be derived from mpsc_queue_hook<T>.
+ */
+template<typename T>
+class mpsc_queue :
+    public boost::noncopyable
+{
+private:
+    typedef mpsc_queue_hook<T> hook_type;
+
+public:
+    mpsc_queue()
+    :   head(0)
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+    ,   numPushes(0)
+    ,   numDuplicates(0)
+    ,   numRetries(0)
+#endif
+    {}
+
+    /** Put object into the queue. Can be called from any thread.
+     * @return false if object is already in the queue.
+     */
+    bool push(T* obj)
+    {
+        hook_type* hook = obj;
+        if ( atomic_compare_exchange(&hook->queued, 1L, 0L) != 0 ) 
+        {
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+            atomic_increment(&numDuplicates);
+#endif
+            return false;
+        }
+
+        T* first = head;
+        for (;;)
+        {
+            hook->queueNext = first;
+            T* observed = atomic_compare_exchange(&head, obj, first);
+            if (observed == first) {
+                break;
+            }
+            first = observed;
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+            atomic_increment(&numRetries);
+#endif
+        }
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+        atomic_increment(&numPushes);
+#endif
+
+        return true;
+    }
+
+    /** Move all queued objects into the output iterator in the order they were pushed. 
+     * Must be called only from the consumer thread. Objects can be pushed again while
+     * they are processed, they will be stored for the next pop_all.
+     */
+    template<typename OutputIterator>
+    OutputIterator pop_all(OutputIterator out)
+    {
+        T* list = atomic_exchange(&head, (T*)0);
+        
+        // reverse LIFO list
+        T* reversed = 0;
+        while (list)
+        {
+            hook_type* hook = list;
+            T*         next = hook->queueNext;
+            hook->queueNext = reversed;
+            reversed        = list;
+            list            = next;
+        }
+
+        while (reversed)
+        {
+            hook_type* hook = reversed;
+            T*         next = hook->queueNext;
+            hook->queueNext = 0;
+            atomic_exchange(&hook->queued, 0L);
+            *out++   = reversed;
+            reversed = next;
+        }
+
+        return out;
+    }
+
+    /** Check whether queue is empty. Result is approximate if producers are working. */
+    bool empty() const { return head == 0; }
+
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+    /** Get number of pushed objects. */
+    long num_pushes() const { return numPushes; }
+
+    /** Get number of rejected pushes of the objects already in the queue. */
+    long num_duplicates() const { return numDuplicates; }
+
+    /** Get number of CAS failures, measures contention between producers. */
+    long num_retries() const { return numRetries; }
+#endif
+
+private:
+    T* volatile     head;
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+    volatile long   numPushes;
+    volatile long   numDuplicates;
+    volatile long   numRetries;
+#endif
+};
+
+} // namespace thread
+} // namespace slon
+
+#endif // __SLON_ENGINE_THREAD_LOCK_FREE_QUEUE_H__
@@ -0,0 +1,137 @@
+#ifndef __SLON_ENGINE_THREAD_LOCK_STATISTICS_H__
+#define __SLON_ENGINE_THREAD_LOCK_STATISTICS_H__
+
+#include <cstddef>
+#include <iosfwd>
+#include "../Config.h"
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+#   include "Atomic.h"
+#endif
+
+namespace slon {
+namespace thread {
+
+/** Number of buckets in the lock wait time histogram. */
+const size_t lock_wait_histogram_size = 16;
+
+/** Maximum number of named locks statistics is collected for. */
+const size_t max_num_lock_statistics = 128;
+
+/** Statistics of the named lock. Locks with same name share statistics. */
+struct lock_statistics
+{
+    const char*     name;
+    volatile long   numAcquisitions;
+    volatile long   numContendedAcquisitions;
+    volatile long   totalWaitTime;                              /// microseconds
+    volatile long   waitHistogram[lock_wait_histogram_size];    /// bucket i counts waits shorter than 2^i microseconds, last - the rest
+};
+
+/** Get statistics of the named lock, register lock if it is not registered. Doesn't allocate memory,
+ * so can be used by allocators.
+ * @param name - lock name, must persist for the program lifetime (e.g. string literal).
+ * @return statistics or 0 if there are too many named locks.
+ */
+SLON_PUBLIC lock_statistics* get_lock_statistics(const char* name);
+
+/** Get number of the named locks. */
+SLON_PUBLIC size_t get_num_lock_statistics();
+
+/** Get statistics of the i-th named lock. */
+SLON_PUBLIC const lock_statistics& get_lock_statistics(size_t i);
+
+/** Reset counters of the all locks. */
+SLON_PUBLIC void reset_lock_statistics();
+
+/** Print table of the lock statistics: acquisitions, contended acquisitions, wait time and histogram. */
+SLON_PUBLIC void dump_lock_statistics(std::ostream& os);
+
+/** Get time for measuring lock waits, in seconds. */
+SLON_PUBLIC double get_lock_statistics_time();
+
+/** Record contended acquisition of the lock. */
+SLON_PUBLIC void record_lock_wait(lock_statistics* statistics, double waitTime);
+
+/** Mutex wrapper collecting lock statistics if engine is built with SLON_ENGINE_THREAD_STATISTICS,
+ * otherwise it is the wrapped mutex. Uncontended acquisition costs try_lock and atomic increment, 
+ * contended one additionally measures wait time.
+ * @tparam Mutex - mutex type having try_lock. Shared locking requires try_lock_shared.
+ */
+template<typename Mutex>
+class instrumented_mutex :
+    public Mutex
+{
+public:
+    /** Acquisition on initialization lock, for mutexes without boost lock types. */
+    class scoped_lock
+    {
+    public:
+        explicit scoped_lock(instrumented_mutex& mutex_) : 
+            mutex(mutex_)
+        {
+            mutex.lock();
+        }
+
+        ~scoped_lock()
+        {
+            mutex.unlock();
+        }
+
+    private:
+        scoped_lock(const scoped_lock&);
+        scoped_lock& operator = (const scoped_lock&);
+
+    private:
+        instrumented_mutex& mutex;
+    };
+
+public:
+    /** Create mutex.
+     * @param name - lock name, must persist for the program lifetime (e.g. string literal).
+     */
+    explicit instrumented_mutex(const char* name)
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+    :   statistics( get_lock_statistics(name) )
+#endif
+    {
+        (void)name;
+    }
+
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+    void lock()
+    {
+        if ( !Mutex::try_lock() )
+        {
+            double startTime = get_lock_statistics_time();
+            Mutex::lock();
+            record_lock_wait( statistics, get_lock_statistics_time() - startTime );
+        }
+
+        if (statistics) {
+            atomic_increment(&statistics->numAcquisitions);
+        }
+    }
+
+    void lock_shared()
+    {
+        if ( !Mutex::try_lock_shared() )
+        {
+            double startTime = get_lock_statistics_time();
+            Mutex::lock_shared();
+            record_lock_wait( statistics, get_lock_statistics_time() - startTime );
+        }
+
+        if (statistics) {
+            atomic_increment(&statistics->numAcquisitions);
+        }
+    }
+
+private:
+    lock_statistics* statistics;
+#endif
+};
+
+} // namespace thread
+} // namespace slon
+
+#endif // __SLON_ENGINE_THREAD_LOCK_STATISTICS_H__
@@ -0,0 +1,37 @@
+#ifndef __SLON_ENGINE_THREAD_MANUAL_TIMER_H__
+#define __SLON_ENGINE_THREAD_MANUAL_TIMER_H__
+
+#include "Timer.h"
+
+namespace slon {
+
+/** Timer which time is specified explicitly. Used to drive simulation with the 
+ * recorded or fixed time steps.
+ */
+class SLON_PUBLIC ManualTimer :
+    public Timer
+{
+public:
+    ManualTimer(double time_ = 0.0) :
+        time(time_)
+    {}
+
+    /** Setup current time */
+    void setTime(double time_) { time = time_; }
+
+    /** Advance current time */
+    void advance(double dt) { time += dt; }
+
+    // Override timer
+    double getTime() const { return time; }
+
+private:
+    double time;
+};
+
+typedef boost::intrusive_ptr<ManualTimer>         manual_timer_ptr;
+typedef boost::intrusive_ptr<const ManualTimer>   const_manual_timer_ptr;
+
+} // namespace slon
+
+#endif // __SLON_ENGINE_THREAD_MANUAL_TIMER_H__
@@ -2,6 +2,7 @@
 #define __SLON_ENGINE_THREAD_THREAD_MANAGER_H__
 
 #include <boost/function.hpp>
+#include <string>
 
 namespace slon {
 
@@ -10,6 +11,9 @@ class Engine;
 
 namespace thread {
 
+// Forward decl
+class ThreadPool;
+
 /** All threads in the Engine */
 enum THREAD_SEMANTIC
 {
@@ -21,6 +25,43 @@ enum THREAD_SEMANTIC
     MAX_THREAD_SEMANTIC =  3
 };
 
+/** Scheduling settings of the thread. */
+struct THREAD_DESC
+{
+    std::string         name;           /// thread name, empty - keep default
+    unsigned long long  affinityMask;   /// bit i allows thread to run on processor i, 0 - any processor
+    int                 priority;       /// nice value, lower is higher priority
+    bool                setPriority;    /// change priority of the thread, otherwise it is inherited
+
+    THREAD_DESC() :
+        affinityMask(0),
+        priority(0),
+        setPriority(false)
+    {}
+};
+
+/** Scheduling settings the thread actually runs with. */
+struct THREAD_PLACEMENT
+{
+    std::string         name;
+    unsigned long long  affinityMask;   /// processors thread may run on
+    int                 priority;       /// nice value
+    bool                started;        /// thread was started and placement is filled
+    bool                succeeded;      /// all settings from the THREAD_DESC were applied
+
+    THREAD_PLACEMENT() :
+        affinityMask(0),
+        priority(0),
+        started(false),
+        succeeded(false)
+    {}
+};
+
+/** Apply scheduling settings to the calling thread.
+ * @return placement of the thread after applying settings.
+ */
+SLON_PUBLIC THREAD_PLACEMENT applyThreadDesc(const THREAD_DESC& desc);
+
 class SLON_PUBLIC ThreadManager
 {
 public:
@@ -63,6 +104,31 @@ public:
         delegateToThread( thread, boost::ref(functionWithResult) );
         return functionWithResult.result;
     }
+
+    /** Get pool of worker threads for splitting work of the engine threads. Pool is created
+     * on first call.
+     */
+    virtual ThreadPool& getThreadPool() = 0;
+
+    /** Set scheduling settings of the engine thread. Settings are applied when thread starts, 
+     * settings of the main thread are applied immediately.
+     */
+    virtual void setThreadDesc(THREAD_SEMANTIC thread, const THREAD_DESC& desc) = 0;
+
+    /** Get scheduling settings of the engine thread. */
+    virtual const THREAD_DESC& getThreadDesc(THREAD_SEMANTIC thread) const = 0;
+
+    /** Set scheduling settings of the thread pool workers. Worker i is named "<name>-i" and
+     * pinned to the i-th processor of the affinity mask, round robin. Settings must be specified 
+     * before thread pool is created.
+     */
+    virtual void setWorkerThreadDesc(const THREAD_DESC& desc) = 0;
+
+    /** Get scheduling settings of the thread pool workers. */
+    virtual const THREAD_DESC& getWorkerThreadDesc() const = 0;
+
+    /** Get scheduling settings engine thread runs with. */
+    virtual THREAD_PLACEMENT getThreadPlacement(THREAD_SEMANTIC thread) const = 0;
 };
 
 /** Get current thread manager used by engine */
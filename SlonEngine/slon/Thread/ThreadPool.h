@@ -0,0 +1,79 @@
+#ifndef __SLON_ENGINE_THREAD_THREAD_POOL_H__
+#define __SLON_ENGINE_THREAD_THREAD_POOL_H__
+
+#define NOMINMAX // thread may include windows.h
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+#include "../Config.h"
+#include "ThreadManager.h"
+
+namespace slon {
+namespace thread {
+
+/** Pool of worker threads performing indexed tasks. Calling thread takes part in the 
+ * execution, so pool without workers simply runs tasks sequentially. Pool executes
+ * single job at once, if it is busy (e.g. nested job or concurrent call from other thread)
+ * tasks are run sequentially on the calling thread.
+ */
+class SLON_PUBLIC ThreadPool :
+    public boost::noncopyable
+{
+public:
+    typedef boost::function<void (size_t)> task_function;
+
+private:
+    struct job
+    {
+        const task_function*    task;
+        long                    numTasks;
+        volatile long           nextTask;
+    };
+
+    void workerCycle(size_t index);
+    void execute(job& j);
+
+public:
+    /** Create pool.
+     * @param numWorkers - number of worker threads. Use hardware concurrency - 1 if -1.
+     * @param workerDesc - scheduling settings of the workers. Worker i is named "<name>-i" and
+     * pinned to the i-th processor of the affinity mask, round robin.
+     */
+    explicit ThreadPool(int numWorkers = -1, const THREAD_DESC& workerDesc = THREAD_DESC());
+    ~ThreadPool();
+
+    /** Get number of worker threads, excluding calling thread. */
+    size_t getNumWorkers() const { return workers.size(); }
+
+    /** Get scheduling settings worker thread runs with. */
+    THREAD_PLACEMENT getWorkerPlacement(size_t i) const;
+
+    /** Call task(i) for every i in [0, numTasks) and wait for completion. Tasks may be 
+     * executed concurrently in any order, they must not throw.
+     */
+    void run(size_t numTasks, const task_function& task);
+
+private:
+    std::vector<boost::thread*> workers;
+    THREAD_DESC                 workerDesc;
+    std::vector<THREAD_PLACEMENT> workerPlacements;
+
+    // current job
+    boost::mutex                jobMutex;
+    mutable boost::mutex        mutex;
+    boost::condition_variable   wakeCondition;
+    boost::condition_variable   doneCondition;
+    job*                        currentJob;
+    unsigned                    generation;
+    int                         numActiveWorkers;
+    size_t                      numPlacedWorkers;
+    bool                        stopping;
+};
+
+} // namespace thread
+} // namespace slon
+
+#endif // __SLON_ENGINE_THREAD_THREAD_POOL_H__
@@ -1,6 +1,8 @@
 #ifndef __SLON_ENGINE_THREAD_UTILITY_H__
 #define __SLON_ENGINE_THREAD_UTILITY_H__
 
+#include <string>
+
 namespace slon {
 namespace thread {
 
@@ -10,6 +12,30 @@ namespace thread {
  */
 void sleep(double time);
 
+/** Set name of the calling thread visible in debuggers and system monitors. 
+ * Linux truncates names to 15 characters.
+ * @return true if succeeded.
+ */
+bool setCurrentThreadName(const std::string& name);
+
+/** Bind calling thread to the set of processors.
+ * @param affinityMask - bit i allows thread to run on the processor i. 0 allows any processor.
+ * @return true if succeeded.
+ */
+bool setCurrentThreadAffinity(unsigned long long affinityMask);
+
+/** Get set of processors calling thread may run on. */
+unsigned long long getCurrentThreadAffinity();
+
+/** Set scheduling priority of the calling thread.
+ * @param priority - unix nice value in [-20, 19], lower value means higher priority. 
+ * Windows maps it onto thread priority levels.
+ * @return true if succeeded. Raising priority usually requires privileges.
+ */
+bool setCurrentThreadPriority(int priority);
+
+/** Get scheduling priority of the calling thread, nice value. */
+int getCurrentThreadPriority();
 
 } // namespace thread
 } // namespace slon
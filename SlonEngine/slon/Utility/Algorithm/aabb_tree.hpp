@@ -11,6 +11,7 @@
 #include <queue>
 #include <sgl/Math/AABB.hpp>
 #include <sgl/Math/Intersection.hpp>
+#include <utility>
 
 namespace slon {
 
@@ -565,6 +566,68 @@ void perform_on_leaves( const aabb_tree<LeafData, RealType>& tree,
     }
 }
 
+/** Perform function on elements intersecting any of the specified volumes. Tree is traversed
+ * once for all volumes, node is tested only against volumes intersecting its parent.
+ * @tparam Volume - type of the volume body(AABB, Frustum, etc.).
+ * @param tree - tree for gathering elements.
+ * @param volumes - volumes for gathering, at most 32.
+ * @param numVolumes - number of volumes.
+ * @param functor - perform functor(visitor), called with element and mask of the volumes
+ * intersecting element bounds. Return true to stop traverse.
+ * @param rootMask - mask of the volumes to test the root against, e.g. volumes already known
+ * to intersect the tree bounds.
+ */
+template< typename LeafData,
+          typename RealType,
+          typename Functor,
+          typename Volume >
+void perform_on_leaves( const aabb_tree<LeafData, RealType>& tree,
+                        const Volume* const*                 volumes,
+                        unsigned                             numVolumes,
+                        Functor                              functor,
+                        unsigned                             rootMask = ~0u )
+{
+    typedef typename aabb_tree<LeafData, RealType>::volume_node volume_node;
+    typedef typename aabb_tree<LeafData, RealType>::leaf_node   leaf_node;
+    typedef std::pair<const volume_node*, unsigned>             masked_node;
+
+    assert(numVolumes <= 32);
+    const volume_node* root = tree.get_root();
+    if (!root) {
+        return;
+    }
+
+    std::queue<masked_node> queue;
+    queue.push( masked_node(root, rootMask & (numVolumes < 32 ? (1u << numVolumes) - 1 : ~0u)) );
+    while ( !queue.empty() )
+    {
+        masked_node node = queue.front();
+        queue.pop();
+
+        // leave volumes intersecting the node
+        unsigned mask = 0;
+        for (unsigned i = 0; i<numVolumes; ++i)
+        {
+            if ( (node.second & (1u << i)) && math::test_intersection( *volumes[i], node.first->get_bounds() ) ) {
+                mask |= 1u << i;
+            }
+        }
+
+        if (!mask) {
+            continue;
+        }
+
+        if ( node.first->is_internal() )
+        {
+            queue.push( masked_node(node.first->get_child(0), mask) );
+            queue.push( masked_node(node.first->get_child(1), mask) );
+        }
+        else if ( functor(static_cast<const leaf_node*>(node.first)->data, mask) ) {
+            return;
+        }
+    }
+}
+
 } // namespace slon
 
 #endif // SLON_ENGINE_UTILITY_ALGORITHM_AABB_TREE_HPP
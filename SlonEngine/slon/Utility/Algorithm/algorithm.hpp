@@ -15,7 +15,7 @@ struct vertex_compose_iterator :
     public boost::iterator_facade<
         vertex_compose_iterator<VertexType, FloatIteratorType>,
         VertexType,
-        boost::bidirectional_traversal_tag
+        boost::random_access_traversal_tag
     >
 {
 friend class boost::iterator_core_access;
@@ -35,6 +35,12 @@ public:
 private:
     void increment() { floatIter += stride; }
     void decrement() { floatIter -= stride; }
+    void advance(std::ptrdiff_t n) { floatIter += n * stride; }
+
+    std::ptrdiff_t distance_to(const vertex_compose_iterator& other) const
+    {
+        return (other.floatIter - floatIter) / std::ptrdiff_t(stride);
+    }
 
     bool equal(const vertex_compose_iterator& other) const
     {
@@ -76,9 +82,19 @@ const math::Matrix<RealType, n, 1>& to_vec(const math::Matrix<RealType, n, 1>& v
 template<typename RealType, int n>
 const math::Matrix<RealType, 1, n>& to_vec(const math::Matrix<RealType, 1, n>& vec) { return vec; }
 
-/** Compute axis aligned bounding box of the point cloud
+/** Convert floating point tuple to 3-component vector, homogeneous points are truncated to xyz. */
+template<typename Tuple>
+math::Vector3f to_vec3(const Tuple& tuple) { return to_vec(tuple); }
+
+template<typename RealType>
+const math::Matrix<RealType, 3, 1>& to_vec3(const math::Matrix<RealType, 3, 1>& vec) { return vec; }
+
+template<typename RealType>
+math::Matrix<RealType, 3, 1> to_vec3(const math::Matrix<RealType, 4, 1>& vec) { return math::xyz(vec); }
+
+/** Compute axis aligned bounding box of the point cloud. For large point clouds see parallel_compute_aabb.
  * @tparam Iterator - iterator type referencing at least
- * 3-component floating tuple. Tuple must overload operator [].
+ * 3-component floating tuple. Tuple must overload operator [], 4-component vectors are bounded by xyz.
  * @param beginIter - point cloud begin iterator.
  * @param endIter - point cloud end iterator.
  */
@@ -88,16 +104,16 @@ math::AABB<T, 3> compute_aabb( const Iterator& beginIter,
 {
     assert(beginIter != endIter && "Point cloud must have at least one point.");
 
-    math::AABB<T, 3> aabb( to_vec(*beginIter), to_vec(*beginIter) );
+    math::AABB<T, 3> aabb( to_vec3(*beginIter), to_vec3(*beginIter) );
     for (Iterator i = beginIter; i != endIter; ++i)
     {
-        aabb.extend( to_vec(*i) );
+        aabb.extend( to_vec3(*i) );
     }
 
     return aabb;
 }
 
-/** Transform Array of vertices by matrix
+/** Transform Array of vertices by matrix. For large arrays see parallel_transform_by_matrix.
  * @tparam InIterator - iterator type referencing at least
  * n-component floating tuple. Tuple must be convertible to Vector<RealType, n, 1>.
  * @tparam OutIterator - iterator type referencing at least
@@ -0,0 +1,341 @@
+#ifndef __SLON_ENGINE_UTILITY_ALGORITHM_PARALLEL_HPP__
+#define __SLON_ENGINE_UTILITY_ALGORITHM_PARALLEL_HPP__
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include "../../Thread/ThreadManager.h"
+#include "../../Thread/ThreadPool.h"
+#include "algorithm.hpp"
+
+namespace slon {
+
+/** Default number of elements processed by single task of the parallel algorithms. Ranges
+ * shorter than grain size are processed sequentially by calling thread.
+ */
+const size_t default_grain_size = 4096;
+
+namespace detail {
+
+    // number of chunks range is split into: not less than grain size, few per thread for balancing
+    inline size_t num_parallel_chunks(thread::ThreadPool& pool, size_t size, size_t grainSize)
+    {
+        size_t numChunks = (size + grainSize - 1) / std::max<size_t>(grainSize, 1);
+        return std::max<size_t>( std::min(numChunks, 4 * (pool.getNumWorkers() + 1)), 1 );
+    }
+
+    template<typename Func>
+    struct parallel_for_task
+    {
+        parallel_for_task(size_t first_, size_t size_, size_t numChunks_, Func& func_)
+        :   first(first_)
+        ,   size(size_)
+        ,   numChunks(numChunks_)
+        ,   func(func_)
+        {}
+
+        void operator () (size_t i) const
+        {
+            func( first + size * i / numChunks, first + size * (i + 1) / numChunks );
+        }
+
+        size_t  first;
+        size_t  size;
+        size_t  numChunks;
+        Func&   func;
+    };
+
+    template<typename T, typename MapFunc>
+    struct parallel_map_task
+    {
+        parallel_map_task(size_t first_, size_t size_, std::vector<T>& results_, MapFunc& map_)
+        :   first(first_)
+        ,   size(size_)
+        ,   results(results_)
+        ,   map(map_)
+        {}
+
+        // chunk boundaries are computed same way as in parallel_for_task
+        void operator () (size_t i) const
+        {
+            results[i] = map( first + size * i / results.size(), first + size * (i + 1) / results.size() );
+        }
+
+        size_t          first;
+        size_t          size;
+        std::vector<T>& results;
+        MapFunc&        map;
+    };
+
+    template<typename Iterator, typename Compare>
+    struct parallel_sort_task
+    {
+        parallel_sort_task(const Iterator& first_, const std::vector<size_t>& bounds_, size_t width_, Compare comp_)
+        :   first(first_)
+        ,   bounds(bounds_)
+        ,   width(width_)
+        ,   comp(comp_)
+        {}
+
+        // sort chunk if width is 0, otherwise merge pair of sorted runs
+        void operator () (size_t i) const
+        {
+            size_t numChunks = bounds.size() - 1;
+            if (width == 0) {
+                std::sort(first + bounds[i], first + bounds[i + 1], comp);
+            }
+            else
+            {
+                size_t begin  = 2 * width * i;
+                size_t middle = std::min(begin + width, numChunks);
+                size_t end    = std::min(begin + 2 * width, numChunks);
+                std::inplace_merge(first + bounds[begin], first + bounds[middle], first + bounds[end], comp);
+            }
+        }
+
+        Iterator                    first;
+        const std::vector<size_t>&  bounds;
+        size_t                      width;
+        Compare                     comp;
+    };
+
+    template<typename T, typename Iterator>
+    struct compute_aabb_task
+    {
+        compute_aabb_task(const Iterator& first_)
+        :   first(first_)
+        {}
+
+        math::AABB<T, 3> operator () (size_t begin, size_t end) const
+        {
+            return compute_aabb<T>(first + begin, first + end);
+        }
+
+        Iterator first;
+    };
+
+    template<typename T>
+    struct merge_aabb
+    {
+        math::AABB<T, 3> operator () (const math::AABB<T, 3>& a, const math::AABB<T, 3>& b) const
+        {
+            return math::merge(a, b);
+        }
+    };
+
+    template<typename InIterator, typename OutIterator, typename Matrix>
+    struct transform_by_matrix_task
+    {
+        transform_by_matrix_task(const InIterator& first_, const OutIterator& outFirst_, const Matrix& matrix_)
+        :   first(first_)
+        ,   outFirst(outFirst_)
+        ,   matrix(matrix_)
+        {}
+
+        void operator () (size_t begin, size_t end) const
+        {
+            transform_by_matrix(first + begin, first + end, outFirst + begin, matrix);
+        }
+
+        InIterator      first;
+        OutIterator     outFirst;
+        const Matrix&   matrix;
+    };
+
+} // namespace detail
+
+/** Get thread pool performing parallel algorithms by default: engine thread pool. */
+inline thread::ThreadPool& parallel_thread_pool()
+{
+    return thread::currentThreadManager().getThreadPool();
+}
+
+/** Call func(begin, end) for the subranges of [first, last) concurrently. Returns when whole range is processed.
+ * @param pool - thread pool performing tasks.
+ * @param first - first index of the range.
+ * @param last - index after last of the range.
+ * @param grainSize - minimum number of indices in the subrange.
+ * @param func - functor processing subrange, called as func(size_t begin, size_t end).
+ */
+template<typename Func>
+void parallel_for(thread::ThreadPool& pool, size_t first, size_t last, size_t grainSize, Func func)
+{
+    size_t size = last > first ? last - first : 0;
+    if (size <= grainSize)
+    {
+        if (size > 0) {
+            func(first, last);
+        }
+        return;
+    }
+
+    size_t numChunks = detail::num_parallel_chunks(pool, size, grainSize);
+    pool.run( numChunks, detail::parallel_for_task<Func>(first, size, numChunks, func) );
+}
+
+/** Call parallel_for using engine thread pool. */
+template<typename Func>
+void parallel_for(size_t first, size_t last, size_t grainSize, Func func)
+{
+    parallel_for(parallel_thread_pool(), first, last, grainSize, func);
+}
+
+/** Map subranges of [first, last) concurrently and reduce results. Results of the subranges are reduced
+ * sequentially in order of subranges, so result doesn't depend on the number of threads if reduce is associative.
+ * @param pool - thread pool performing tasks.
+ * @param first - first index of the range.
+ * @param last - index after last of the range. Range must be not empty.
+ * @param grainSize - minimum number of indices in the subrange.
+ * @param map - functor computing result of the subrange, called as map(size_t begin, size_t end).
+ * @param reduce - functor combining two results, called as reduce(const T& a, const T& b).
+ */
+template<typename T, typename MapFunc, typename ReduceFunc>
+T parallel_reduce(thread::ThreadPool& pool, size_t first, size_t last, size_t grainSize, MapFunc map, ReduceFunc reduce)
+{
+    assert(last > first && "Range must be not empty");
+
+    size_t size = last - first;
+    if (size <= grainSize) {
+        return map(first, last);
+    }
+
+    size_t numChunks = detail::num_parallel_chunks(pool, size, grainSize);
+    std::vector<T> results(numChunks);
+    pool.run( numChunks, detail::parallel_map_task<T, MapFunc>(first, size, results, map) );
+
+    T result = results[0];
+    for (size_t i = 1; i<results.size(); ++i) {
+        result = reduce(result, results[i]);
+    }
+
+    return result;
+}
+
+/** Call parallel_reduce using engine thread pool. */
+template<typename T, typename MapFunc, typename ReduceFunc>
+T parallel_reduce(size_t first, size_t last, size_t grainSize, MapFunc map, ReduceFunc reduce)
+{
+    return parallel_reduce<T>(parallel_thread_pool(), first, last, grainSize, map, reduce);
+}
+
+/** Sort range concurrently: sort subranges and merge them pairwise. Sort is not stable.
+ * @tparam Iterator - random access iterator.
+ * @param pool - thread pool performing tasks.
+ * @param beginIter - range begin iterator.
+ * @param endIter - range end iterator.
+ * @param comp - comparison functor.
+ * @param grainSize - minimum number of elements in the subrange.
+ */
+template<typename Iterator, typename Compare>
+void parallel_sort( thread::ThreadPool& pool,
+                    const Iterator&     beginIter,
+                    const Iterator&     endIter,
+                    Compare             comp,
+                    size_t              grainSize = default_grain_size )
+{
+    size_t size = endIter - beginIter;
+    if (size <= grainSize)
+    {
+        std::sort(beginIter, endIter, comp);
+        return;
+    }
+
+    size_t numChunks = detail::num_parallel_chunks(pool, size, grainSize);
+    std::vector<size_t> bounds(numChunks + 1);
+    for (size_t i = 0; i <= numChunks; ++i) {
+        bounds[i] = size * i / numChunks;
+    }
+
+    pool.run( numChunks, detail::parallel_sort_task<Iterator, Compare>(beginIter, bounds, 0, comp) );
+    for (size_t width = 1; width < numChunks; width *= 2) {
+        pool.run( (numChunks + 2 * width - 1) / (2 * width), detail::parallel_sort_task<Iterator, Compare>(beginIter, bounds, width, comp) );
+    }
+}
+
+/** Call parallel_sort using engine thread pool. */
+template<typename Iterator, typename Compare>
+void parallel_sort( const Iterator& beginIter,
+                    const Iterator& endIter,
+                    Compare         comp,
+                    size_t          grainSize = default_grain_size )
+{
+    parallel_sort(parallel_thread_pool(), beginIter, endIter, comp, grainSize);
+}
+
+/** Call parallel_sort using engine thread pool and operator <. */
+template<typename Iterator>
+void parallel_sort(const Iterator& beginIter, const Iterator& endIter)
+{
+    parallel_sort( parallel_thread_pool(), beginIter, endIter, std::less<typename std::iterator_traits<Iterator>::value_type>() );
+}
+
+/** Compute axis aligned bounding box of the point cloud concurrently. Point clouds smaller
+ * than grain size are processed by calling thread.
+ * @see compute_aabb
+ * @tparam Iterator - random access iterator type referencing at least
+ * 3-component floating tuple. Tuple must overload operator [], 4-component vectors are bounded by xyz.
+ * @param pool - thread pool performing tasks.
+ */
+template<typename T, typename Iterator>
+math::AABB<T, 3> parallel_compute_aabb( thread::ThreadPool& pool,
+                                        const Iterator&     beginIter,
+                                        const Iterator&     endIter,
+                                        size_t              grainSize = default_grain_size )
+{
+    size_t size = endIter - beginIter;
+    if (size <= grainSize) {
+        return compute_aabb<T>(beginIter, endIter);
+    }
+
+    return parallel_reduce< math::AABB<T, 3> >( pool,
+                                                0,
+                                                size,
+                                                grainSize,
+                                                detail::compute_aabb_task<T, Iterator>(beginIter),
+                                                detail::merge_aabb<T>() );
+}
+
+/** Call parallel_compute_aabb using engine thread pool. */
+template<typename T, typename Iterator>
+math::AABB<T, 3> parallel_compute_aabb( const Iterator& beginIter,
+                                        const Iterator& endIter,
+                                        size_t          grainSize = default_grain_size )
+{
+    return parallel_compute_aabb<T>(parallel_thread_pool(), beginIter, endIter, grainSize);
+}
+
+/** Transform array of vertices by matrix concurrently. Arrays smaller than grain size
+ * are processed by calling thread.
+ * @see transform_by_matrix
+ * @tparam InIterator - random access iterator.
+ * @tparam OutIterator - random access iterator.
+ */
+template< typename InIterator,
+          typename OutIterator,
+          typename RealType,
+          int n,
+          int m>
+void parallel_transform_by_matrix( const InIterator&                     beginIter,
+                                   const InIterator&                     endIter,
+                                   OutIterator                           outIter,
+                                   const math::Matrix<RealType, n, m>&   matrix,
+                                   size_t                                grainSize = default_grain_size )
+{
+    typedef math::Matrix<RealType, n, m> matrix_type;
+
+    size_t size = endIter - beginIter;
+    if (size <= grainSize)
+    {
+        transform_by_matrix(beginIter, endIter, outIter, matrix);
+        return;
+    }
+
+    parallel_for( 0,
+                  size,
+                  grainSize,
+                  detail::transform_by_matrix_task<InIterator, OutIterator, matrix_type>(beginIter, outIter, matrix) );
+}
+
+} // namespace slon
+
+#endif // __SLON_ENGINE_UTILITY_ALGORITHM_PARALLEL_HPP__
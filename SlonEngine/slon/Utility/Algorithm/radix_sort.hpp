@@ -0,0 +1,94 @@
+#ifndef __SLON_ENGINE_UTILITY_ALGORITHM_RADIX_SORT_HPP__
+#define __SLON_ENGINE_UTILITY_ALGORITHM_RADIX_SORT_HPP__
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace slon {
+
+/** Extracts key from the element, default for unsigned integers. */
+template<typename T>
+struct radix_key
+{
+    unsigned long long operator () (const T& value) const { return value; }
+};
+
+/** Stable LSD radix sort by 64 bit unsigned key, byte per pass. Passes where all keys have
+ * same byte are skipped, so sorting keys with few used bits costs few passes.
+ * @param first - range begin.
+ * @param last - range end.
+ * @param buffer - temporary storage, at least last - first elements.
+ * @param key - functor returning unsigned long long key of the element.
+ * @return pointer to the sorted range: first or buffer.
+ */
+template<typename T, typename KeyFunc>
+T* radix_sort(T* first, T* last, T* buffer, KeyFunc key)
+{
+    const size_t num_passes = sizeof(unsigned long long);
+
+    size_t size = last - first;
+    if (size < 2) {
+        return first;
+    }
+
+    // compute histograms of the all passes at once
+    size_t histograms[num_passes][256];
+    std::memset( histograms, 0, sizeof(histograms) );
+    for (T* iter = first; iter != last; ++iter)
+    {
+        unsigned long long k = key(*iter);
+        for (size_t pass = 0; pass < num_passes; ++pass) {
+            ++histograms[pass][(k >> (pass * 8)) & 0xFF];
+        }
+    }
+
+    T* src = first;
+    T* dst = buffer;
+    for (size_t pass = 0; pass < num_passes; ++pass)
+    {
+        size_t* histogram = histograms[pass];
+        if ( histogram[(key(*src) >> (pass * 8)) & 0xFF] == size ) {
+            continue;
+        }
+
+        // histogram -> offsets
+        size_t offset = 0;
+        for (size_t i = 0; i<256; ++i)
+        {
+            size_t count = histogram[i];
+            histogram[i] = offset;
+            offset      += count;
+        }
+
+        for (T* iter = src; iter != src + size; ++iter) {
+            dst[ histogram[(key(*iter) >> (pass * 8)) & 0xFF]++ ] = *iter;
+        }
+
+        std::swap(src, dst);
+    }
+
+    return src;
+}
+
+/** Stable radix sort of the vector by 64 bit unsigned key.
+ * @param values - values to sort.
+ * @param buffer - temporary storage, resized if needed. Keep it between calls to avoid allocations.
+ * @param key - functor returning unsigned long long key of the element.
+ */
+template<typename T, typename Allocator, typename KeyFunc>
+void radix_sort(std::vector<T, Allocator>& values, std::vector<T, Allocator>& buffer, KeyFunc key)
+{
+    if (values.size() < 2) {
+        return;
+    }
+
+    buffer.resize( values.size() );
+    if ( radix_sort(&values[0], &values[0] + values.size(), &buffer[0], key) != &values[0] ) {
+        values.swap(buffer);
+    }
+}
+
+} // namespace slon
+
+#endif // __SLON_ENGINE_UTILITY_ALGORITHM_RADIX_SORT_HPP__
@@ -169,6 +169,20 @@
 #       endif
             ::pthread_mutex_unlock(&_M_mtx_impl);
         }
+        bool try_lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized)
+                return true;
+#       endif
+            if (::pthread_mutex_trylock(&_M_mtx_impl) != 0)
+                return false;
+#       ifdef _DEBUG
+            _FAST_MUTEX_ASSERT(!_M_locked, "try_lock(): already locked");
+            _M_locked = true;
+#       endif
+            return true;
+        }
     private:
         fast_mutex(const fast_mutex&);
         fast_mutex& operator=(const fast_mutex&);
@@ -238,6 +252,20 @@
 #       endif
             ::LeaveCriticalSection(&_M_mtx_impl);
         }
+        bool try_lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized)
+                return true;
+#       endif
+            if (!::TryEnterCriticalSection(&_M_mtx_impl))
+                return false;
+#       ifdef _DEBUG
+            _FAST_MUTEX_ASSERT(!_M_locked, "try_lock(): already locked");
+            _M_locked = true;
+#       endif
+            return true;
+        }
     private:
         fast_mutex(const fast_mutex&);
         fast_mutex& operator=(const fast_mutex&);
@@ -284,6 +312,11 @@
             _M_locked = false;
 #       endif
         }
+        bool try_lock()
+        {
+            lock();
+            return true;
+        }
     private:
         fast_mutex(const fast_mutex&);
         fast_mutex& operator=(const fast_mutex&);
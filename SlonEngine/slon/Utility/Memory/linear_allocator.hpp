@@ -0,0 +1,221 @@
+#ifndef __SLON_ENGINE_UTILITY_MEMORY_LINEAR_ALLOCATOR_HPP__
+#define __SLON_ENGINE_UTILITY_MEMORY_LINEAR_ALLOCATOR_HPP__
+
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+#ifdef new
+#   pragma push_macro("new")
+#   undef new
+#   define _POP_NEW_MACRO
+#endif
+
+#ifdef delete
+#   pragma push_macro("delete")
+#   undef delete
+#   define _POP_DELETE_MACRO
+#endif
+
+namespace slon {
+
+/** Arena allocating memory by bumping pointer in the large blocks. Memory is freed only by reset,
+ * which makes all blocks available again without returning them to the heap. Suitable for
+ * temporary data rebuilt every frame: after warm up frames are performed without heap allocations.
+ * Arena is not thread safe.
+ */
+class linear_arena :
+	public boost::noncopyable
+{
+private:
+	struct block
+	{
+		char*	data;
+		size_t	size;
+	};
+
+	typedef std::vector<block> block_vector;
+
+public:
+	static const size_t alignment = 16;
+
+public:
+	/** Create arena.
+	 * @param blockSize - size of the heap blocks, larger allocations get their own block.
+	 */
+	explicit linear_arena(size_t blockSize = 64 * 1024)
+	:	blockSize_(blockSize)
+	,	currentBlock_(0)
+	,	offset_(0)
+	,	numAllocations_(0)
+	,	numAllocatedBytes_(0)
+	,	numHeapAllocations_(0)
+	{}
+
+	~linear_arena()
+	{
+		for (size_t i = 0; i<blocks_.size(); ++i) {
+			delete[] blocks_[i].data;
+		}
+	}
+
+	/** Allocate aligned memory from the arena. */
+	void* allocate(size_t size)
+	{
+		size = (size + alignment - 1) & ~(alignment - 1);
+		while ( currentBlock_ < blocks_.size() && offset_ + size > blocks_[currentBlock_].size )
+		{
+			++currentBlock_;
+			offset_ = 0;
+		}
+
+		if ( currentBlock_ == blocks_.size() )
+		{
+			block b;
+			b.size = std::max(size, blockSize_);
+			b.data = new char[b.size + alignment];
+			blocks_.push_back(b);
+			++numHeapAllocations_;
+		}
+
+		char* data = blocks_[currentBlock_].data;
+		data    = reinterpret_cast<char*>( (reinterpret_cast<size_t>(data) + alignment - 1) & ~(alignment - 1) );
+		void* p = data + offset_;
+		offset_ += size;
+
+		++numAllocations_;
+		numAllocatedBytes_ += size;
+		return p;
+	}
+
+	/** Make all allocated memory available for allocation. Every object allocated from the arena
+	 * must be released before reset.
+	 */
+	void reset()
+	{
+		currentBlock_ = 0;
+		offset_       = 0;
+	}
+
+	/** Reset allocation counters. */
+	void reset_statistics()
+	{
+		numAllocations_     = 0;
+		numAllocatedBytes_  = 0;
+		numHeapAllocations_ = 0;
+	}
+
+	/** Get number of allocations from the arena since last statistics reset. */
+	size_t num_allocations() const			{ return numAllocations_; }
+
+	/** Get number of bytes allocated from the arena since last statistics reset. */
+	size_t num_allocated_bytes() const		{ return numAllocatedBytes_; }
+
+	/** Get number of heap blocks allocated by the arena since last statistics reset. */
+	size_t num_heap_allocations() const		{ return numHeapAllocations_; }
+
+	/** Get total size of the heap blocks. */
+	size_t capacity() const
+	{
+		size_t capacity = 0;
+		for (size_t i = 0; i<blocks_.size(); ++i) {
+			capacity += blocks_[i].size;
+		}
+		return capacity;
+	}
+
+private:
+	block_vector	blocks_;
+	size_t			blockSize_;
+	size_t			currentBlock_;
+	size_t			offset_;
+
+	// statistics
+	size_t			numAllocations_;
+	size_t			numAllocatedBytes_;
+	size_t			numHeapAllocations_;
+};
+
+/** STL allocator allocating from the linear_arena. Deallocation does nothing, memory is reclaimed
+ * by arena reset. Allocator without arena uses operator new.
+ */
+template<typename T>
+class linear_allocator
+{
+template<typename U>
+friend class linear_allocator;
+public:
+	typedef T				value_type;
+	typedef T*				pointer;
+	typedef T&				reference;
+	typedef const T*		const_pointer;
+	typedef const T&		const_reference;
+	typedef std::size_t		size_type;
+	typedef std::ptrdiff_t	difference_type;
+
+	template<typename U>
+	struct rebind {
+		typedef linear_allocator<U> other;
+	};
+
+public:
+	explicit linear_allocator(linear_arena* arena = 0)
+	:	arena_(arena)
+	{}
+
+	template<typename U>
+	linear_allocator(const linear_allocator<U>& other)
+	:	arena_(other.arena_)
+	{}
+
+	pointer allocate(size_type n, const void* /*hint*/ = 0)
+	{
+		if (arena_) {
+			return static_cast<pointer>( arena_->allocate(n * sizeof(T)) );
+		}
+
+		return static_cast<pointer>( ::operator new(n * sizeof(T)) );
+	}
+
+	void deallocate(pointer p, size_type /*n*/)
+	{
+		if (!arena_) {
+			::operator delete(p);
+		}
+	}
+
+	void construct(pointer p, const T& value)	{ new(p) T(value); }
+	void destroy(pointer p)						{ p->~T(); }
+
+	pointer			address(reference x) const			{ return &x; }
+	const_pointer	address(const_reference x) const	{ return &x; }
+	size_type		max_size() const					{ return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+	/** Get arena of the allocator. */
+	linear_arena* arena() const { return arena_; }
+
+	template<typename U>
+	bool operator == (const linear_allocator<U>& other) const { return arena_ == other.arena_; }
+
+	template<typename U>
+	bool operator != (const linear_allocator<U>& other) const { return arena_ != other.arena_; }
+
+private:
+	linear_arena* arena_;
+};
+
+} // namespace slon
+
+#ifdef _POP_NEW_MACRO
+#   pragma pop_macro("new")
+#   undef _POP_NEW_MACRO
+#endif
+#ifdef _POP_DELETE_MACRO
+#   pragma pop_macro("delete")
+#   undef _POP_DELETE_MACRO
+#endif
+
+#endif // __SLON_ENGINE_UTILITY_MEMORY_LINEAR_ALLOCATOR_HPP__
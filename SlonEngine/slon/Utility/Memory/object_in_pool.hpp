@@ -2,8 +2,10 @@
 #define __SLON_ENGINE_OBJECT_IN_POOL_H__
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/once.hpp>
 #include "../../Config.h"
 #include "object_pool.hpp"
+#include "thread_cache.hpp"
 
 #ifdef new
 #   pragma push_macro("new")
@@ -19,17 +21,22 @@
 
 namespace slon {
 
+/** Pool of blocks of the specified size shared by all objects of the same size. Pool is
+ * thread safe, every thread allocates from its own cache.
+ * Pool is destroyed after removal guard (at exit) when all blocks are returned back, so threads using
+ * the pool must be joined before exit.
+ */
 template<size_t Size, typename UserAllocator>
 class singleton_pool :
-    public block_allocator<UserAllocator>
+    public thread_cached_block_allocator<UserAllocator>
 {
 public:
     static const size_t element_size = Size;
 
-	typedef block_allocator<UserAllocator>	                block_allocator_type;
+	typedef thread_cached_block_allocator<UserAllocator>	base_type;
 	typedef UserAllocator									user_allocator;
-	typedef typename block_allocator_type::size_type		size_type;
-	typedef typename block_allocator_type::difference_type	difference_type;
+	typedef typename base_type::size_type					size_type;
+	typedef typename base_type::difference_type				difference_type;
 
 private:
     class removal_guard
@@ -38,75 +45,72 @@ private:
         removal_guard(singleton_pool* pool_)
         :   pool(pool_)
         {
-            pool->add_ref();
         }
 
         ~removal_guard()
         {
-            pool->remove_ref();
+            pool->orphan();
         }
 
     private:
         singleton_pool* pool;
     };
 
-public:
-	singleton_pool( size_type capacity = 8,
-				    size_type nextSize = 16 )
-    :   block_allocator_type(element_size, capacity, nextSize)
-    ,   refCount(0)
-    {
-    }
-
-    ~singleton_pool()
+    static void create_instance()
     {
-        assert(refCount == 0);
+        inst = new singleton_pool();
+        guard.reset(new removal_guard(inst));
     }
 
-    void add_ref()
+    void orphan()
     {
-        ++refCount;
-    }
-
-    void remove_ref()
-    {
-        if (--refCount == 0) {
+        orphaned = true;
+        if ( base_type::flush() ) {
             delete this;
         }
     }
 
-    void* allocate() 
+public:
+	singleton_pool( size_type capacity = 8,
+				    size_type nextSize = 16 )
+    :   base_type(element_size, capacity, nextSize)
+    ,   orphaned(false)
     {
-        add_ref();
-        return block_allocator_type::allocate();
     }
 
     void deallocate(void* ptr)
     {
-        block_allocator_type::deallocate(ptr);
-        remove_ref();
+        // thread caches are not used after exit, blocks go straight to the central free list
+        if (orphaned)
+        {
+            if ( base_type::deallocate_central(ptr) ) {
+                delete this;
+            }
+        }
+        else {
+            base_type::deallocate(ptr);
+        }
     }
 
     static singleton_pool* instance() 
     {
-        if (!inst) 
-        {
-            inst = new singleton_pool();
-            guard.reset(new removal_guard(inst));
-        }
-
+        boost::call_once(create_instance, instanceFlag);
         return inst;
     }
 
 private:
-    size_type                               refCount;
+    volatile bool                           orphaned;
     static singleton_pool*                  inst;
+    static boost::once_flag                 instanceFlag;
     static boost::shared_ptr<removal_guard> guard; // guards pool from frequent allocation/deallocation
 };
 
 template<size_t Size, typename UserAllocator>
 singleton_pool<Size, UserAllocator>* singleton_pool<Size, UserAllocator>::inst = 0;
 
+template<size_t Size, typename UserAllocator>
+boost::once_flag singleton_pool<Size, UserAllocator>::instanceFlag = BOOST_ONCE_INIT;
+
 template<size_t Size, typename UserAllocator>
 boost::shared_ptr<typename singleton_pool<Size, UserAllocator>::removal_guard> singleton_pool<Size, UserAllocator>::guard;
 
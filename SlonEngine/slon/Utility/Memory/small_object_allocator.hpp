@@ -3,7 +3,7 @@
 #include <boost/shared_array.hpp>
 #include <limits>
 #include <memory>
-#include "block_allocator.h"
+#include "thread_cache.hpp"
 
 // some libraries may define their own new/delete
 #ifdef new
@@ -39,6 +39,7 @@ struct small_object_allocator_traits
  * http://goog-perftools.sourceforge.net/doc/tcmalloc.html.
  * Also may also find usefull resources on Intel TBB: 
  * http://download.intel.com/technology/itj/2007/v11i4/5-foundations/5-Foundations_for_Scalable_Multi-core_Software.pdf
+ * Each allocator class keeps per thread caches, so allocator can be shared between threads.
  * WARNING: This allocator has state - pointers to the block allocators, they are copied in copy constructor.
  * NOTICE: Can be optimized by removing indirect usage of block allocators. But need to be extra carefull, because
  * standart rely on assumption that allocators don't have state.
@@ -101,7 +102,7 @@ private:
 	}
 
 private:
-	typedef block_allocator<user_allocator>				block_allocator_type;
+	typedef thread_cached_block_allocator<user_allocator>	block_allocator_type;
 	typedef boost::shared_array<block_allocator_type>	block_allocator_array;
 
 	struct allocator_deallocator
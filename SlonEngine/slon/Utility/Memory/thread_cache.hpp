@@ -0,0 +1,232 @@
+#ifndef __SLON_ENGINE_UTILITY_MEMORY_THREAD_CACHE_HPP__
+#define __SLON_ENGINE_UTILITY_MEMORY_THREAD_CACHE_HPP__
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/tss.hpp>
+#include "block_allocator.hpp"
+
+#ifdef new
+#   pragma push_macro("new")
+#   undef new
+#   define _POP_NEW_MACRO
+#endif
+
+#ifdef delete
+#   pragma push_macro("delete")
+#   undef delete
+#   define _POP_DELETE_MACRO
+#endif
+
+namespace slon {
+
+/** Allocates identical blocks of memory of specified size. Every thread allocates from its own
+ * free list without locking, following google TCMalloc thread caches:
+ * http://goog-perftools.sourceforge.net/doc/tcmalloc.html.
+ * When thread cache is empty, batch of blocks is moved from the central free list under lock.
+ * When thread cache grows longer than two batches, batch is moved back. Blocks can be deallocated
+ * in any thread. Thread cache is returned to the central free list when thread exits.
+ * WARNING: Thread caches point to the allocator, so it must outlive every thread that used it, except
+ * the thread destroying the allocator. Blocks cached by the exited threads are not considered as used.
+ * @tparam UserAllocator - allocator for allocating chunks of the central free list.
+ */
+template<typename UserAllocator = boost::default_user_allocator_new_delete>
+class thread_cached_block_allocator :
+	public boost::noncopyable
+{
+public:
+	typedef block_allocator<UserAllocator>						central_allocator_type;
+    typedef UserAllocator										user_allocator;
+    typedef void*												pointer;
+    typedef const void*											const_pointer;
+    typedef typename central_allocator_type::size_type			size_type;
+    typedef typename central_allocator_type::difference_type	difference_type;
+
+private:
+	struct thread_cache
+	{
+		thread_cached_block_allocator*	owner;
+		pointer							head;
+		size_type						length;
+	};
+
+	static pointer& next_of(pointer ptr)
+	{
+		return *static_cast<pointer*>(ptr);
+	}
+
+	// called by boost when thread exits, must not touch thread specific storage
+	static void release_cache(thread_cache* cache)
+	{
+		cache->owner->release_batch(cache, cache->length);
+		delete cache;
+	}
+
+	thread_cache* get_cache()
+	{
+		thread_cache* cache = cache_.get();
+		if (!cache)
+		{
+			cache         = new thread_cache;
+			cache->owner  = this;
+			cache->head   = 0;
+			cache->length = 0;
+			cache_.reset(cache);
+		}
+
+		return cache;
+	}
+
+	void fetch_batch(thread_cache* cache)
+	{
+		boost::lock_guard<boost::mutex> lock(centralMutex_);
+		for (size_type i = 0; i < batchSize_; ++i)
+		{
+			pointer node  = central_.allocate();
+			next_of(node) = cache->head;
+			cache->head   = node;
+		}
+		cache->length   += batchSize_;
+		numOutstanding_ += batchSize_;
+#ifdef SMALL_OBJECT_ALLOCATOR_STATISTICS
+		++numBatchFetches_;
+#endif
+	}
+
+	bool release_batch(thread_cache* cache, size_type count)
+	{
+		assert(count <= cache->length);
+
+		boost::lock_guard<boost::mutex> lock(centralMutex_);
+		for (size_type i = 0; i < count; ++i)
+		{
+			pointer node = cache->head;
+			cache->head  = next_of(node);
+			central_.deallocate(node);
+		}
+		cache->length   -= count;
+		numOutstanding_ -= count;
+#ifdef SMALL_OBJECT_ALLOCATOR_STATISTICS
+		++numBatchReleases_;
+#endif
+		return numOutstanding_ == 0;
+	}
+
+protected:
+	/** Return block directly into the central free list, bypassing thread cache.
+	 * @return true if all blocks are returned to the central free list.
+	 */
+	bool deallocate_central(pointer node)
+	{
+		boost::lock_guard<boost::mutex> lock(centralMutex_);
+		central_.deallocate(node);
+		return --numOutstanding_ == 0;
+	}
+
+public:
+    thread_cached_block_allocator( size_type blockSize,
+								   size_type capacity = 0,
+								   size_type nextSize = 32,
+								   size_type batchSize = 32 )
+	:	central_(blockSize, capacity, nextSize)
+	,	cache_(release_cache)
+	,	batchSize_(batchSize)
+	,	numOutstanding_(0)
+#ifdef SMALL_OBJECT_ALLOCATOR_STATISTICS
+	,	numBatchFetches_(0)
+	,	numBatchReleases_(0)
+#endif
+    {
+		assert(batchSize_ > 0);
+    }
+
+	virtual ~thread_cached_block_allocator()
+	{
+		// cache of the current thread is freed with the central free list
+		delete cache_.release();
+	}
+
+	pointer allocate()
+	{
+		thread_cache* cache = get_cache();
+		if (!cache->head) {
+			fetch_batch(cache);
+		}
+
+		pointer allocated = cache->head;
+		cache->head = next_of(allocated);
+		--cache->length;
+		return allocated;
+	}
+
+    void deallocate(pointer node)
+    {
+		thread_cache* cache = get_cache();
+		next_of(node) = cache->head;
+		cache->head   = node;
+		if (++cache->length > 2 * batchSize_) {
+			release_batch(cache, batchSize_);
+		}
+    }
+
+	/** Return blocks cached by the current thread into the central free list.
+	 * @return true if all blocks are returned to the central free list.
+	 */
+	bool flush()
+	{
+		thread_cache* cache = cache_.get();
+		if (cache) {
+			return release_batch(cache, cache->length);
+		}
+
+		boost::lock_guard<boost::mutex> lock(centralMutex_);
+		return numOutstanding_ == 0;
+	}
+
+	size_type	block_size() const		{ return central_.block_size(); }
+    size_type	next_size() const		{ return central_.next_size(); }
+    size_type	capacity() const		{ return central_.capacity(); }
+    size_type	batch_size() const		{ return batchSize_; }
+
+	/** Get number of blocks taken from the central free list: used blocks and blocks in thread caches. */
+	size_type num_outstanding() const
+	{
+		boost::lock_guard<boost::mutex> lock(centralMutex_);
+		return numOutstanding_;
+	}
+
+#ifdef SMALL_OBJECT_ALLOCATOR_STATISTICS
+	size_type	num_batch_fetches() const			{ return numBatchFetches_; }
+	size_type	num_batch_releases() const			{ return numBatchReleases_; }
+	size_type	num_allocations() const				{ return central_.num_allocations(); }
+	size_type	num_deallocations() const			{ return central_.num_deallocations(); }
+	size_type	max_num_active_allocations() const	{ return central_.max_num_active_allocations(); }
+#endif
+
+	// allocators are always different
+	bool operator == (const thread_cached_block_allocator& other) const { return this == &other; }
+	bool operator != (const thread_cached_block_allocator& other) const { return this != &other; }
+
+private:
+	central_allocator_type					central_;
+	mutable boost::mutex					centralMutex_;
+	boost::thread_specific_ptr<thread_cache>	cache_;
+	size_type								batchSize_;
+	size_type								numOutstanding_;
+#ifdef SMALL_OBJECT_ALLOCATOR_STATISTICS
+	size_type								numBatchFetches_;
+	size_type								numBatchReleases_;
+#endif
+};
+
+} // namespace slon
+
+#ifdef _POP_NEW_MACRO
+#   pragma pop_macro("new")
+#endif
+#ifdef _POP_DELETE_MACRO
+#   pragma pop_macro("delete")
+#endif
+
+#endif // __SLON_ENGINE_UTILITY_MEMORY_THREAD_CACHE_HPP__
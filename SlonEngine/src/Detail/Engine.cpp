@@ -5,6 +5,7 @@
 #include "Detail/Engine.h"
 #include "FileSystem/File.h"
 #include "Graphics/Common.h"
+#include "Graphics/ForwardRenderer.h"
 #include "Graphics/LightingEffect.h"
 #include "Graphics/StaticMesh.h"
 #include "Graphics/StaticMesh.h"
@@ -16,7 +17,10 @@
 #include "Realm/BVHLocation.h"
 #include "Realm/DefaultWorld.h"
 #include "Scene/Camera.h"
+#include "Scene/LODGroup.h"
 #include "Scene/TransformVisitor.h"
+#include "Thread/LockStatistics.h"
+#include "Thread/Utility.h"
 #include "Utility/error.hpp"
 #include <boost/filesystem.hpp>
 #include <SDL.h>
@@ -202,6 +206,7 @@ Engine::Engine() :
         // scene
 		databaseManager.registerSerializableCreateFunc("Node",                  createSerializable<scene::Node>);
 		databaseManager.registerSerializableCreateFunc("Group",                 createSerializable<scene::Group>);
+		databaseManager.registerSerializableCreateFunc("LODGroup",              createSerializable<scene::LODGroup>);
 		databaseManager.registerSerializableCreateFunc("MatrixTransform",       createSerializable<scene::MatrixTransform>);
 		databaseManager.registerSerializableCreateFunc("PhysicsTransform",      createSerializable<physics::PhysicsTransform>);
 		databaseManager.registerSerializableCreateFunc("StaticMesh",            createSerializable<graphics::StaticMesh>);
@@ -248,13 +253,26 @@ Engine::Engine() :
 
     // setup timer for PhysicsManager
     simulationTimer.reset(new StartStopTimer);
+    frameTimer.reset(new ManualTimer);
+    activeTimer = simulationTimer;
 #ifdef SLON_ENGINE_USE_PHYSICS
-    physicsManager.setTimer( simulationTimer.get() );
+    physicsManager.setTimer( activeTimer.get() );
 #endif
 }
 
 void Engine::handleInput()
 {
+    if ( inputManager.isRecording() || inputManager.isReplaying() )
+    {
+        double time = simulationTimer->getTime();
+        if ( !inputManager.nextRecordFrame(time) ) 
+        {
+            working = false;
+            return;
+        }
+        frameTimer->setTime(time);
+    }
+
     inputManager.handleEvents();
 }
 
@@ -265,10 +283,24 @@ void Engine::handlePhysics()
 
 void Engine::handlePhysicsCycle()
 {
+    // step physics with fixed rate, sleep the rest of the step
+    const double timeStep = desc.physicsTimeStep;
+    double       nextTime = simulationTimer->getTime() + timeStep;
     while (working)
     {
-        thread::lock_ptr lock = physicsManager.lockForReading();
-        handlePhysics();
+        {
+            thread::lock_ptr lock = physicsManager.lockForWriting();
+            physicsManager.stepSimulation( (physics::real)timeStep );
+        }
+
+        double time = simulationTimer->getTime();
+        if (time < nextTime) {
+            thread::sleep( std::min(nextTime - time, 1.0) );
+        }
+        else if (time - nextTime > timeStep * desc.maxPhysicsLag) {
+            nextTime = time; // physics can't keep up, drop time instead of spiraling
+        }
+        nextTime += timeStep;
     }
 }
 
@@ -280,12 +312,10 @@ void Engine::handleGraphics()
 
 void Engine::handleScene()
 {
-	thread::lock_ptr lock = world->lockForWriting();
-    {
-        boost::lock_guard<boost::mutex> lock(updateQueueMutex);
-        updateQueueTemp.swap(updateQueue);
-    }
-   
+    // nodes lock their locations for update, keep only location list from changing
+	thread::lock_ptr lock = world->lockForReading();
+    updateQueue.pop_all( std::back_inserter(updateQueueTemp) );
+
     for (size_t i = 0; i<updateQueueTemp.size(); ++i)
     {
         if (updateQueueTemp[i]->updatedFrameNo < frameNumber)
@@ -299,8 +329,7 @@ void Engine::handleScene()
 
 void Engine::addToUpdateQueue(scene::Node* node)
 {
-    boost::lock_guard<boost::mutex> lock(updateQueueMutex);
-    updateQueue.push_back(node);
+    updateQueue.push(node);
 }
 
 void Engine::run(const DESC& desc_)
@@ -315,7 +344,29 @@ void Engine::run(const DESC& desc_)
         SDL_WM_GrabInput(SDL_GRAB_ON);
     }
 
+    // record or replay with time fixed during the frame, physics is stepped in the main thread
+    if ( !desc.replayFile.empty() ) {
+        inputManager.beginReplay(desc.replayFile);
+    }
+    else if ( !desc.recordFile.empty() ) {
+        inputManager.beginRecord(desc.recordFile);
+    }
+
+    if ( inputManager.isRecording() || inputManager.isReplaying() )
+    {
+        desc.multithreaded = false;
+        frameTimer->setTime(0.0);
+        activeTimer = frameTimer;
+    }
+    else {
+        activeTimer = simulationTimer;
+    }
+#ifdef SLON_ENGINE_USE_PHYSICS
+    physicsManager.setTimer( activeTimer.get() );
+#endif
+
     // run simulation thread
+    simulationTimer->start();
 #ifdef SLON_ENGINE_USE_PHYSICS
     if (desc.multithreaded) {
         threadManager.startThread(thread::SIMULATION_THREAD, boost::bind(&Engine::handlePhysicsCycle, this));
@@ -323,7 +374,6 @@ void Engine::run(const DESC& desc_)
 #endif
 
     // run main rendering cycle
-    simulationTimer->start();
     while (working) {
         frame();
     }
@@ -334,6 +384,12 @@ void Engine::run(const DESC& desc_)
     if (desc.grabInput) {
         SDL_WM_GrabInput(SDL_GRAB_OFF);
     }
+    inputManager.endRecord();
+
+    // keep programs requested during the session for the warm up on the next start
+    if ( graphics::detail::ForwardRenderer* renderer = dynamic_cast<graphics::detail::ForwardRenderer*>(graphicsManager.getRenderer()) ) {
+        renderer->saveShaderManifest();
+    }
 
     // wake input thread
     SDL_Event dummy;    
@@ -361,6 +417,14 @@ void Engine::frame()
 
 Engine::~Engine()
 {
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+    {
+        std::ostringstream ss;
+        thread::dump_lock_statistics(ss);
+        AUTO_LOGGER_MESSAGE(log::S_NOTICE, "Lock statistics:\n" << ss.str());
+    }
+#endif
+
     SDL_Quit();
 	sglSetErrorHandler(0);
 	delete logErrorHandler;
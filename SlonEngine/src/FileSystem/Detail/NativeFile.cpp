@@ -88,6 +88,18 @@ std::streamsize NativeFile::size() const
     return boost::fs::file_size(systemPath);
 }
 
+std::time_t NativeFile::lastWriteTime() const
+{
+    try
+    {
+        return boost::fs::last_write_time(systemPath);
+    }
+    catch (boost::fs::filesystem_error&)
+    {
+        return 0;
+    }
+}
+
 std::streampos NativeFile::seek(std::streamoff off, std::ios_base::seekdir way)
 {
 	if (file) 
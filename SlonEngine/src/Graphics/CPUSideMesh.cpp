@@ -4,6 +4,7 @@
 #include "Graphics/CPUSideMesh.h"
 #include "Graphics/GPUSideMesh.h"
 #include "Log/Logger.h"
+#include "Utility/Algorithm/parallel.hpp"
 #include "Utility/math.hpp"
 
 DECLARE_AUTO_LOGGER("graphics.CPUSideMesh")
@@ -243,14 +244,14 @@ gpu_side_mesh_ptr CPUSideMesh::createGPUSideMesh() const
     {
         if ( const math::Vector3f* vertices = queryAttributeData<math::Vector3f>(0) )
         {
-            for (size_t i = 0; i<attributeArrays[0].count; ++i) {
-                desc.aabb.extend(vertices[i]);
+            if (attributeArrays[0].count > 0) {
+                desc.aabb = parallel_compute_aabb<float>(vertices, vertices + attributeArrays[0].count);
             }
         }
         else if ( const math::Vector4f* vertices = queryAttributeData<math::Vector4f>(0) )
         {
-            for (size_t i = 0; i<attributeArrays[0].count; ++i) {
-                desc.aabb.extend( math::xyz(vertices[i]) );
+            if (attributeArrays[0].count > 0) {
+                desc.aabb = parallel_compute_aabb<float>(vertices, vertices + attributeArrays[0].count);
             }
         }
     }
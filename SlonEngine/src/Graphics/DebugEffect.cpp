@@ -61,6 +61,7 @@ DebugEffect::DebugEffect(const DESC& desc_)
         }
 
         case Renderer::FORWARD_RENDERING:
+        case Renderer::DEFERRED_SHADING:
         {
             using detail::ForwardRenderer;
 
@@ -134,6 +135,7 @@ DebugEffect::DebugEffect(const DebugEffect& effect)
         }
 
         case Renderer::FORWARD_RENDERING:
+        case Renderer::DEFERRED_SHADING:
         {
             detail::Pass::DESC pdesc;
 			detail::Pass&      dpass = static_cast<detail::Pass&>(*effect.pass);
@@ -192,6 +194,7 @@ void DebugEffect::reset(const DESC& desc_)
         }
 
         case Renderer::FORWARD_RENDERING:
+        case Renderer::DEFERRED_SHADING:
         {
 			detail::Pass& dPass = static_cast<detail::Pass&>(*pass);
 			
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Graphics/DebugTextEffect.h"
 #include "Graphics/ForwardRenderer.h"
+#include "Graphics/Detail/StateTable.h"
 #include "Graphics/FixedPipelineRenderer.h"
 #include "Log/Logger.h"
 
@@ -38,6 +39,7 @@ namespace {
         void end() const
         {
             debugEffect->getFont()->Unbind();
+            detail::currentStateTable().invalidateTextures();
         }
 
     private:
@@ -0,0 +1,553 @@
+#include "stdafx.h"
+#define _DEBUG_NEW_REDEFINE_NEW 0 // disable debug new due to conflict with sgl::Aligned allocator
+#include "Graphics/Common.h"
+#include "Graphics/DeferredRenderer.h"
+#include "Graphics/Detail/AttributeTable.h"
+#include "Graphics/Detail/ParameterTable.h"
+#include "Graphics/Detail/StateTable.h"
+#include "Log/Logger.h"
+#include "Scene/PointLight.h"
+#include "Scene/ReflectCamera.h"
+#include "Utility/error.hpp"
+#include <algorithm>
+
+DECLARE_AUTO_LOGGER("graphics.DeferredRenderer")
+
+namespace {
+
+    using namespace slon;
+    using namespace slon::graphics;
+
+    const unsigned sphere_rings    = 8;
+    const unsigned sphere_segments = 12;
+
+    ForwardRendererDesc make_forward_desc(const DeferredRendererDesc& desc)
+    {
+        ForwardRendererDesc forwardDesc;
+        forwardDesc.bitsPerPixel        = desc.bitsPerPixel;
+        forwardDesc.depthBits           = desc.depthBits;
+        forwardDesc.useDebugRender      = desc.useDebugRender;
+        forwardDesc.useOcclusionCulling = desc.useOcclusionCulling;
+        forwardDesc.useMultiViewCulling = desc.useMultiViewCulling;
+        forwardDesc.minScreenArea       = desc.minScreenArea;
+        return forwardDesc;
+    }
+
+    math::Vector3f sphere_point(unsigned ring, unsigned segment)
+    {
+        float phi   = 3.1415926f * ring / sphere_rings;
+        float theta = 2.0f * 3.1415926f * segment / sphere_segments;
+        return math::Vector3f( sin(phi) * cos(theta), cos(phi), -sin(phi) * sin(theta) );
+    }
+
+    // triangle list of the sphere with faces outside of the unit sphere, counter clockwise from outside
+    void make_sphere(math::vector_of_vector3f& vertices)
+    {
+        float scale = 1.0f / ( cos(3.1415926f / sphere_segments) * cos(3.1415926f / (2 * sphere_rings)) );
+        for (unsigned i = 0; i<sphere_rings; ++i)
+        {
+            for (unsigned j = 0; j<sphere_segments; ++j)
+            {
+                math::Vector3f a = sphere_point(i, j) * scale;
+                math::Vector3f b = sphere_point(i + 1, j) * scale;
+                math::Vector3f c = sphere_point(i + 1, j + 1) * scale;
+                math::Vector3f d = sphere_point(i, j + 1) * scale;
+                if (i > 0)
+                {
+                    vertices.push_back(a);
+                    vertices.push_back(b);
+                    vertices.push_back(d);
+                }
+                if (i + 1 < sphere_rings)
+                {
+                    vertices.push_back(d);
+                    vertices.push_back(b);
+                    vertices.push_back(c);
+                }
+            }
+        }
+    }
+
+    sgl::Texture2D* create_gbuffer_texture(sgl::Texture::FORMAT format, unsigned width, unsigned height, sgl::SamplerState* samplerState)
+    {
+        sgl::Texture2D::DESC desc;
+        desc.format = format;
+        desc.width  = width;
+        desc.height = height;
+        desc.data   = 0;
+
+        sgl::Texture2D* texture = currentDevice()->CreateTexture2D(desc);
+        if (!texture) {
+            throw gl_error(AUTO_LOGGER, "Can't create g-buffer texture.");
+        }
+        texture->BindSamplerState(samplerState);
+
+        return texture;
+    }
+
+} // anonymous namespace
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+DeferredRenderer::DeferredRenderer(const DeferredRendererDesc& desc_) :
+    ForwardRenderer( make_forward_desc(desc_) ),
+    deferredDesc(desc_),
+    numSphereVertices(0),
+    spotRejectLogged(false)
+{
+    initDeferred();
+}
+
+void DeferredRenderer::initDeferred()
+{
+    sgl::Device* device = currentDevice();
+
+    // add binders
+    {
+        detail::ParameterTable& parameterTable = detail::currentParameterTable();
+        diffuseSpecularMapBinder = parameterTable.addParameterBinding<sgl::Texture2D>( hash_string("gbufferDiffuseSpecularMap"), 0, 1, false);
+        normalShininessMapBinder = parameterTable.addParameterBinding<sgl::Texture2D>( hash_string("gbufferNormalShininessMap"), 0, 1, false);
+        gbufferDepthMapBinder    = parameterTable.addParameterBinding<sgl::Texture2D>( hash_string("gbufferDepthMap"), 0, 1, false);
+        gbufferScaleBiasBinder   = parameterTable.addParameterBinding( hash_string("gbufferScaleBias"), &gbufferScaleBias, 1, false);
+        lightVolumeMatrixBinder  = parameterTable.addParameterBinding( hash_string("lightVolumeMatrix"), &lightVolumeMatrix, 1, false);
+    }
+
+    // headless renderer only records the g-buffer pass
+    if (headless) {
+        return;
+    }
+
+    // g-buffer is sampled per pixel
+    {
+        sgl::SamplerState::DESC desc;
+        desc.filter[0]   = sgl::SamplerState::NEAREST;
+        desc.filter[1]   = sgl::SamplerState::NEAREST;
+        desc.filter[2]   = sgl::SamplerState::NONE;
+
+        desc.wrapping[0] = sgl::SamplerState::CLAMP;
+        desc.wrapping[1] = sgl::SamplerState::CLAMP;
+        samplerState.reset( device->CreateSamplerState(desc) );
+    }
+
+    // screen quad and light volume geometry
+    {
+        math::vector_of_vector3f vertices;
+        vertices.push_back( math::Vector3f(-1.0f, -1.0f, 0.0f) );
+        vertices.push_back( math::Vector3f( 1.0f, -1.0f, 0.0f) );
+        vertices.push_back( math::Vector3f( 1.0f,  1.0f, 0.0f) );
+        vertices.push_back( math::Vector3f(-1.0f, -1.0f, 0.0f) );
+        vertices.push_back( math::Vector3f( 1.0f,  1.0f, 0.0f) );
+        vertices.push_back( math::Vector3f(-1.0f,  1.0f, 0.0f) );
+        make_sphere(vertices);
+        numSphereVertices = vertices.size() - 6;
+
+        sgl::VertexLayout::ELEMENT elements[] =
+        {
+            {detail::currentAttributeTable().queryAttribute( hash_string("position") )->index, 3, 0, 12, sgl::FLOAT, sgl::VertexLayout::ATTRIBUTE}
+        };
+        volumeLayout.reset( device->CreateVertexLayout(1, elements) );
+
+        volumeBuffer.reset( device->CreateVertexBuffer() );
+        volumeBuffer->SetData( vertices.size() * sizeof(math::Vector3f), &vertices[0] );
+    }
+
+    // lighting passes
+    {
+        detail::Pass::DESC         desc;
+        detail::Pass::UNIFORM_DESC uniformDesc[8];
+        {
+            uniformDesc[0].uniformName   = "gbufferDiffuseSpecularMap";
+            uniformDesc[0].parameterName = "gbufferDiffuseSpecularMap";
+            uniformDesc[1].uniformName   = "gbufferNormalShininessMap";
+            uniformDesc[1].parameterName = "gbufferNormalShininessMap";
+            uniformDesc[2].uniformName   = "gbufferDepthMap";
+            uniformDesc[2].parameterName = "gbufferDepthMap";
+            uniformDesc[3].uniformName   = "gbufferScaleBias";
+            uniformDesc[3].parameterName = "gbufferScaleBias";
+            uniformDesc[4].uniformName   = "lightVolumeMatrix";
+            uniformDesc[4].parameterName = "lightVolumeMatrix";
+            uniformDesc[5].uniformName   = "invProjectionMatrix";
+            uniformDesc[5].parameterName = "invProjectionMatrix";
+            uniformDesc[6].uniformName   = "lightColorIntensity";
+            uniformDesc[6].parameterName = "lightColorIntensity";
+            uniformDesc[7].uniformName   = "lightDirectionAmbient";
+            uniformDesc[7].parameterName = "lightViewDirectionAmbient";
+
+            desc.uniforms    = uniformDesc;
+            desc.numUniforms = 8;
+        }
+
+        EffectShaderProgram baseProgram(AUTO_LOGGER);
+        baseProgram.addShader("Data/Shaders/Deferred/light.vert");
+        baseProgram.addShader("Data/Shaders/Deferred/lighting.frag");
+
+        // restore depth of the g-buffer in the render target, clear color
+        {
+            EffectShaderProgram program(baseProgram);
+            program.addDefinition("#define RESOLVE");
+            desc.program = program.getProgram();
+
+            sgl::BlendState::DESC blendDesc;
+            blendDesc.blendEnable = false;
+            desc.blendState = detail::currentStateTable().createBlendState(blendDesc);
+
+            sgl::DepthStencilState::DESC dsDesc;
+            dsDesc.depthEnable    = true;
+            dsDesc.depthFunc      = sgl::DepthStencilState::ALWAYS;
+            dsDesc.depthWriteMask = true;
+            dsDesc.stencilEnable  = false;
+            desc.depthStencilState = detail::currentStateTable().createDepthStencilState(dsDesc);
+
+            sgl::RasterizerState::DESC rastDesc;
+            rastDesc.cullMode  = sgl::RasterizerState::NONE;
+            rastDesc.fillMode  = sgl::RasterizerState::SOLID;
+            rastDesc.colorMask = sgl::RasterizerState::RGBA;
+            desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
+
+            resolvePass.reset( new detail::Pass(desc) );
+        }
+
+        // lights are accumulated
+        sgl::BlendState::DESC blendDesc;
+        {
+            blendDesc.blendEnable    = true;
+            blendDesc.blendOp        = sgl::BlendState::ADD;
+            blendDesc.blendOpAlpha   = sgl::BlendState::ADD;
+            blendDesc.srcBlend       = sgl::BlendState::ONE;
+            blendDesc.srcBlendAlpha  = sgl::BlendState::ONE;
+            blendDesc.destBlend      = sgl::BlendState::ONE;
+            blendDesc.destBlendAlpha = sgl::BlendState::ONE;
+        }
+        desc.blendState = detail::currentStateTable().createBlendState(blendDesc);
+
+        // directional lights cover whole screen
+        {
+            sgl::DepthStencilState::DESC dsDesc;
+            dsDesc.depthEnable    = false;
+            dsDesc.depthWriteMask = false;
+            dsDesc.stencilEnable  = false;
+            desc.depthStencilState = detail::currentStateTable().createDepthStencilState(dsDesc);
+
+            for (int i = LightingEffect::MIN_NUM_LIGHTS; i <= LightingEffect::MAX_NUM_LIGHTS; ++i)
+            {
+                EffectShaderProgram program(baseProgram);
+                program.addDefinition("#define DIRECTIONAL_LIGHTING");
+                program.addDefinition("#define NUM_LIGHTS %d", i);
+                desc.program = program.getProgram();
+                directionalPasses[i].reset( new detail::Pass(desc) );
+            }
+        }
+
+        // back faces of the point light volume pass where scene is in front of them,
+        // so volume shades pixels even if camera is inside
+        {
+            uniformDesc[7].uniformName   = "lightPositionRadius";
+            uniformDesc[7].parameterName = "lightViewPositionRadius";
+
+            EffectShaderProgram program(baseProgram);
+            program.addDefinition("#define POINT_LIGHTING");
+            program.addDefinition("#define NUM_LIGHTS %d", 1);
+            desc.program = program.getProgram();
+
+            sgl::DepthStencilState::DESC dsDesc;
+            dsDesc.depthEnable    = true;
+            dsDesc.depthFunc      = sgl::DepthStencilState::GEQUAL;
+            dsDesc.depthWriteMask = false;
+            dsDesc.stencilEnable  = false;
+            desc.depthStencilState = detail::currentStateTable().createDepthStencilState(dsDesc);
+
+            sgl::RasterizerState::DESC rastDesc;
+            rastDesc.cullMode  = sgl::RasterizerState::FRONT;
+            rastDesc.fillMode  = sgl::RasterizerState::SOLID;
+            rastDesc.colorMask = sgl::RasterizerState::RGBA;
+            desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
+
+            pointPass.reset( new detail::Pass(desc) );
+        }
+    }
+}
+
+void DeferredRenderer::update_gbuffer(const sgl::rectangle& viewport) const
+{
+    unsigned width  = viewport.width;
+    unsigned height = viewport.height;
+    if (gbufferTarget)
+    {
+        if ( diffuseSpecularMap->Width() >= width && diffuseSpecularMap->Height() >= height ) {
+            return;
+        }
+
+        // grow only, so cameras with different viewports don't recreate it every frame
+        width  = std::max(width, diffuseSpecularMap->Width());
+        height = std::max(height, diffuseSpecularMap->Height());
+    }
+
+    // viewport is rendered into the corner of the g-buffer, texels map to the render target pixels one to one
+    diffuseSpecularMap.reset( create_gbuffer_texture(sgl::Texture::RGBA8, width, height, samplerState.get()) );
+    normalShininessMap.reset( create_gbuffer_texture(sgl::Texture::RGBA8, width, height, samplerState.get()) );
+    gbufferDepthMap.reset( create_gbuffer_texture(sgl::Texture::D24, width, height, samplerState.get()) );
+
+    gbufferTarget.reset( currentDevice()->CreateRenderTarget() );
+    gbufferTarget->SetColorAttachment(0, diffuseSpecularMap.get(), 0);
+    gbufferTarget->SetColorAttachment(1, normalShininessMap.get(), 0);
+    gbufferTarget->SetDepthStencilAttachment(gbufferDepthMap.get(), 0);
+    if ( sgl::SGL_OK != gbufferTarget->Dirty() ) {
+        throw gl_error(AUTO_LOGGER, "Can't create g-buffer render target.");
+    }
+
+    diffuseSpecularMapBinder->switch_values(diffuseSpecularMap.get(), 1, false);
+    normalShininessMapBinder->switch_values(normalShininessMap.get(), 1, false);
+    gbufferDepthMapBinder->switch_values(gbufferDepthMap.get(), 1, false);
+
+    // new textures may reuse addresses of the destroyed ones
+    currentStateTable().invalidateTextures();
+}
+
+void DeferredRenderer::render(realm::World& world, const scene::Camera& camera) const
+{
+    using namespace scene;
+
+    // reflections are shaded by forward passes
+    if ( dynamic_cast<const scene::ReflectCamera*>(&camera) )
+    {
+        ForwardRenderer::render(world, camera);
+        return;
+    }
+
+    if (!initialized) {
+        const_cast<DeferredRenderer*>(this)->init();
+    }
+
+    preRenderSignal(camera);
+
+    cameraParams->setup(camera);
+    {
+        // gather lights && frustum renderables
+        cull(world, camera);
+
+        light_type_vector lightTypes( light_type_vector::allocator_type(&frameArena) );
+        partition_lights(lightTypes);
+        reject_spot_lights(lightTypes);
+
+        sgl::Device*   device   = currentDevice();
+        sgl::rectangle viewport = camera.getViewport();
+        inputMapBinder->switch_values(0, 1, false);
+
+        // g-buffer of the opaque lit objects
+        if (!headless) {
+            update_gbuffer(viewport);
+        }
+        render_gbuffer(camera);
+
+        // choose render target, headless renderer has none
+        sgl::RenderTarget* renderTarget = 0;
+        if ( !headless && !bind_render_target(camera, renderTarget) ) {
+            return;
+        }
+
+        // pixel of the render target to the g-buffer texel, viewport is in the corner of the g-buffer
+        float gbufferWidth  = float(headless ? viewport.width : diffuseSpecularMap->Width());
+        float gbufferHeight = float(headless ? viewport.height : diffuseSpecularMap->Height());
+        gbufferScaleBiasBinder->write_value( math::Vector4f( 1.0f / gbufferWidth,
+                                                             1.0f / gbufferHeight,
+                                                             -float(viewport.x) / gbufferWidth,
+                                                             -float(viewport.y) / gbufferHeight ) );
+
+        // accumulate lighting, headless renderer only counts light passes
+        if (headless) {
+            render_light_volumes(camera);
+        }
+        else
+        {
+            device->SetViewport(viewport);
+            if (renderTarget)
+            {
+                renderTarget->SetDrawBuffer(0);
+                device->Clear(true, true, false);
+            }
+
+            device->PushState(sgl::State::BLEND_STATE);
+            device->PushState(sgl::State::DEPTH_STENCIL_STATE);
+            device->PushState(sgl::State::RASTERIZER_STATE);
+            currentStateTable().invalidateTextures();
+            {
+                volumeBuffer->Bind( volumeLayout.get() );
+                lightVolumeMatrixBinder->write_value( math::Matrix4f::identity() );
+
+                resolvePass->begin();
+                device->Draw(sgl::TRIANGLES, 0, 6);
+                resolvePass->end();
+
+                render_light_volumes(camera);
+            }
+            device->PopState(sgl::State::BLEND_STATE);
+            device->PopState(sgl::State::DEPTH_STENCIL_STATE);
+            device->PopState(sgl::State::RASTERIZER_STATE);
+        }
+
+        // forward passes of the unlit and transparent objects over the resolved depth
+        if (wireframe && device)
+        {
+            device->PushState(sgl::State::RASTERIZER_STATE);
+            wireframeState->Bind();
+        }
+
+        render_pass( RG_MAIN, RP_OPAQUE, cv.beginRenderable(), cv.endRenderable() );
+        render_lighting(RG_MAIN, camera, lightTypes);
+        if (desc.useDebugRender) {
+            render_pass( RG_MAIN, RP_DEBUG, cv.beginRenderable(), cv.endRenderable() );
+        }
+
+        if (wireframe && device) {
+            device->PopState(sgl::State::RASTERIZER_STATE);
+        }
+
+        if (headless) {
+            postRenderSignal(camera);
+        }
+        else {
+            post_process(camera, renderTarget);
+        }
+    }
+}
+
+void DeferredRenderer::reject_spot_lights(light_type_vector& lightTypes) const
+{
+    light_type_vector::iterator spotType = std::find(lightTypes.begin(), lightTypes.end(), scene::Light::SPOT);
+    if ( spotType == lightTypes.end() ) {
+        return;
+    }
+
+    // lights are partitioned by type
+    light_iterator first = cv.beginLight();
+    while ( first != cv.endLight() && (*first)->getLightType() != scene::Light::SPOT ) {
+        ++first;
+    }
+
+    light_iterator last = first;
+    while ( last != cv.endLight() && (*last)->getLightType() == scene::Light::SPOT ) {
+        ++last;
+    }
+
+    cv.removeLights(first, last);
+    lightTypes.erase(spotType);
+    if (!spotRejectLogged)
+    {
+        AUTO_LOGGER_MESSAGE(log::S_WARNING, "Spot lights are not supported by the deferred shading, ignoring them\n");
+        spotRejectLogged = true;
+    }
+}
+
+void DeferredRenderer::render_gbuffer(const scene::Camera& camera) const
+{
+    if (headless)
+    {
+        render_pass( RG_MAIN, RP_GBUFFER, cv.beginRenderable(), cv.endRenderable() );
+        return;
+    }
+
+    sgl::Device* device = currentDevice();
+    if ( sgl::SGL_OK != gbufferTarget->Bind() )
+    {
+        AUTO_LOGGER_MESSAGE(log::S_ERROR, "Can't bind g-buffer render target\n");
+        return;
+    }
+
+    sgl::rectangle viewport = camera.getViewport();
+    device->SetViewport( sgl::rectangle(0, 0, viewport.width, viewport.height) );
+
+    unsigned drawBuffers[] = {0, 1};
+    gbufferTarget->SetDrawBuffers(2, drawBuffers);
+    device->Clear(true, true, false);
+
+    if (wireframe)
+    {
+        device->PushState(sgl::State::RASTERIZER_STATE);
+        wireframeState->Bind();
+    }
+
+    render_pass( RG_MAIN, RP_GBUFFER, cv.beginRenderable(), cv.endRenderable() );
+
+    if (wireframe) {
+        device->PopState(sgl::State::RASTERIZER_STATE);
+    }
+
+    gbufferTarget->Unbind();
+}
+
+void DeferredRenderer::render_light_volumes(const scene::Camera& camera) const
+{
+    sgl::Device*         device = currentDevice();
+    light_const_iterator lightIter = cv.beginLight();
+    while ( lightIter != cv.endLight() )
+    {
+        // group lights of the same type
+        light_const_iterator lightIterEnd = lightIter;
+        while ( lightIterEnd != cv.endLight() && (*lightIterEnd)->getLightType() == (*lightIter)->getLightType() ) {
+            ++lightIterEnd;
+        }
+
+        switch ( (*lightIter)->getLightType() )
+        {
+        case scene::Light::DIRECTIONAL:
+            lightVolumeMatrixBinder->write_value( math::Matrix4f::identity() );
+            while (lightIter != lightIterEnd)
+            {
+                light_const_iterator batchEnd = lightIter;
+                for (int i = 0; i<lightParams->max_light_count() && batchEnd != lightIterEnd; ++i) {
+                    ++batchEnd;
+                }
+
+                lightParams->setup_directional(camera, lightIter, batchEnd);
+                if (device)
+                {
+                    const graphics::Pass* pass = directionalPasses[ std::distance(lightIter, batchEnd) ].get();
+                    pass->begin();
+                    device->Draw(sgl::TRIANGLES, 0, 6);
+                    pass->end();
+                }
+
+                ++numLightingPasses;
+                lightIter = batchEnd;
+            }
+            break;
+
+        case scene::Light::POINT:
+            // pass stays bound for the volumes, begin only uploads changed uniforms
+            for (; lightIter != lightIterEnd; ++lightIter)
+            {
+                const scene::PointLight* light = static_cast<const scene::PointLight*>(*lightIter);
+                math::Vector3f           position = math::xyz( light->getPosition() );
+                float                    radius   = light->getRadius();
+
+                lightParams->setup_point(camera, lightIter, lightIter + 1);
+                lightVolumeMatrixBinder->write_value( camera.getProjectionMatrix()
+                                                      * camera.getViewMatrix()
+                                                      * math::Matrix4f::translation(position.x, position.y, position.z)
+                                                      * math::Matrix4f::scale(radius, radius, radius) );
+                if (device)
+                {
+                    pointPass->begin();
+                    device->Draw(sgl::TRIANGLES, 6, numSphereVertices);
+                }
+
+                ++numLightingPasses;
+            }
+
+            if (device) {
+                pointPass->end();
+            }
+            break;
+
+        default:
+            lightIter = lightIterEnd;
+            break;
+        }
+    }
+}
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
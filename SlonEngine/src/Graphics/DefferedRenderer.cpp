@@ -1,4 +0,0 @@
-#include "Graphics/Renderer/DefferedRenderer.h"
-
-using namespace slon;
-using namespace graphics;
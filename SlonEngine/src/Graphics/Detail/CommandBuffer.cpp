@@ -0,0 +1,60 @@
+#include "stdafx.h"
+#include "Graphics/Detail/CommandBuffer.h"
+#include "Graphics/Renderable.h"
+#include <cassert>
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+CommandBuffer::CommandBuffer(linear_arena* arena)
+:   commands( command_vector::allocator_type(arena) )
+{
+}
+
+void CommandBuffer::release()
+{
+    command_vector( commands.get_allocator() ).swap(commands);
+}
+
+void CommandBuffer::beginWorldMatrices(graphics::Effect* effect, render_group_handle renderGroup, render_pass_handle renderPass)
+{
+    assert(renderGroup <= 0xFFFF && renderPass <= 0xFFFF);
+    push(BEGIN_WORLD_MATRICES, (renderGroup << 16) | renderPass, effect);
+}
+
+void CommandBuffer::recordPackets( render_group_handle         renderGroup,
+                                   render_pass_handle          renderPass,
+                                   RenderQueue::const_iterator firstPacket,
+                                   RenderQueue::const_iterator endPacket )
+{
+    for (RenderQueue::const_iterator iter  = firstPacket;
+                                     iter != endPacket; )
+    {
+        // effect world matrix parameter belongs to the node bound it last, so every packet
+        // having world matrix sets it, packets sharing effect bind parameter once
+        if (iter->worldMatrix) 
+        {
+            graphics::Effect* effect = iter->renderable->getEffect();
+            beginWorldMatrices(effect, renderGroup, renderPass);
+            for (; iter != endPacket && iter->worldMatrix && iter->renderable->getEffect() == effect; ++iter)
+            {
+                worldMatrix(iter->worldMatrix);
+                beginPass(iter->pass);
+                draw(iter->renderable);
+                endPass(iter->pass);
+            }
+            endWorldMatrices();
+            continue;
+        }
+
+        beginPass(iter->pass);
+        draw(iter->renderable);
+        endPass(iter->pass);
+        ++iter;
+    }
+}
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
@@ -0,0 +1,120 @@
+#include "stdafx.h"
+#include "Graphics/Common.h"
+#include "Graphics/Detail/CommandExecutor.h"
+#include "Graphics/Detail/StateTable.h"
+#include "Graphics/Pass.h"
+#include "Graphics/Renderable.h"
+#include <cassert>
+#include <sgl/Device.h>
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+void CommandExecutor::execute(const CommandBuffer& commandBuffer)
+{
+    timer.start();
+    for (CommandBuffer::const_iterator iter  = commandBuffer.begin();
+                                       iter != commandBuffer.end();
+                                       ++iter)
+    {
+        executeCommand(*iter);
+        ++statistics.numCommands[iter->type];
+    }
+    ++statistics.numBuffers;
+    statistics.executeTime += timer.getTime();
+}
+
+SGLCommandExecutor::SGLCommandExecutor(binding_mat4x4f* worldMatrixBinder_)
+:   worldMatrixBinder(worldMatrixBinder_)
+,   matrixEffect(0)
+,   matrixRenderGroup(0)
+,   matrixRenderPass(0)
+{
+}
+
+void SGLCommandExecutor::executeCommand(const CommandBuffer::command& cmd)
+{
+    switch (cmd.type)
+    {
+        case CommandBuffer::PUSH_STATES:
+        {
+            sgl::Device* device = currentDevice();
+            device->PushState(sgl::State::BLEND_STATE);
+            device->PushState(sgl::State::DEPTH_STENCIL_STATE);
+            device->PushState(sgl::State::RASTERIZER_STATE);
+            break;
+        }
+
+        case CommandBuffer::POP_STATES:
+        {
+            sgl::Device* device = currentDevice();
+            device->PopState(sgl::State::BLEND_STATE);
+            device->PopState(sgl::State::DEPTH_STENCIL_STATE);
+            device->PopState(sgl::State::RASTERIZER_STATE);
+            break;
+        }
+
+        case CommandBuffer::INVALIDATE_TEXTURES:
+            currentStateTable().invalidateTextures();
+            break;
+
+        case CommandBuffer::BEGIN_PASS:
+            static_cast<const Pass*>(cmd.object)->begin();
+            break;
+
+        case CommandBuffer::END_PASS:
+            static_cast<const Pass*>(cmd.object)->end();
+            break;
+
+        case CommandBuffer::DRAW:
+            static_cast<const Renderable*>(cmd.object)->render();
+            break;
+
+        case CommandBuffer::BEGIN_WORLD_MATRICES:
+        {
+            // packets share effect, world matrix is set through its parameter,
+            // packets use matrix of the effect if it has no such parameter
+            graphics::Effect* effect    = static_cast<graphics::Effect*>( const_cast<void*>(cmd.object) );
+            effectWorldMatrix = cast_binding<math::Matrix4f>( effect->getParameter( hash_string("worldMatrix") ) );
+            if ( worldMatrixBinder
+                 && effectWorldMatrix 
+                 && effect->bindParameter( hash_string("worldMatrix"), worldMatrixBinder ) )
+            {
+                matrixEffect      = effect;
+                matrixRenderGroup = CommandBuffer::getRenderGroup(cmd);
+                matrixRenderPass  = CommandBuffer::getRenderPass(cmd);
+            }
+            break;
+        }
+
+        case CommandBuffer::WORLD_MATRIX:
+        {
+            // effect computes transform uniforms on present, begin only uploads changed uniforms
+            if (matrixEffect)
+            {
+                graphics::Pass* passes[graphics::Effect::MAX_NUM_PASSES];
+                worldMatrixBinder->switch_values( const_cast<math::Matrix4f*>( static_cast<const math::Matrix4f*>(cmd.object) ), 1, false );
+                matrixEffect->present(matrixRenderGroup, matrixRenderPass, passes);
+            }
+            break;
+        }
+
+        case CommandBuffer::END_WORLD_MATRICES:
+        {
+            if (matrixEffect) {
+                matrixEffect->bindParameter( hash_string("worldMatrix"), effectWorldMatrix.get() );
+            }
+            matrixEffect = 0;
+            effectWorldMatrix.reset();
+            break;
+        }
+
+        default:
+            assert(!"Unknown command");
+    }
+}
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
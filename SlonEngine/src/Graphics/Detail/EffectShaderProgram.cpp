@@ -3,13 +3,44 @@
 #include "Graphics/Common.h"
 #include "FileSystem/File.h"
 #include "FileSystem/FileSystemManager.h"
+#include "Thread/StartStopTimer.h"
 #include <map>
+#include <set>
+
+DECLARE_AUTO_LOGGER("graphics.EffectShaderProgram")
 
 using namespace slon;
 using namespace slon::graphics;
 
 namespace {
 
+    typedef EffectShaderProgram::uber_program_hash  uber_program_hash;
+    typedef std::vector<std::string>                string_vector;
+
+    // shader file split at the version directive, definitions are inserted after it
+    struct shader_source
+    {
+        std::time_t writeTime;
+        std::string version;
+        std::string body;
+    };
+
+    struct program_entry
+    {
+        EffectShaderProgram::program_ptr    program;
+        EffectShaderProgram::binding_vector bindings;
+        bool                                requested;  // requested by effect, not only warmed up
+    };
+
+    typedef std::map<std::string, shader_source>        source_cache;
+    typedef std::map<uber_program_hash, program_entry>  program_cache;
+    typedef EffectShaderProgram::program_manifest       program_manifest;
+
+    static source_cache                             sourceCache;
+    static program_cache                            programCache;
+    static program_manifest                         programManifest;
+    static EffectShaderProgram::CACHE_STATISTICS    cacheStatistics;
+
     inline std::string mergeShaderNames( const std::string&   vertexShaderFileName,
                                          const std::string&   fragmentShaderFileName,
                                          const std::string&   geometryShaderFileName )
@@ -44,6 +75,42 @@ namespace {
 		return source;
     }
 
+    // read shader file if it isn't cached or modified since last read
+    const shader_source& loadSource(const log::logger_ptr& logger, const std::string& fileName)
+    {
+        filesystem::file_ptr file( asFile( filesystem::currentFileSystemManager().getNode(fileName.c_str()) ) );
+        std::time_t          writeTime = file ? file->lastWriteTime() : 0;
+
+        source_cache::iterator sourceIter = sourceCache.find(fileName);
+        if ( sourceIter != sourceCache.end() && writeTime != 0 && sourceIter->second.writeTime == writeTime )
+        {
+            ++cacheStatistics.numSourceHits;
+            return sourceIter->second;
+        }
+
+        shader_source& source = sourceCache[fileName];
+        source.writeTime = writeTime;
+        source.body      = readFile(logger, fileName);
+        source.version.clear();
+
+        size_t first = source.body.find_first_not_of(" \t\r\n");
+        if ( first != std::string::npos && source.body.compare(first, 8, "#version") == 0 )
+        {
+            size_t end = source.body.find('\n', first);
+            if (end == std::string::npos) 
+            {
+                source.body += '\n';
+                end          = source.body.length() - 1;
+            }
+
+            source.version = source.body.substr(0, end + 1);
+            source.body.erase(0, end + 1);
+        }
+
+        ++cacheStatistics.numSourceReads;
+        return source;
+    }
+
     inline sgl::Shader::TYPE getShaderType(const log::logger_ptr& logger, const std::string& fileName)
     {
         size_t length = fileName.length();
@@ -74,8 +141,6 @@ namespace {
 
         EffectShaderProgram::program_ptr operator () ()
         {
-            typedef EffectShaderProgram::uber_program_hash uber_program_hash;
-
             sgl::Device* device = currentDevice();
 
             // make definitions source
@@ -95,7 +160,8 @@ namespace {
                                                               iter != hash.endShader();
                                                               ++iter )
                 {
-                    std::string shaderSource = definitions + readFile(logger, *iter);
+                    const shader_source& source       = loadSource(logger, *iter);
+                    std::string          shaderSource = source.version + definitions + source.body;
 
                     sgl::Shader::DESC desc;
                     desc.type   = getShaderType(logger, *iter);
@@ -155,29 +221,69 @@ namespace {
         }
 
     private:
-        const log::logger_ptr&                          logger;
+        log::logger_ptr                                 logger;
         const EffectShaderProgram::uber_program_hash&   hash;
 
     public:
         EffectShaderProgram::binding_vector             bindings;
     };
 
-    typedef std::map<EffectShaderProgram::uber_program_hash, EffectShaderProgram::program_ptr> program_cache;
-    static program_cache programCache;
-
-    template<typename ProgramContructor>
-    EffectShaderProgram::program_ptr load_program(const EffectShaderProgram::uber_program_hash& hash, 
-                                                  ProgramContructor                             constructor)
+    // compiled programs keep their attribute bindings, so effects sharing program get them too
+    program_entry& load_program(const log::logger_ptr& logger, const uber_program_hash& hash)
     {
         program_cache::iterator programIter = programCache.find(hash);
-        if ( programIter != programCache.end() ) {
+        if ( programIter != programCache.end() ) 
+        {
+            ++cacheStatistics.numProgramHits;
             return programIter->second;
         }
-        
-        EffectShaderProgram::program_ptr program = constructor();
-        programCache.insert( program_cache::value_type(hash, program) );
 
-        return program;
+        StartStopTimer timer;
+        timer.start();
+
+        make_uber_program programConstructor(logger, hash);
+        program_entry     entry;
+        entry.program   = programConstructor();
+        entry.bindings  = programConstructor.bindings;
+        entry.requested = false;
+
+        ++cacheStatistics.numPrograms;
+        cacheStatistics.compileTime += timer.getTime();
+
+        return programCache.insert( program_cache::value_type(hash, entry) ).first->second;
+    }
+
+    // hash of the manifest program, definitions and shaders are sorted as by constructProgram
+    void add_manifest_program(program_manifest& programs, string_vector& definitions, string_vector& shaders)
+    {
+        std::sort( definitions.begin(), definitions.end() );
+        std::sort( shaders.begin(), shaders.end() );
+
+        programs.push_back( uber_program_hash( definitions.begin(),
+                                               definitions.end(),
+                                               shaders.begin(),
+                                               shaders.end() ) );
+        definitions.clear();
+        shaders.clear();
+    }
+
+    // compile program from the manifest if it isn't compiled yet
+    bool warmup_program(const log::logger_ptr& logger, const uber_program_hash& hash)
+    {
+        if ( programCache.find(hash) != programCache.end() ) {
+            return false;
+        }
+
+        try
+        {
+            load_program(logger, hash);
+        }
+        catch (shader_error&)
+        {
+            return false;
+        }
+
+        return true;
     }
 
 } // anonymous namesapce
@@ -269,9 +375,14 @@ void EffectShaderProgram::constructProgram()
                                 shaders.begin(),
                                 shaders.end() );
 
-        make_uber_program programConstructor(effectLogger, hash);
-        program    = load_program(hash, programConstructor);
-        bindings   = programConstructor.bindings;
+        program_entry& entry = load_program(effectLogger, hash);
+        if (!entry.requested)
+        {
+            programManifest.push_back(hash);
+            entry.requested = true;
+        }
+        program    = entry.program;
+        bindings   = entry.bindings;
 
         redirectUniforms();
         dirty = false;
@@ -286,3 +397,159 @@ const sgl::Program* EffectShaderProgram::getProgram() const
 
     return program.get();
 }
+
+void EffectShaderProgram::clearSourceCache()
+{
+    sourceCache.clear();
+}
+
+bool EffectShaderProgram::cacheSource(const std::string& fileName)
+{
+    AUTO_LOGGER_INIT;
+    size_t numSourceReads = cacheStatistics.numSourceReads;
+    loadSource(AUTO_LOGGER, fileName);
+    return cacheStatistics.numSourceReads != numSourceReads;
+}
+
+bool EffectShaderProgram::saveManifest(const std::string& fileName)
+{
+    return saveManifest(fileName, programManifest);
+}
+
+bool EffectShaderProgram::saveManifest(const std::string& fileName, const program_manifest& programs)
+{
+    using namespace filesystem;
+
+    std::string manifest;
+    for (size_t i = 0; i<programs.size(); ++i)
+    {
+        const uber_program_hash& hash = programs[i];
+        for (uber_program_hash::const_string_iterator iter  = hash.firstDefinition();
+                                                      iter != hash.endDefinition();
+                                                      ++iter )
+        {
+            manifest += "definition " + (*iter) + "\n";
+        }
+
+        for (uber_program_hash::const_string_iterator iter  = hash.firstShader();
+                                                      iter != hash.endShader();
+                                                      ++iter )
+        {
+            manifest += "shader " + (*iter) + "\n";
+        }
+        manifest += "\n";
+    }
+
+    file_ptr file( currentFileSystemManager().createFile(fileName.c_str()) );
+    if ( !file || !file->open(File::out) )
+    {
+        AUTO_LOGGER_MESSAGE(log::S_ERROR, "Can't create shader manifest: " << fileName << LOG_FILE_AND_LINE);
+        return false;
+    }
+
+    file->write( manifest.data(), manifest.length() );
+    file->close();
+
+    return true;
+}
+
+bool EffectShaderProgram::updateManifest(const std::string& fileName)
+{
+    program_manifest programs;
+    loadManifest(fileName, programs); // missing manifest is created
+
+    size_t                      numSaved = programs.size();
+    std::set<uber_program_hash> saved( programs.begin(), programs.end() );
+    for (size_t i = 0; i<programManifest.size(); ++i)
+    {
+        if ( saved.insert(programManifest[i]).second ) {
+            programs.push_back(programManifest[i]);
+        }
+    }
+
+    if (programs.size() == numSaved) {
+        return true;
+    }
+
+    return saveManifest(fileName, programs);
+}
+
+bool EffectShaderProgram::loadManifest(const std::string& fileName, program_manifest& programs)
+{
+    using namespace filesystem;
+
+    file_ptr file( asFile( currentFileSystemManager().getNode(fileName.c_str()) ) );
+    if ( !file || !file->open(File::in) ) {
+        return false;
+    }
+
+    std::string manifest( (size_t)file->size(), ' ' );
+    if ( !manifest.empty() ) {
+        file->read( &manifest[0], file->size() );
+    }
+    file->close();
+
+    string_vector definitions;
+    string_vector shaders;
+    for (size_t begin = 0; begin < manifest.length(); )
+    {
+        size_t end = manifest.find('\n', begin);
+        if (end == std::string::npos) {
+            end = manifest.length();
+        }
+
+        std::string line = manifest.substr(begin, end - begin);
+        if ( !line.empty() && line[line.length() - 1] == '\r' ) {
+            line.resize(line.length() - 1);
+        }
+
+        if ( line.compare(0, 11, "definition ") == 0 ) {
+            definitions.push_back( line.substr(11) );
+        }
+        else if ( line.compare(0, 7, "shader ") == 0 ) {
+            shaders.push_back( line.substr(7) );
+        }
+        else if ( line.empty() && !shaders.empty() ) {
+            add_manifest_program(programs, definitions, shaders);
+        }
+
+        begin = end + 1;
+    }
+
+    if ( !shaders.empty() ) {
+        add_manifest_program(programs, definitions, shaders);
+    }
+
+    return true;
+}
+
+size_t EffectShaderProgram::warmup(const std::string& fileName)
+{
+    AUTO_LOGGER_INIT;
+    program_manifest programs;
+    if ( !loadManifest(fileName, programs) ) 
+    {
+        AUTO_LOGGER_MESSAGE(log::S_ERROR, "Can't open shader manifest: " << fileName << LOG_FILE_AND_LINE);
+        return 0;
+    }
+
+    size_t numPrograms = 0;
+    for (size_t i = 0; i<programs.size(); ++i)
+    {
+        if ( warmup_program(AUTO_LOGGER, programs[i]) ) {
+            ++numPrograms;
+        }
+    }
+
+    return numPrograms;
+}
+
+const EffectShaderProgram::CACHE_STATISTICS& EffectShaderProgram::getCacheStatistics()
+{
+    return cacheStatistics;
+}
+
+void EffectShaderProgram::resetCacheStatistics()
+{
+    cacheStatistics = CACHE_STATISTICS();
+}
@@ -2,6 +2,7 @@
 #include "Graphics/Common.h"
 #include "Graphics/Detail/ParameterTable.h"
 #include "Graphics/Detail/FFPPass.h"
+#include "Graphics/Detail/StateTable.h"
 #include "Log/Logger.h"
 
 DECLARE_AUTO_LOGGER("graphics.detail.FFPPass")
@@ -12,49 +13,30 @@ namespace {
 
     using namespace slon;
 
-    sgl::ref_ptr<sgl::BlendState>           defaultBlendState;
-    sgl::ref_ptr<sgl::DepthStencilState>    defaultDepthStencilState;
-    sgl::ref_ptr<sgl::RasterizerState>      defaultRasterizerState;
-
-    sgl::BlendState* createDefaultBlendState()
+    const sgl::BlendState* createDefaultBlendState()
     {
-        if (!defaultBlendState)
-        {
-            sgl::BlendState::DESC desc;
-            desc.blendEnable = false;
-            defaultBlendState.reset( graphics::currentDevice()->CreateBlendState(desc) );
-        }
-
-        return defaultBlendState.get();
+        sgl::BlendState::DESC desc;
+        desc.blendEnable = false;
+        return graphics::detail::currentStateTable().createBlendState(desc);
     }
 
-    sgl::DepthStencilState* createDefaultDepthStencilState()
+    const sgl::DepthStencilState* createDefaultDepthStencilState()
     {
-        if (!defaultDepthStencilState)
-        {
-            sgl::DepthStencilState::DESC desc;
-            desc.depthEnable    = true;
-            desc.depthFunc      = sgl::DepthStencilState::LEQUAL;
-            desc.depthWriteMask = true;
-            desc.stencilEnable  = false;
-            defaultDepthStencilState.reset( graphics::currentDevice()->CreateDepthStencilState(desc) );
-        }
-
-        return defaultDepthStencilState.get();
+        sgl::DepthStencilState::DESC desc;
+        desc.depthEnable    = true;
+        desc.depthFunc      = sgl::DepthStencilState::LEQUAL;
+        desc.depthWriteMask = true;
+        desc.stencilEnable  = false;
+        return graphics::detail::currentStateTable().createDepthStencilState(desc);
     }
 
-    sgl::RasterizerState* createDefaultRasterizerState()
+    const sgl::RasterizerState* createDefaultRasterizerState()
     {
-        if (!defaultRasterizerState)
-        {
-            sgl::RasterizerState::DESC desc;
-            desc.cullMode  = sgl::RasterizerState::BACK;
-            desc.fillMode  = sgl::RasterizerState::SOLID;
-            desc.colorMask = sgl::RasterizerState::RGBA;
-            defaultRasterizerState.reset( graphics::currentDevice()->CreateRasterizerState(desc) );
-        }
-
-        return defaultRasterizerState.get();
+        sgl::RasterizerState::DESC desc;
+        desc.cullMode  = sgl::RasterizerState::BACK;
+        desc.fillMode  = sgl::RasterizerState::SOLID;
+        desc.colorMask = sgl::RasterizerState::RGBA;
+        return graphics::detail::currentStateTable().createRasterizerState(desc);
     }
 
 } // anonymous namespace
@@ -134,8 +116,8 @@ void FFPPass::setWorldViewMatrixBinder(const PARAMETER_DESC<math::Matrix4f>& bin
 
 void FFPPass::begin() const
 {
-    sgl::Device*     device  = currentDevice();
-    sgl::FFPProgram* program = device->FixedPipelineProgram();
+    StateTable&      stateTable = currentStateTable();
+    sgl::FFPProgram* program    = currentDevice()->FixedPipelineProgram();
 
     program->GetProjectionMatrixUniform()->Set( projectionMatrixParameter->value() );
     program->GetModelViewMatrixUniform()->Set( worldViewMatrixParameter->value() );
@@ -159,17 +141,9 @@ void FFPPass::begin() const
     }
 
     // bind states
-    if ( device->CurrentBlendState() != blendState ) {
-        blendState->Bind();
-    }
-
-    if ( device->CurrentDepthStencilState() != depthStencilState ) {
-        depthStencilState->Bind();
-    }
-
-    if ( device->CurrentRasterizerState() != rasterizerState ) {
-        rasterizerState->Bind();
-    }
+    stateTable.bindBlendState( blendState.get() );
+    stateTable.bindDepthStencilState( depthStencilState.get() );
+    stateTable.bindRasterizerState( rasterizerState.get() );
 }
 
 void FFPPass::end() const
@@ -180,6 +154,7 @@ void FFPPass::end() const
             textureParameters[i]->values()->Unbind();
         }
     }
+    currentStateTable().invalidateTextures();
 }
 
 } // namespace detail
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Graphics/Common.h"
 #include "Graphics/Detail/GraphicsManager.h"
+#include "Graphics/DeferredRenderer.h"
 #include "Graphics/FixedPipelineRenderer.h"
 #include "Graphics/ForwardRenderer.h"
 #include "Utility/error.hpp"
@@ -18,7 +19,8 @@ DECLARE_AUTO_LOGGER("graphics")
 GraphicsManager::GraphicsManager() :
     attributeTable(new detail::AttributeTable),
     parameterTable(new detail::ParameterTable),
-    uniformTable(new detail::UniformTable)
+    uniformTable(new detail::UniformTable),
+    stateTable(new detail::StateTable)
 {
 }
 
@@ -59,6 +61,7 @@ void GraphicsManager::setVideoMode( unsigned     width,
 
 graphics::Renderer* GraphicsManager::initRenderer(const ForwardRendererDesc& desc)
 {
+    stateTable->clear(); // states belong to the device
     for (int i = sgl::DV_OPENGL_3_2; i >= sgl::DV_OPENGL_2_0; --i)
     {
         device.reset( sglCreateDeviceFromCurrent(sgl::DEVICE_VERSION(i)) );
@@ -82,6 +85,7 @@ graphics::Renderer* GraphicsManager::initRenderer(const ForwardRendererDesc& des
 
 graphics::Renderer* GraphicsManager::initRenderer(const FFPRendererDesc& desc)
 {
+    stateTable->clear(); // states belong to the device
     for (int i = sgl::DV_OPENGL_2_1; i >= 0; --i)
     {
         bool force = (i == 0); // there is nothing to loose anyway
@@ -104,6 +108,64 @@ graphics::Renderer* GraphicsManager::initRenderer(const FFPRendererDesc& desc)
     return renderer.get();
 }
 
+graphics::Renderer* GraphicsManager::initRenderer(const DeferredRendererDesc& desc)
+{
+    stateTable->clear(); // states belong to the device
+    for (int i = sgl::DV_OPENGL_3_2; i >= sgl::DV_OPENGL_2_0; --i)
+    {
+        device.reset( sglCreateDeviceFromCurrent(sgl::DEVICE_VERSION(i)) );
+        if (device) {
+            break;
+        }
+    }
+
+    if (!device) {
+        throw slon_error(AUTO_LOGGER, "Can't initialize necessary device");
+    }
+
+    bitsPerPixel = desc.bitsPerPixel;
+    depthBits    = desc.depthBits;
+    multisample  = 1; // g-buffer is not multisampled
+    stencilBits  = 8;
+
+    // release parameters of the previous renderer before registering the same ones
+    renderer.reset();
+    renderer.reset( new detail::DeferredRenderer(desc) );
+    return renderer.get();
+}
+
+graphics::Renderer* GraphicsManager::initHeadlessRenderer(const ForwardRendererDesc& desc)
+{
+    stateTable->clear(); // states belong to the device
+    device.reset();
+
+    bitsPerPixel = desc.bitsPerPixel;
+    depthBits    = desc.depthBits;
+    multisample  = desc.multisample;
+    stencilBits  = 8;
+
+    // renderer without device only records commands
+    renderer.reset();
+    renderer.reset( new detail::ForwardRenderer(desc) );
+    return renderer.get();
+}
+
+graphics::Renderer* GraphicsManager::initHeadlessRenderer(const DeferredRendererDesc& desc)
+{
+    stateTable->clear(); // states belong to the device
+    device.reset();
+
+    bitsPerPixel = desc.bitsPerPixel;
+    depthBits    = desc.depthBits;
+    multisample  = 1; // g-buffer is not multisampled
+    stencilBits  = 8;
+
+    // renderer without device only records commands
+    renderer.reset();
+    renderer.reset( new detail::DeferredRenderer(desc) );
+    return renderer.get();
+}
+
 void GraphicsManager::setRenderingSurface(Surface& surface)
 {
 #ifdef _WIN32
@@ -216,14 +278,18 @@ const Surface& GraphicsManager::getRenderingSurface() const
 
 void GraphicsManager::render(realm::World& world)
 {
-    // render
-    device->Clear(true, true, true);
+    // render, headless renderer has no device
+    if (device) {
+        device->Clear(true, true, true);
+    }
     preFrameRenderSignal();
     for(size_t i = 0; i<cameras.size(); ++i) {
         renderer->render(world, *cameras[i]);
     }
     postFrameRenderSignal();
-    device->SwapBuffers();
+    if (device) {
+        device->SwapBuffers();
+    }
 }
 
 bool GraphicsManager::removeCamera(scene::Camera* camera)
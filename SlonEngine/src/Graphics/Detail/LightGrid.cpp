@@ -0,0 +1,166 @@
+#include "stdafx.h"
+#include "Graphics/Detail/LightGrid.h"
+
+namespace {
+
+    using namespace slon;
+
+    // view depth of the point projected to normalized device depth
+    float unproject_depth(const math::Matrix4f& projection, float ndcDepth)
+    {
+        return -(ndcDepth * projection[3][3] - projection[2][3]) / (projection[2][2] - ndcDepth * projection[3][2]);
+    }
+
+    unsigned clamp_tile(float ndc, unsigned numTiles)
+    {
+        int tile = int( std::floor( (ndc * 0.5f + 0.5f) * numTiles ) );
+        return unsigned( std::max( 0, std::min(tile, int(numTiles) - 1) ) );
+    }
+
+} // anonymous namespace
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+LightGrid::LightGrid()
+:   gridMap(grid_map_width * cluster_y)
+,   indexMap(index_map_width)
+{
+    setProjection( math::Matrix4f::perspective(0.7853982f, 1.0f, 1.0f, 1000.0f) );
+}
+
+void LightGrid::setProjection(const math::Matrix4f& projection_)
+{
+    projection = projection_;
+    zNear      = std::max(unproject_depth(projection, -1.0f), 1e-3f);
+    zFar       = unproject_depth(projection, 1.0f);
+    if ( !(zFar > zNear * 1.001f) || zFar > std::numeric_limits<float>::max() ) {
+        zFar = zNear * 1e4f; // infinite projection
+    }
+    sliceScale = cluster_z / std::log(zFar / zNear);
+}
+
+unsigned LightGrid::getSlice(float depth) const
+{
+    if (depth <= zNear) {
+        return 0;
+    }
+
+    int slice = int( std::log(depth / zNear) * sliceScale );
+    return unsigned( std::min(slice, int(cluster_z) - 1) );
+}
+
+math::Vector4f LightGrid::getDepthParams() const
+{
+    return math::Vector4f(1.0f / zNear, sliceScale, float(cluster_z), float(cluster_x));
+}
+
+void LightGrid::bin(const math::Vector4f* viewPositionRadius, size_t numLights)
+{
+    timer.start();
+    std::fill( gridMap.begin(), gridMap.end(), math::Vector4f(0.0f, 0.0f, 0.0f, 0.0f) );
+
+    // find cluster ranges of the lights, count lights of the clusters
+    lightRects.resize(numLights * 6);
+    for (size_t i = 0; i<numLights; ++i)
+    {
+        const math::Vector4f& light = viewPositionRadius[i];
+        unsigned*             rect  = &lightRects[i * 6];
+        float                 minDepth = -light.z - light.w;
+        float                 maxDepth = -light.z + light.w;
+
+        // empty range
+        std::fill(rect, rect + 3, 1u);
+        std::fill(rect + 3, rect + 6, 0u);
+        if (maxDepth < zNear || minDepth > zFar) {
+            continue;
+        }
+
+        if (minDepth <= zNear)
+        {
+            // sphere crosses near plane, use whole screen
+            rect[0] = 0;
+            rect[1] = 0;
+            rect[3] = cluster_x - 1;
+            rect[4] = cluster_y - 1;
+        }
+        else
+        {
+            // screen rect of the sphere bounding box
+            math::Vector2f minNdc( std::numeric_limits<float>::max(),  std::numeric_limits<float>::max());
+            math::Vector2f maxNdc(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+            for (int j = 0; j<8; ++j)
+            {
+                math::Vector4f corner( light.x + ( (j & 1) ? light.w : -light.w ),
+                                       light.y + ( (j & 2) ? light.w : -light.w ),
+                                       light.z + ( (j & 4) ? light.w : -light.w ),
+                                       1.0f );
+                math::Vector4f clip = projection * corner;
+                minNdc.x = std::min(minNdc.x, clip.x / clip.w);
+                minNdc.y = std::min(minNdc.y, clip.y / clip.w);
+                maxNdc.x = std::max(maxNdc.x, clip.x / clip.w);
+                maxNdc.y = std::max(maxNdc.y, clip.y / clip.w);
+            }
+
+            if (maxNdc.x < -1.0f || maxNdc.y < -1.0f || minNdc.x > 1.0f || minNdc.y > 1.0f) {
+                continue;
+            }
+
+            rect[0] = clamp_tile(minNdc.x, cluster_x);
+            rect[1] = clamp_tile(minNdc.y, cluster_y);
+            rect[3] = clamp_tile(maxNdc.x, cluster_x);
+            rect[4] = clamp_tile(maxNdc.y, cluster_y);
+        }
+        rect[2] = getSlice(minDepth);
+        rect[5] = getSlice( std::min(maxDepth, zFar) );
+
+        for (unsigned z = rect[2]; z <= rect[5]; ++z)
+        {
+            for (unsigned y = rect[1]; y <= rect[4]; ++y)
+            {
+                for (unsigned x = rect[0]; x <= rect[3]; ++x) {
+                    gridMap[y * grid_map_width + z * cluster_x + x].y += 1.0f;
+                }
+            }
+        }
+    }
+
+    // make offsets of the cluster lists
+    unsigned numIndices = 0;
+    for (size_t i = 0; i<gridMap.size(); ++i)
+    {
+        gridMap[i].x  = float(numIndices);
+        numIndices   += unsigned(gridMap[i].y);
+        gridMap[i].y  = 0.0f;
+    }
+
+    // fill cluster lists
+    unsigned numRows = std::max( (numIndices + index_map_width - 1) / index_map_width, 1u );
+    indexMap.resize(numRows * index_map_width);
+    for (size_t i = 0; i<numLights; ++i)
+    {
+        const unsigned* rect = &lightRects[i * 6];
+        for (unsigned z = rect[2]; z <= rect[5]; ++z)
+        {
+            for (unsigned y = rect[1]; y <= rect[4]; ++y)
+            {
+                for (unsigned x = rect[0]; x <= rect[3]; ++x)
+                {
+                    math::Vector4f& cluster = gridMap[y * grid_map_width + z * cluster_x + x];
+                    indexMap[ unsigned(cluster.x + cluster.y) ].x = float(i);
+                    cluster.y += 1.0f;
+                }
+            }
+        }
+    }
+
+    ++statistics.numBinnings;
+    statistics.numLights       += numLights;
+    statistics.numLightIndices += numIndices;
+    statistics.binTime         += timer.getTime();
+}
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Graphics/Common.h"
 #include "Graphics/Detail/Pass.h"
+#include "Graphics/Detail/StateTable.h"
 #include "Graphics/ParameterBinding.h"
 #include <boost/iterator/indirect_iterator.hpp>
 #include <boost/bind.hpp>
@@ -11,49 +12,30 @@ namespace {
 
     using namespace slon;
 
-    sgl::ref_ptr<sgl::BlendState>           defaultBlendState;
-    sgl::ref_ptr<sgl::DepthStencilState>    defaultDepthStencilState;
-    sgl::ref_ptr<sgl::RasterizerState>      defaultRasterizerState;
-
-    sgl::BlendState* createDefaultBlendState()
+    const sgl::BlendState* createDefaultBlendState()
     {
-        if (!defaultBlendState)
-        {
-            sgl::BlendState::DESC desc;
-            desc.blendEnable = false;
-            defaultBlendState.reset( graphics::currentDevice()->CreateBlendState(desc) );
-        }
-
-        return defaultBlendState.get();
+        sgl::BlendState::DESC desc;
+        desc.blendEnable = false;
+        return graphics::detail::currentStateTable().createBlendState(desc);
     }
 
-    sgl::DepthStencilState* createDefaultDepthStencilState()
+    const sgl::DepthStencilState* createDefaultDepthStencilState()
     {
-        if (!defaultDepthStencilState)
-        {
-            sgl::DepthStencilState::DESC desc;
-            desc.depthEnable    = true;
-            desc.depthFunc      = sgl::DepthStencilState::LEQUAL;
-            desc.depthWriteMask = true;
-            desc.stencilEnable  = false;
-            defaultDepthStencilState.reset( graphics::currentDevice()->CreateDepthStencilState(desc) );
-        }
-
-        return defaultDepthStencilState.get();
+        sgl::DepthStencilState::DESC desc;
+        desc.depthEnable    = true;
+        desc.depthFunc      = sgl::DepthStencilState::LEQUAL;
+        desc.depthWriteMask = true;
+        desc.stencilEnable  = false;
+        return graphics::detail::currentStateTable().createDepthStencilState(desc);
     }
 
-    sgl::RasterizerState* createDefaultRasterizerState()
+    const sgl::RasterizerState* createDefaultRasterizerState()
     {
-        if (!defaultRasterizerState)
-        {
-            sgl::RasterizerState::DESC desc;
-            desc.cullMode  = sgl::RasterizerState::BACK;
-            desc.fillMode  = sgl::RasterizerState::SOLID;
-            desc.colorMask = sgl::RasterizerState::RGBA;
-            defaultRasterizerState.reset( graphics::currentDevice()->CreateRasterizerState(desc) );
-        }
-
-        return defaultRasterizerState.get();
+        sgl::RasterizerState::DESC desc;
+        desc.cullMode  = sgl::RasterizerState::BACK;
+        desc.fillMode  = sgl::RasterizerState::SOLID;
+        desc.colorMask = sgl::RasterizerState::RGBA;
+        return graphics::detail::currentStateTable().createRasterizerState(desc);
     }
 }
 
@@ -242,21 +224,10 @@ Pass::~Pass()
 
 void Pass::begin() const
 {
-    sgl::Device* device = currentDevice();
+    StateTable& stateTable = currentStateTable();
 
     // bind program
-    if (program)
-    {
-        if ( device->CurrentProgram() != program ) {
-            program->Bind();
-        }
-    }
-    else
-    {
-        if ( device->CurrentProgram() ) {
-            device->CurrentProgram()->Unbind();
-        }
-    }
+    stateTable.bindProgram( program.get() );
 
     // bind uniforms
     std::for_each( boost::make_indirect_iterator( uniformBinders.begin() ),
@@ -273,17 +244,9 @@ void Pass::begin() const
     }
 
     // bind states
-    if ( device->CurrentBlendState() != blendState ) {
-        blendState->Bind();
-    }
-
-    if ( device->CurrentDepthStencilState() != depthStencilState ) {
-        depthStencilState->Bind();
-    }
-
-    if ( device->CurrentRasterizerState() != rasterizerState ) {
-        rasterizerState->Bind();
-    }
+    stateTable.bindBlendState( blendState.get() );
+    stateTable.bindDepthStencilState( depthStencilState.get() );
+    stateTable.bindRasterizerState( rasterizerState.get() );
 }
 
 void Pass::end() const
@@ -0,0 +1,102 @@
+#include "stdafx.h"
+#include "Graphics/Detail/RenderQueue.h"
+#include "Utility/Algorithm/radix_sort.hpp"
+#include <algorithm>
+
+namespace {
+
+    using namespace slon::graphics::detail;
+
+    typedef RenderQueue::key_type key_type;
+
+    const key_type priority_program_mask = (key_type(1) << 56) - 1;
+
+    struct packet_key
+    {
+        key_type operator () (const RenderQueue::render_packet& packet) const { return packet.key; }
+    };
+
+    // fold pointer bits into numBits bits
+    key_type hash_pointer(key_type ptr, unsigned numBits)
+    {
+        ptr >>= 4; // alignment
+        return (ptr ^ (ptr >> numBits) ^ (ptr >> (2 * numBits))) & ((key_type(1) << numBits) - 1);
+    }
+
+    // bits of non negative float are ordered as float values
+    key_type depth_bits(float depth, unsigned numBits)
+    {
+        union { float f; unsigned u; } bits;
+        bits.f = std::max(depth, 0.0f);
+        return key_type(bits.u >> (32 - numBits));
+    }
+
+} // anonymous namespace
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+RenderQueue::RenderQueue(linear_arena* arena)
+:   packets( render_packet_vector::allocator_type(arena) )
+,   sortBuffer( render_packet_vector::allocator_type(arena) )
+{
+}
+
+void RenderQueue::release()
+{
+    render_packet_vector( packets.get_allocator() ).swap(packets);
+    render_packet_vector( sortBuffer.get_allocator() ).swap(sortBuffer);
+}
+
+RenderQueue::key_type RenderQueue::makeKey(unsigned renderPass, long long priority, const Pass* pass, float depth)
+{
+    key_type bin     = priority < 0 ? 0 : key_type(priority >> 56) & 0xF;
+    key_type program = priority < 0 ? 0 : hash_pointer(key_type(priority) & priority_program_mask, 20);
+    key_type key     = (bin << 60) | (key_type(renderPass & 0xF) << 56);
+    if (bin == 0)
+    {
+        key |= program << 36;
+        key |= hash_pointer( key_type(reinterpret_cast<size_t>(pass)), 16 ) << 20;
+        key |= depth_bits(depth, 20);
+    }
+    else
+    {
+        key |= ( ~depth_bits(depth, 24) & 0xFFFFFF ) << 32;
+        key |= program << 12;
+        key |= hash_pointer( key_type(reinterpret_cast<size_t>(pass)), 12 );
+    }
+
+    return key;
+}
+
+unsigned RenderQueue::getProgramId(key_type key)
+{
+    if (getBin(key) == 0) {
+        return unsigned(key >> 36) & 0xFFFFF;
+    }
+
+    return unsigned(key >> 12) & 0xFFFFF;
+}
+
+void RenderQueue::sort()
+{
+    sortTimer.start();
+    radix_sort(packets, sortBuffer, packet_key());
+    statistics.sortTime += sortTimer.getTime();
+    statistics.numPackets += packets.size();
+
+    for (size_t i = 1; i<packets.size(); ++i)
+    {
+        if ( getProgramId(packets[i].key) != getProgramId(packets[i - 1].key) ) {
+            ++statistics.numProgramSwitches;
+        }
+        if (packets[i].pass != packets[i - 1].pass) {
+            ++statistics.numPassSwitches;
+        }
+    }
+}
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
@@ -0,0 +1,348 @@
+#include "stdafx.h"
+#include "Graphics/Detail/ShadowSilhouette.h"
+#include "Utility/Algorithm/parallel.hpp"
+#ifdef SLON_ENGINE_USE_SSE
+#   include <xmmintrin.h>
+#endif
+
+namespace {
+
+    using namespace slon;
+    using graphics::detail::ShadowSilhouette;
+
+    const size_t face_grain_size = 16384;
+    const size_t pair_grain_size = 65536;
+
+    struct half_edge
+    {
+        unsigned long long  key;    // min vertex in high bits, max vertex in low bits, degenerate faces are last
+        unsigned            index;  // index of the edge start in the index array
+    };
+
+    typedef std::vector<half_edge>  half_edge_vector;
+
+    // order by vertex pair, then by face, so result doesn't depend on the number of threads
+    struct less_half_edge
+    {
+        bool operator () (const half_edge& a, const half_edge& b) const
+        {
+            return a.key < b.key || (a.key == b.key && a.index < b.index);
+        }
+    };
+
+    unsigned next_in_face(unsigned index)
+    {
+        return index % 3 == 2 ? index - 2 : index + 1;
+    }
+
+    struct setup_faces_task
+    {
+        const math::Vector3f*   positions;
+        const unsigned*         indices;
+        float*                  planes;
+        half_edge*              halfEdges;
+
+        void operator () (size_t begin, size_t end) const
+        {
+            for (size_t i = begin; i<end; ++i)
+            {
+                const unsigned*       face = &indices[i * 3];
+                const math::Vector3f& a    = positions[ face[0] ];
+                const math::Vector3f& b    = positions[ face[1] ];
+                const math::Vector3f& c    = positions[ face[2] ];
+                math::Vector3f        n    = math::cross(b - a, c - a);
+
+                float* block = &planes[(i >> 2) * 16 + (i & 3)];
+                block[0]     = n.x;
+                block[4]     = n.y;
+                block[8]     = n.z;
+                block[12]    = -math::dot(n, a);
+
+                // edges of the degenerate faces don't take part in pairing
+                bool degenerate = face[0] == face[1] || face[1] == face[2] || face[2] == face[0];
+                for (unsigned j = 0; j<3; ++j)
+                {
+                    unsigned           index = unsigned(i * 3 + j);
+                    unsigned long long v0    = face[j];
+                    unsigned long long v1    = face[(j + 1) % 3];
+                    halfEdges[index].index   = index;
+                    halfEdges[index].key     = degenerate ? ~0ull : ( std::min(v0, v1) << 32 | std::max(v0, v1) );
+                }
+            }
+        }
+    };
+
+    struct pair_chunk
+    {
+        ShadowSilhouette::edge_vector   edges;
+        size_t                          numOpenEdges;
+        size_t                          numNonManifoldEdges;
+    };
+
+    struct pair_edges_task
+    {
+        const std::vector<unsigned>*    indices;
+        const half_edge_vector*         halfEdges;
+        const std::vector<size_t>*      bounds;
+        std::vector<pair_chunk>*        chunks;
+
+        void operator () (size_t begin, size_t end) const
+        {
+            for (size_t i = begin; i<end; ++i) {
+                pair( (*bounds)[i], (*bounds)[i + 1], (*chunks)[i] );
+            }
+        }
+
+        // match half edges of the opposite orientation within every run of the same vertex pair
+        void pair(size_t first, size_t last, pair_chunk& chunk) const
+        {
+            const std::vector<unsigned>& idx = *indices;
+            const half_edge_vector&      he  = *halfEdges;
+
+            chunk.edges.clear();
+            chunk.edges.reserve( (last - first) / 2 + 1 );
+            chunk.numOpenEdges        = 0;
+            chunk.numNonManifoldEdges = 0;
+
+            std::vector<bool> matched;
+            for (size_t runBegin = first; runBegin < last; )
+            {
+                size_t runEnd = runBegin + 1;
+                while ( runEnd < last && he[runEnd].key == he[runBegin].key ) {
+                    ++runEnd;
+                }
+
+                if (he[runBegin].key == ~0ull) {
+                    break; // degenerate edges
+                }
+
+                if (runEnd - runBegin > 2) {
+                    ++chunk.numNonManifoldEdges;
+                }
+
+                matched.assign(runEnd - runBegin, false);
+                for (size_t j = runBegin; j<runEnd; ++j)
+                {
+                    if ( matched[j - runBegin] ) {
+                        continue;
+                    }
+
+                    unsigned               index = he[j].index;
+                    ShadowSilhouette::edge e     = { idx[index], idx[ next_in_face(index) ], index / 3, ShadowSilhouette::invalid_face };
+                    for (size_t k = j + 1; k<runEnd; ++k)
+                    {
+                        if ( !matched[k - runBegin] && idx[ he[k].index ] == e.v1 )
+                        {
+                            matched[k - runBegin] = true;
+                            e.face1               = he[k].index / 3;
+                            break;
+                        }
+                    }
+
+                    if (e.face1 == ShadowSilhouette::invalid_face) {
+                        ++chunk.numOpenEdges;
+                    }
+                    chunk.edges.push_back(e);
+                }
+                runBegin = runEnd;
+            }
+        }
+    };
+
+} // anonymous namespace
+
+namespace slon {
+namespace graphics {
+namespace detail {
+
+ShadowSilhouette::ShadowSilhouette()
+:   numFaces(0)
+,   numOpenEdges(0)
+,   numNonManifoldEdges(0)
+,   light(0.0f, 0.0f, 0.0f, 0.0f)
+,   lightCaps(false)
+,   valid(false)
+,   numSilhouetteEdges(0)
+{
+}
+
+void ShadowSilhouette::setup( thread::ThreadPool&     pool,
+                              const math::Vector3f*   vertices_, 
+                              size_t                  numVertices, 
+                              const unsigned*         indices_, 
+                              size_t                  numIndices )
+{
+    timer.start();
+    positions.assign(vertices_, vertices_ + numVertices);
+    indices.assign(indices_, indices_ + numIndices - numIndices % 3);
+    numFaces = indices.size() / 3;
+    valid    = false;
+
+    // face planes and half edges, padding faces are never lit
+    size_t numBlocks = (numFaces + 3) / 4;
+    planes.assign(numBlocks * 16, 0.0f);
+    facing.assign(numBlocks, 0);
+
+    half_edge_vector halfEdges( indices.size() );
+    if ( !halfEdges.empty() )
+    {
+        setup_faces_task setupFaces = { &positions[0], &indices[0], &planes[0], &halfEdges[0] };
+        parallel_for(pool, 0, numFaces, face_grain_size, setupFaces);
+        parallel_sort(pool, halfEdges.begin(), halfEdges.end(), less_half_edge());
+    }
+
+    // split sorted half edges into chunks at vertex pair boundaries and pair them concurrently
+    size_t numChunks = std::max<size_t>( (halfEdges.size() + pair_grain_size - 1) / pair_grain_size, 1 );
+    std::vector<size_t> bounds(numChunks + 1);
+    for (size_t i = 0; i <= numChunks; ++i)
+    {
+        size_t bound = halfEdges.size() * i / numChunks;
+        while ( bound > 0 && bound < halfEdges.size() && halfEdges[bound].key == halfEdges[bound - 1].key ) {
+            ++bound;
+        }
+        bounds[i] = bound;
+    }
+
+    std::vector<pair_chunk> chunks(numChunks);
+    pair_edges_task pairEdges = { &indices, &halfEdges, &bounds, &chunks };
+    parallel_for(pool, 0, numChunks, 1, pairEdges);
+
+    edges.clear();
+    numOpenEdges        = 0;
+    numNonManifoldEdges = 0;
+    for (size_t i = 0; i<numChunks; ++i)
+    {
+        edges.insert( edges.end(), chunks[i].edges.begin(), chunks[i].edges.end() );
+        numOpenEdges        += chunks[i].numOpenEdges;
+        numNonManifoldEdges += chunks[i].numNonManifoldEdges;
+    }
+    statistics.setupTime += timer.getTime();
+}
+
+void ShadowSilhouette::setup(const math::Vector3f* vertices_, size_t numVertices, const unsigned* indices_, size_t numIndices)
+{
+    setup(parallel_thread_pool(), vertices_, numVertices, indices_, numIndices);
+}
+
+void ShadowSilhouette::classifyFaces(const math::Vector4f& l)
+{
+    size_t numBlocks = facing.size();
+#ifdef SLON_ENGINE_USE_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 lx   = _mm_set1_ps(l.x);
+    const __m128 ly   = _mm_set1_ps(l.y);
+    const __m128 lz   = _mm_set1_ps(l.z);
+    const __m128 lw   = _mm_set1_ps(l.w);
+    for (size_t i = 0; i<numBlocks; ++i)
+    {
+        const float* block = &planes[i * 16];
+        __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps(_mm_loadu_ps(block), lx),
+                                           _mm_mul_ps(_mm_loadu_ps(block + 4), ly) ),
+                               _mm_add_ps( _mm_mul_ps(_mm_loadu_ps(block + 8), lz),
+                                           _mm_mul_ps(_mm_loadu_ps(block + 12), lw) ) );
+        facing[i] = (unsigned char)_mm_movemask_ps( _mm_cmpgt_ps(d, zero) );
+    }
+#else
+    for (size_t i = 0; i<numBlocks; ++i)
+    {
+        const float*  block = &planes[i * 16];
+        unsigned char mask  = 0;
+        for (int j = 0; j<4; ++j)
+        {
+            float d = block[j] * l.x + block[j + 4] * l.y + block[j + 8] * l.z + block[j + 12] * l.w;
+            mask   |= (d > 0.0f ? 1 : 0) << j;
+        }
+        facing[i] = mask;
+    }
+#endif
+}
+
+math::Vector4f ShadowSilhouette::extrude(const math::Vector3f& v) const
+{
+    if (light.w == 0.0f) {
+        return math::Vector4f(-light.x, -light.y, -light.z, 0.0f);
+    }
+
+    return math::Vector4f(v.x - light.x, v.y - light.y, v.z - light.z, 0.0f);
+}
+
+bool ShadowSilhouette::extract(const math::Vector4f& lightPosition, bool caps)
+{
+    if ( valid
+         && caps == lightCaps
+         && light.x == lightPosition.x
+         && light.y == lightPosition.y
+         && light.z == lightPosition.z
+         && light.w == lightPosition.w )
+    {
+        ++statistics.numCached;
+        return false;
+    }
+
+    timer.start();
+    light     = lightPosition;
+    lightCaps = caps;
+    valid     = true;
+    classifyFaces(light);
+
+    // extrude silhouette edges, edge is oriented as in its lit face, so side quads face outside
+    vertices.clear();
+    numSilhouetteEdges = 0;
+    for (size_t i = 0; i<edges.size(); ++i)
+    {
+        const edge& e      = edges[i];
+        bool        lit0   = isLit(e.face0);
+        bool        lit1   = e.face1 != invalid_face && isLit(e.face1);
+        if (lit0 == lit1) {
+            continue;
+        }
+
+        const math::Vector3f& a = positions[lit0 ? e.v0 : e.v1];
+        const math::Vector3f& b = positions[lit0 ? e.v1 : e.v0];
+        math::Vector4f        ea = extrude(a);
+        math::Vector4f        eb = extrude(b);
+        vertices.push_back( math::make_vec(b, 1.0f) );
+        vertices.push_back( math::make_vec(a, 1.0f) );
+        vertices.push_back( ea );
+        vertices.push_back( math::make_vec(b, 1.0f) );
+        vertices.push_back( ea );
+        vertices.push_back( eb );
+        ++numSilhouetteEdges;
+    }
+
+    // lit faces close the volume near the occluder, their extrusion closes it at infinity,
+    // extrusion of the directional light converges to a single point
+    if (caps)
+    {
+        for (size_t i = 0; i<numFaces; ++i)
+        {
+            if ( !isLit( unsigned(i) ) ) {
+                continue;
+            }
+
+            const math::Vector3f& a = positions[ indices[i * 3] ];
+            const math::Vector3f& b = positions[ indices[i * 3 + 1] ];
+            const math::Vector3f& c = positions[ indices[i * 3 + 2] ];
+            vertices.push_back( math::make_vec(a, 1.0f) );
+            vertices.push_back( math::make_vec(b, 1.0f) );
+            vertices.push_back( math::make_vec(c, 1.0f) );
+            if (light.w != 0.0f)
+            {
+                vertices.push_back( extrude(c) );
+                vertices.push_back( extrude(b) );
+                vertices.push_back( extrude(a) );
+            }
+        }
+    }
+
+    ++statistics.numExtractions;
+    statistics.numSilhouetteEdges += numSilhouetteEdges;
+    statistics.numTriangles       += vertices.size() / 3;
+    statistics.extractTime        += timer.getTime();
+
+    return true;
+}
+
+} // namespace detail
+} // namespace graphics
+} // namespace slon
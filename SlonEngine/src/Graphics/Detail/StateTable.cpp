@@ -1,8 +1,186 @@
 #include "stdafx.h"
-#include "Graphics/GraphicsManager.h"
+#include "Graphics/Common.h"
+#include "Graphics/Detail/GraphicsManager.h"
+#include "Graphics/Detail/StateTable.h"
+#include <cstring>
 
 namespace slon {
 namespace graphics {
+namespace detail {
 
+// compare next field of the descriptions, continue if equal
+#define COMPARE_FIELD(field) if (a.field != b.field) { return a.field < b.field; }
+
+bool StateTable::blend_desc_less::operator () (const sgl::BlendState::DESC& a, const sgl::BlendState::DESC& b) const
+{
+    COMPARE_FIELD(blendEnable)
+    if (!a.blendEnable) {
+        return false;
+    }
+
+    COMPARE_FIELD(srcBlend)
+    COMPARE_FIELD(destBlend)
+    COMPARE_FIELD(blendOp)
+    COMPARE_FIELD(srcBlendAlpha)
+    COMPARE_FIELD(destBlendAlpha)
+    COMPARE_FIELD(blendOpAlpha)
+    return false;
+}
+
+bool StateTable::depth_stencil_desc_less::operator () (const sgl::DepthStencilState::DESC& a, const sgl::DepthStencilState::DESC& b) const
+{
+    // disabled depth test doesn't write depth either
+    COMPARE_FIELD(depthEnable)
+    if (a.depthEnable)
+    {
+        COMPARE_FIELD(depthWriteMask)
+        COMPARE_FIELD(depthFunc)
+    }
+    COMPARE_FIELD(stencilEnable)
+    if (a.stencilEnable) {
+        return std::memcmp( &a, &b, sizeof(sgl::DepthStencilState::DESC) ) < 0; // compare stencil functions, operations and masks
+    }
+    return false;
+}
+
+bool StateTable::rasterizer_desc_less::operator () (const sgl::RasterizerState::DESC& a, const sgl::RasterizerState::DESC& b) const
+{
+    COMPARE_FIELD(fillMode)
+    COMPARE_FIELD(cullMode)
+    COMPARE_FIELD(colorMask)
+    return false;
+}
+
+#undef COMPARE_FIELD
+
+StateTable::StateTable()
+{
+}
+
+const sgl::BlendState* StateTable::createBlendState(const sgl::BlendState::DESC& desc)
+{
+    sgl::ref_ptr<sgl::BlendState>& state = blendStates[desc];
+    if (!state) {
+        state.reset( currentDevice()->CreateBlendState(desc) );
+    }
+
+    return state.get();
+}
+
+const sgl::DepthStencilState* StateTable::createDepthStencilState(const sgl::DepthStencilState::DESC& desc)
+{
+    sgl::ref_ptr<sgl::DepthStencilState>& state = depthStencilStates[desc];
+    if (!state) {
+        state.reset( currentDevice()->CreateDepthStencilState(desc) );
+    }
+
+    return state.get();
+}
+
+const sgl::RasterizerState* StateTable::createRasterizerState(const sgl::RasterizerState::DESC& desc)
+{
+    sgl::ref_ptr<sgl::RasterizerState>& state = rasterizerStates[desc];
+    if (!state) {
+        state.reset( currentDevice()->CreateRasterizerState(desc) );
+    }
+
+    return state.get();
+}
+
+void StateTable::bindProgram(const sgl::Program* program)
+{
+    sgl::Device* device = currentDevice();
+    if ( device->CurrentProgram() == program )
+    {
+        ++statistics.numSkippedStateChanges;
+        return;
+    }
+
+    if (program) {
+        program->Bind();
+    }
+    else {
+        device->CurrentProgram()->Unbind();
+    }
+    ++statistics.numIssuedStateChanges;
+}
+
+void StateTable::bindBlendState(const sgl::BlendState* blendState)
+{
+    if ( currentDevice()->CurrentBlendState() == blendState )
+    {
+        ++statistics.numSkippedStateChanges;
+        return;
+    }
+
+    blendState->Bind();
+    ++statistics.numIssuedStateChanges;
+}
+
+void StateTable::bindDepthStencilState(const sgl::DepthStencilState* depthStencilState)
+{
+    if ( currentDevice()->CurrentDepthStencilState() == depthStencilState )
+    {
+        ++statistics.numSkippedStateChanges;
+        return;
+    }
+
+    depthStencilState->Bind();
+    ++statistics.numIssuedStateChanges;
+}
+
+void StateTable::bindRasterizerState(const sgl::RasterizerState* rasterizerState)
+{
+    if ( currentDevice()->CurrentRasterizerState() == rasterizerState )
+    {
+        ++statistics.numSkippedStateChanges;
+        return;
+    }
+
+    rasterizerState->Bind();
+    ++statistics.numIssuedStateChanges;
+}
+
+bool StateTable::isTextureBound(unsigned stage, const sgl::Texture* texture)
+{
+    if ( stage < max_texture_stages && textures[stage].get() == texture )
+    {
+        ++statistics.numSkippedSamplerBinds;
+        return true;
+    }
+
+    return false;
+}
+
+void StateTable::setTextureBound(unsigned stage, const sgl::Texture* texture)
+{
+    if (stage < max_texture_stages) {
+        textures[stage].reset(texture);
+    }
+    ++statistics.numIssuedSamplerBinds;
+}
+
+void StateTable::invalidateTextures()
+{
+    for (unsigned i = 0; i<max_texture_stages; ++i) {
+        textures[i].reset();
+    }
+}
+
+void StateTable::clear()
+{
+    blendStates.clear();
+    depthStencilStates.clear();
+    stencilStates.clear();
+    rasterizerStates.clear();
+    invalidateTextures();
+}
+
+StateTable& currentStateTable()
+{
+    return static_cast<detail::GraphicsManager&>( currentGraphicsManager() ).getStateTable();
+}
+
+} // namespace detail
 } // namespace graphics
-} // namespace slon
\ No newline at end of file
+} // namespace slon
@@ -1,14 +1,20 @@
 #include "stdafx.h"
 #define _DEBUG_NEW_REDEFINE_NEW 0 // disable debug new due to conflict with sgl::Aligned allocator
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystemManager.h"
 #include "Graphics/Common.h"
+#include "Graphics/Detail/EffectShaderProgram.h"
 #include "Graphics/Detail/ParameterTable.h"
+#include "Graphics/GraphicsManager.h"
 #include "Graphics/Renderable.h"
 #include "Graphics/ForwardRenderer.h"
+#include "Graphics/LightingEffect.h"
 #include "Log/Logger.h"
 #include "Scene/ReflectCamera.h"
 #include "Scene/DirectionalLight.h"
 #include "Scene/PointLight.h"
 #include "Scene/CullVisitor.h"
+#include "Utility/Algorithm/parallel.hpp"
 #include "Utility/error.hpp"
 
 DECLARE_AUTO_LOGGER("graphics.ForwardRenderer")
@@ -18,6 +24,33 @@ namespace {
     using namespace slon;
     using namespace slon::graphics;
 
+    const size_t record_grain_size = 4096;
+
+    // uber programs saved by ForwardRenderer::saveShaderManifest, compiled on renderer init
+    const char* shader_manifest = "Data/Shaders/manifest";
+
+    struct record_packets_task
+    {
+        const detail::RenderQueue*              renderQueue;
+        render_group_handle                     renderGroup;
+        render_pass_handle                      renderPass;
+        const std::vector<size_t>*              bounds;
+        std::vector<detail::CommandBuffer>*     buffers;
+
+        void operator () (size_t begin, size_t end) const
+        {
+            for (size_t i = begin; i<end; ++i)
+            {
+                detail::CommandBuffer& buffer = (*buffers)[i];
+                buffer.clear();
+                buffer.recordPackets( renderGroup, 
+                                      renderPass, 
+                                      renderQueue->begin() + (*bounds)[i], 
+                                      renderQueue->begin() + (*bounds)[i + 1] );
+            }
+        }
+    };
+
     sgl::RenderTarget* updatePPURenderTarget( sgl::RenderTarget*    old,
                                               sgl::Texture::FORMAT  format,
                                               unsigned              width,
@@ -209,6 +242,97 @@ void ForwardRenderer::light_params::setup_point(const scene::Camera& camera,
     }
 }
 
+ForwardRenderer::clustered_light_params::clustered_light_params(detail::ParameterTable& parameterTable, unsigned maxLightCount_) :
+    maxLightCount(maxLightCount_),
+    lightViewPositionRadius(new math::Vector4f[maxLightCount]),
+    lightColorIntensity(new math::Vector4f[maxLightCount])
+{
+    lightViewPositionRadiusBinder   = parameterTable.addParameterBinding( hash_string("clusteredLightViewPositionRadius"), lightViewPositionRadius.get(), maxLightCount, false);
+    lightColorIntensityBinder       = parameterTable.addParameterBinding( hash_string("clusteredLightColorIntensity"), lightColorIntensity.get(), maxLightCount, false);
+    gridScaleBiasBinder             = parameterTable.addParameterBinding( hash_string("lightGridScaleBias"), &gridScaleBias, 1, false);
+    gridDepthParamsBinder           = parameterTable.addParameterBinding( hash_string("lightGridDepthParams"), &gridDepthParams, 1, false);
+    gridMapSizeBinder               = parameterTable.addParameterBinding( hash_string("lightGridMapSize"), &gridMapSize, 1, false);
+    indexMapSizeBinder              = parameterTable.addParameterBinding( hash_string("lightIndexMapSize"), &indexMapSize, 1, false);
+    gridMapBinder                   = parameterTable.addParameterBinding<sgl::Texture2D>( hash_string("lightGridMap"), 0, 1, false);
+    indexMapBinder                  = parameterTable.addParameterBinding<sgl::Texture2D>( hash_string("lightIndexMap"), 0, 1, false);
+
+    sgl::SamplerState::DESC desc;
+    desc.filter[0]   = sgl::SamplerState::NEAREST;
+    desc.filter[1]   = sgl::SamplerState::NEAREST;
+    desc.filter[2]   = sgl::SamplerState::NONE;
+
+    desc.wrapping[0] = sgl::SamplerState::CLAMP;
+    desc.wrapping[1] = sgl::SamplerState::CLAMP;
+    if ( sgl::Device* device = currentDevice() ) {
+        samplerState.reset( device->CreateSamplerState(desc) );
+    }
+}
+
+void ForwardRenderer::clustered_light_params::setup_point(const scene::Camera& camera,
+                                                          light_const_iterator firstLight, 
+                                                          light_const_iterator endLight)
+{
+    size_t numLights = std::distance(firstLight, endLight);
+    for (size_t i = 0; firstLight != endLight; ++firstLight, ++i)
+    {
+        const scene::PointLight* light = static_cast<const scene::PointLight*>(*firstLight);
+        lightViewPositionRadiusBinder->write_value( math::make_vec( math::xyz(camera.getViewMatrix() * light->getPosition()), light->getRadius() ), i );
+
+        math::Vector4f colorIntensity = light->getColor();
+        colorIntensity.w              = light->getIntensity();
+        lightColorIntensityBinder->write_value(colorIntensity, i);
+    }
+
+    // bin lights
+    lightGrid.setProjection( camera.getProjectionMatrix() );
+    lightGrid.bin(lightViewPositionRadius.get(), numLights);
+
+    // cluster of the fragment is floor(gl_FragCoord.xy * scale + bias)
+    sgl::rectangle viewport = camera.getViewport();
+    math::Vector2f scale( float(LightGrid::cluster_x) / viewport.width, float(LightGrid::cluster_y) / viewport.height );
+    gridScaleBiasBinder->write_value( math::Vector4f(scale.x, scale.y, -viewport.x * scale.x, -viewport.y * scale.y) );
+    gridDepthParamsBinder->write_value( lightGrid.getDepthParams() );
+
+    // sgl can't update texture images, so maps are recreated every binning
+    sgl::Device* device = currentDevice();
+    if (!device) {
+        return; // headless renderer only bins lights
+    }
+
+    {
+        sgl::Texture2D::DESC desc;
+        desc.format = sgl::Texture::RGBA32F;
+        desc.width  = LightGrid::grid_map_width;
+        desc.height = LightGrid::cluster_y;
+        desc.data   = lightGrid.getGridMap();
+        gridMap.reset( device->CreateTexture2D(desc) );
+        if (!gridMap) {
+            throw gl_error(AUTO_LOGGER, "Can't create light grid map.");
+        }
+        gridMap->BindSamplerState( samplerState.get() );
+        gridMapSizeBinder->write_value( math::Vector4f(1.0f / desc.width, 1.0f / desc.height, float(desc.width), float(desc.height)) );
+        gridMapBinder->switch_values(gridMap.get(), 1, false);
+    }
+
+    {
+        sgl::Texture2D::DESC desc;
+        desc.format = sgl::Texture::RGBA32F;
+        desc.width  = LightGrid::index_map_width;
+        desc.height = lightGrid.getIndexMapHeight();
+        desc.data   = lightGrid.getIndexMap();
+        indexMap.reset( device->CreateTexture2D(desc) );
+        if (!indexMap) {
+            throw gl_error(AUTO_LOGGER, "Can't create light index map.");
+        }
+        indexMap->BindSamplerState( samplerState.get() );
+        indexMapSizeBinder->write_value( math::Vector4f(1.0f / desc.width, 1.0f / desc.height, float(desc.width), float(desc.height)) );
+        indexMapBinder->switch_values(indexMap.get(), 1, false);
+    }
+
+    // new maps may reuse addresses of the destroyed ones
+    currentStateTable().invalidateTextures();
+}
+
     /*
 void ForwardRenderer::light_params::setup(int numLights, const scene::SpotLight** lights)
 {
@@ -224,15 +348,28 @@ void ForwardRenderer::light_params::setup(int numLights, const scene::SpotLight*
 ForwardRenderer::ForwardRenderer(const ForwardRendererDesc& desc_) :
     desc(desc_),
     initialized(false),
+    headless(false),
     wireframe(false),
-    postProcessFormat(sgl::Texture::RGB8)
+    numLightingPasses(0),
+    numWorldTraversals(0),
+    cullTime(0.0),
+    recordTime(0.0),
+    postProcessFormat(sgl::Texture::RGB8),
+    cv(0, &frameArena),
+    viewsCv(0, &frameArena),
+    viewsWorld(0),
+    renderQueue(&frameArena),
+    commandBuffer(&frameArena)
 {
     init();
 }
 
 void ForwardRenderer::init()
 {
+    headless = (currentDevice() == 0);
+
     // create wireframe state
+    if (!headless)
     {
         sgl::RasterizerState::DESC desc;
         desc.cullMode = sgl::RasterizerState::NONE;
@@ -244,7 +381,10 @@ void ForwardRenderer::init()
     {
         detail::ParameterTable& parameterTable = detail::currentParameterTable();
         cameraParams.reset( new camera_params(parameterTable) );
-        lightParams.reset( new light_params(parameterTable, 3) );
+        lightParams.reset( new light_params(parameterTable, LightingEffect::MAX_NUM_LIGHTS) );
+        if (desc.useClusteredLighting) {
+            clusteredLightParams.reset( new clustered_light_params(parameterTable, LightingEffect::MAX_NUM_CLUSTERED_LIGHTS) );
+        }
 
 
         // create rest parameters
@@ -252,11 +392,88 @@ void ForwardRenderer::init()
         if (desc.makeDepthMap) {
             depthMapBinder = parameterTable.addParameterBinding<sgl::Texture2D>( hash_string("depthMap"), 0, 1, false);
         }
+
+        // world matrix of the currently rendered packet
+        worldMatrixBinder.reset( new binding_mat4x4f(0, 1, false) );
     }
 
+    // replay recorded commands using device, headless renderer only counts them
+    if (headless) {
+        commandExecutor.reset( new NullCommandExecutor );
+    }
+    else {
+        commandExecutor.reset( new SGLCommandExecutor( worldMatrixBinder.get() ) );
+    }
+
+    // compile programs of the previous sessions before effects request them
+    if (!headless)
+    {
+        filesystem::file_ptr manifest( filesystem::asFile( filesystem::currentFileSystemManager().getNode(shader_manifest) ) );
+        if (manifest) {
+            EffectShaderProgram::warmup(shader_manifest);
+        }
+    }
+
+    // cull small and hidden renderables
+    cv.setMinScreenArea(desc.minScreenArea);
+    viewsCv.setMinScreenArea(desc.minScreenArea);
+    if (desc.useOcclusionCulling) 
+    {
+        cv.setOcclusionBuffer(&occlusionBuffer);
+        viewsCv.setOcclusionBuffer(&occlusionBuffer); // only collects occluders of the views
+    }
+
+    // collect statistics per frame
+    preFrameConnection = currentGraphicsManager().connectFramePreRenderCallback( boost::bind(&ForwardRenderer::beginFrame, this) );
+
     initialized = true;
 }
 
+void ForwardRenderer::setCommandExecutor(CommandExecutor* executor)
+{
+    assert(executor);
+    commandExecutor.reset(executor);
+}
+
+void ForwardRenderer::beginFrame()
+{
+    frameStatistics.renderQueue         = renderQueue.getStatistics();
+    frameStatistics.numArenaAllocations = frameArena.num_allocations();
+    frameStatistics.numArenaBytes       = frameArena.num_allocated_bytes();
+    frameStatistics.numHeapAllocations  = frameArena.num_heap_allocations();
+    frameStatistics.states              = currentStateTable().getStatistics();
+    frameStatistics.occlusion           = occlusionBuffer.getStatistics();
+    occlusionBuffer.resetStatistics();
+    frameStatistics.numLightingPasses   = numLightingPasses;
+    frameStatistics.numWorldTraversals  = numWorldTraversals;
+    frameStatistics.cullTime            = cullTime;
+    frameStatistics.recordTime          = recordTime;
+    frameStatistics.commands            = commandExecutor->getStatistics();
+    frameStatistics.cameras.assign( cameraStatistics.begin(), cameraStatistics.end() );
+    numLightingPasses                   = 0;
+    numWorldTraversals                  = 0;
+    cullTime                            = 0.0;
+    recordTime                          = 0.0;
+    commandExecutor->resetStatistics();
+    cameraStatistics.clear();
+    if (clusteredLightParams)
+    {
+        frameStatistics.lightGrid = clusteredLightParams->light_grid().getStatistics();
+        clusteredLightParams->light_grid().resetStatistics();
+    }
+    currentStateTable().resetStatistics();
+    renderQueue.resetStatistics();
+
+    // containers must not reference arena memory after reset
+    cv.release();
+    viewsCv.release();
+    viewsWorld = 0;
+    renderQueue.release();
+    commandBuffer.release();
+    frameArena.reset();
+    frameArena.reset_statistics();
+}
+
 void ForwardRenderer::render(realm::World& world, const scene::Camera& camera) const
 {
     using namespace scene;
@@ -274,63 +491,33 @@ void ForwardRenderer::render(realm::World& world, const scene::Camera& camera) c
     if ( const scene::ReflectCamera* reflectCamera = dynamic_cast<const scene::ReflectCamera*>(&camera) )
     {
         renderGroup = RG_REFLECT;
-        reflectRT   = static_cast<sgl::Texture2D*>( reflectCamera->getRenderTarget()->ColorAttachment(0) );
+        if (!headless) {
+            reflectRT = static_cast<sgl::Texture2D*>( reflectCamera->getRenderTarget()->ColorAttachment(0) );
+        }
     }
 
     cameraParams->setup(camera);
     {
         // gather lights && frustum renderables
-        cv.clear();
-        cv.setCamera(&camera);
-        {
-            thread::lock_ptr lock = world.lockForReading();
-            world.visitVisible(camera.getFrustum(), cv);
-        }
+        cull(world, camera);
 
-        // partition lights by their types
-        std::vector<Light::LIGHT_TYPE> lightTypes;
-        {
-            light_iterator partitionIter = cv.beginLight();
-            for (size_t i = 0;
-                        i != Light::NUM_LIGHT_TYPES && partitionIter != cv.endLight();
-                        ++i)
-            {
-                Light::LIGHT_TYPE   lightType = Light::LIGHT_TYPE(i);
-                light_iterator      iter = std::partition( partitionIter, cv.endLight(), partition_by_type(lightType) );
-                if (iter != partitionIter)
-                {
-                    lightTypes.push_back(lightType);
-                    partitionIter = iter;
-                }
-            }
-        }
-
-        // choose render target
-        // update post process render target if needed
-        sgl::RenderTarget* renderTarget = camera.getRenderTarget();
-        if ( !renderTarget && !camera.getPostEffectChain().empty() )
-        {
-            sgl::rectangle viewport = camera.getViewport();
-            postProcessRenderTarget.reset( updatePPURenderTarget( postProcessRenderTarget.get(),
-                                                                  postProcessFormat,
-                                                                  viewport.width,
-                                                                  viewport.height,
-                                                                  true ) );
-            renderTarget = postProcessRenderTarget;
-        }
+        light_type_vector lightTypes( light_type_vector::allocator_type(&frameArena) );
+        partition_lights(lightTypes);
 
-        if (renderTarget && sgl::SGL_OK != renderTarget->Bind())
-        {
-            AUTO_LOGGER_MESSAGE(log::S_ERROR, "Can't bind cameras render target\n");
+        // choose render target, headless renderer has none
+        sgl::RenderTarget* renderTarget = 0;
+        if ( !headless && !bind_render_target(camera, renderTarget) ) {
             return;
         }
 
         // perform forward rendering
         sgl::Device* device = currentDevice();
         {
-            device->SetViewport( camera.getViewport() );
+            if (device) {
+                device->SetViewport( camera.getViewport() );
+            }
 
-            if (wireframe)
+            if (wireframe && device)
             {
                 device->PushState(sgl::State::RASTERIZER_STATE);
                 wireframeState->Bind();
@@ -371,45 +558,7 @@ void ForwardRenderer::render(realm::World& world, const scene::Camera& camera) c
                     device->Clear(true, clearDepth, false);
                 }
 
-                // render scene for each light source
-                light_const_iterator lightIter    = cv.beginLight();
-                light_const_iterator lightIterEnd = cv.beginLight();
-                size_t i = 0;
-                while ( lightIter != cv.endLight() ) 
-                {
-                    if ( lightIterEnd == cv.endLight()
-                         || std::distance(lightIter, lightIterEnd) == lightParams->max_light_count() 
-                         || (*lightIterEnd)->getLightType() != lightTypes[i] ) 
-                    {
-                        // setup params
-                        switch (lightTypes[i])
-                        {
-                        case scene::Light::DIRECTIONAL:
-                            lightParams->setup_directional(camera, lightIter, lightIterEnd);
-                            render_pass( renderGroup, RP_DIRECTIONAL_LIGHTING, cv.beginRenderable(), cv.endRenderable() );
-                            break;
-                                                
-                        case scene::Light::POINT:
-                            lightParams->setup_point(camera, lightIter, lightIterEnd);
-                            render_pass( renderGroup, RP_POINT_LIGHTING, cv.beginRenderable(), cv.endRenderable() );
-                            break;
-
-                        case scene::Light::SPOT:
-                            //lightParams->setup(lightIter, lightIterEnd);
-                            render_pass( renderGroup, RP_SPOT_LIGHTING, cv.beginRenderable(), cv.endRenderable() );
-                            break;
-
-                        default:
-                            assert(!"Unsupported light type");
-                        }
-
-                        lightIter = lightIterEnd;
-                        ++i;
-                    }
-                    else {
-                        ++lightIterEnd;
-                    }
-                }
+                render_lighting(renderGroup, camera, lightTypes);
             }
 
             // render non lightened objects
@@ -420,48 +569,216 @@ void ForwardRenderer::render(realm::World& world, const scene::Camera& camera) c
             }
         }
 
-        if (wireframe) {
+        if (wireframe && device) {
             device->PopState(sgl::State::RASTERIZER_STATE);
         }
 
-        // perform post effect chain
-        const post_process_filter_chain& postEffects = camera.getPostEffectChain();
-        if ( !postEffects.empty() )
+        // post processing emits post render signal while camera target is bound
+        if (headless) {
+            postRenderSignal(camera);
+        }
+        else {
+            post_process(camera, renderTarget);
+        }
+
+        if (reflectRT) {
+            reflectRT->GenerateMipmap();
+        }
+    }
+}
+
+void ForwardRenderer::cull_views(realm::World& world) const
+{
+    const scene::Camera* cameras[scene::CullVisitor::max_views];
+    unsigned             numCameras = 0;
+    for (GraphicsManager::camera_const_iterator iter  = currentGraphicsManager().firstCamera();
+                                                iter != currentGraphicsManager().endCamera() && numCameras < scene::CullVisitor::max_views;
+                                                ++iter)
+    {
+        cameras[numCameras++] = iter->get();
+    }
+
+    viewsCv.clear();
+    viewsCv.setCameras(cameras, numCameras);
+    {
+        thread::lock_ptr lock = world.lockForReading();
+        world.visitVisible(viewsCv);
+    }
+    viewsWorld = &world;
+    ++numWorldTraversals;
+}
+
+void ForwardRenderer::cull(realm::World& world, const scene::Camera& camera) const
+{
+    cullTimer.start();
+    if (desc.useMultiViewCulling && viewsWorld != &world) {
+        cull_views(world);
+    }
+
+    // pick the view of the camera, cameras not registered in the graphics manager are culled separately
+    unsigned view = 0;
+    while ( desc.useMultiViewCulling && view < viewsCv.getNumViews() && viewsCv.getViewCamera(view) != &camera ) {
+        ++view;
+    }
+
+    if ( desc.useMultiViewCulling && view < viewsCv.getNumViews() ) {
+        cv.gatherView(viewsCv, view);
+    }
+    else
+    {
+        cv.clear();
+        cv.setCamera(&camera);
         {
-            sgl::Texture2D* attachments[] =
-            {
-                static_cast<sgl::Texture2D*>( renderTarget->ColorAttachment(0) ),
-                static_cast<sgl::Texture2D*>( renderTarget->ColorAttachment(1) )
-            };
-
-            unsigned pingPongSource = 0;
-            for (post_process_filter_chain::const_iterator iter  = postEffects.begin();
-                                                           iter != postEffects.end();
-                                                           ++iter)
+            thread::lock_ptr lock = world.lockForReading();
+            world.visitVisible(camera.getFrustum(), cv);
+        }
+        ++numWorldTraversals;
+    }
+    cv.cullOccluded();
+    cullTime += cullTimer.getTime();
+
+    CAMERA_STATISTICS cameraStats;
+    cameraStats.camera  = &camera;
+    cameraStats.culling = cv.getStatistics();
+    cameraStatistics.push_back(cameraStats);
+}
+
+void ForwardRenderer::partition_lights(light_type_vector& lightTypes) const
+{
+    light_iterator partitionIter = cv.beginLight();
+    for (size_t i = 0;
+                i != scene::Light::NUM_LIGHT_TYPES && partitionIter != cv.endLight();
+                ++i)
+    {
+        scene::Light::LIGHT_TYPE lightType = scene::Light::LIGHT_TYPE(i);
+        light_iterator           iter = std::partition( partitionIter, cv.endLight(), partition_by_type(lightType) );
+        if (iter != partitionIter)
+        {
+            lightTypes.push_back(lightType);
+            partitionIter = iter;
+        }
+    }
+}
+
+bool ForwardRenderer::bind_render_target(const scene::Camera& camera, sgl::RenderTarget*& renderTarget) const
+{
+    // update post process render target if needed
+    renderTarget = camera.getRenderTarget();
+    if ( !renderTarget && !camera.getPostEffectChain().empty() )
+    {
+        sgl::rectangle viewport = camera.getViewport();
+        postProcessRenderTarget.reset( updatePPURenderTarget( postProcessRenderTarget.get(),
+                                                              postProcessFormat,
+                                                              viewport.width,
+                                                              viewport.height,
+                                                              true ) );
+        renderTarget = postProcessRenderTarget;
+    }
+
+    if (renderTarget && sgl::SGL_OK != renderTarget->Bind())
+    {
+        AUTO_LOGGER_MESSAGE(log::S_ERROR, "Can't bind cameras render target\n");
+        return false;
+    }
+
+    return true;
+}
+
+void ForwardRenderer::render_lighting(render_group_handle       renderGroup,
+                                      const scene::Camera&      camera,
+                                      const light_type_vector&  lightTypes) const
+{
+    // render scene for each light source
+    light_const_iterator lightIter    = cv.beginLight();
+    light_const_iterator lightIterEnd = cv.beginLight();
+    size_t i = 0;
+    while ( lightIter != cv.endLight() ) 
+    {
+        // clustered lighting shades many point lights per pass
+        int maxLightCount = lightParams->max_light_count();
+        if ( clusteredLightParams && lightTypes[i] == scene::Light::POINT ) {
+            maxLightCount = clusteredLightParams->max_light_count();
+        }
+
+        if ( lightIterEnd == cv.endLight()
+             || std::distance(lightIter, lightIterEnd) == maxLightCount 
+             || (*lightIterEnd)->getLightType() != lightTypes[i] ) 
+        {
+            ++numLightingPasses;
+            // setup params
+            switch (lightTypes[i])
             {
-                inputMapBinder->switch_values(attachments[pingPongSource], 1, false);
-                if (*iter == postEffects.back() && renderTarget == postProcessRenderTarget)
+            case scene::Light::DIRECTIONAL:
+                lightParams->setup_directional(camera, lightIter, lightIterEnd);
+                render_pass( renderGroup, RP_DIRECTIONAL_LIGHTING, cv.beginRenderable(), cv.endRenderable() );
+                break;
+                                    
+            case scene::Light::POINT:
+                if (clusteredLightParams)
                 {
-                    renderTarget->Unbind();
-                    (*iter)->perform(0, pingPongSource);
+                    clusteredLightParams->setup_point(camera, lightIter, lightIterEnd);
+                    render_pass( renderGroup, RP_CLUSTERED_LIGHTING, cv.beginRenderable(), cv.endRenderable() );
                 }
                 else
                 {
-                    unsigned numSwitches = (*iter)->perform(camera.getRenderTarget(), pingPongSource);
-                    pingPongSource       = (pingPongSource + numSwitches) % 2;
+                    lightParams->setup_point(camera, lightIter, lightIterEnd);
+                    render_pass( renderGroup, RP_POINT_LIGHTING, cv.beginRenderable(), cv.endRenderable() );
                 }
+                break;
+
+            case scene::Light::SPOT:
+                //lightParams->setup(lightIter, lightIterEnd);
+                render_pass( renderGroup, RP_SPOT_LIGHTING, cv.beginRenderable(), cv.endRenderable() );
+                break;
+
+            default:
+                assert(!"Unsupported light type");
             }
+
+            lightIter = lightIterEnd;
+            ++i;
+        }
+        else {
+            ++lightIterEnd;
         }
+    }
+}
 
-        postRenderSignal(camera);
+void ForwardRenderer::post_process(const scene::Camera& camera, sgl::RenderTarget* renderTarget) const
+{
+    // perform post effect chain
+    const post_process_filter_chain& postEffects = camera.getPostEffectChain();
+    if ( !postEffects.empty() )
+    {
+        sgl::Texture2D* attachments[] =
+        {
+            static_cast<sgl::Texture2D*>( renderTarget->ColorAttachment(0) ),
+            static_cast<sgl::Texture2D*>( renderTarget->ColorAttachment(1) )
+        };
 
-        if (device->CurrentRenderTarget() != 0) {
-            renderTarget->Unbind();
+        unsigned pingPongSource = 0;
+        for (post_process_filter_chain::const_iterator iter  = postEffects.begin();
+                                                       iter != postEffects.end();
+                                                       ++iter)
+        {
+            inputMapBinder->switch_values(attachments[pingPongSource], 1, false);
+            if (*iter == postEffects.back() && renderTarget == postProcessRenderTarget)
+            {
+                renderTarget->Unbind();
+                (*iter)->perform(0, pingPongSource);
+            }
+            else
+            {
+                unsigned numSwitches = (*iter)->perform(camera.getRenderTarget(), pingPongSource);
+                pingPongSource       = (pingPongSource + numSwitches) % 2;
+            }
         }
+    }
 
-        if (reflectRT) {
-            reflectRT->GenerateMipmap();
-        }
+    postRenderSignal(camera);
+
+    if (currentDevice()->CurrentRenderTarget() != 0) {
+        renderTarget->Unbind();
     }
 }
 
@@ -471,44 +788,74 @@ void ForwardRenderer::render_pass(render_group_handle        renderGroup,
                                   renderable_const_iterator  endRenderable) const
 {
     // gather packets
-    renderPackets.clear();
+    renderQueue.clear();
     graphics::Pass* passes[Effect::MAX_NUM_PASSES];
     for (renderable_const_iterator renderable  = firstRenderable; 
                                    renderable != endRenderable; 
                                    ++renderable)
     {
-        int numPasses = (*renderable)->getEffect()->present(renderGroup, renderPass, passes) ;
-        for (int i = 0; i<numPasses; ++i) {
-            renderPackets.push_back( render_packet(passes[i], *renderable) );
+        int   numPasses = (*renderable)->getEffect()->present(renderGroup, renderPass, passes);
+        float depth     = cv.getRenderableDepth(renderable);
+        for (int i = 0; i<numPasses; ++i) 
+        {
+            RenderQueue::key_type key = RenderQueue::makeKey(renderPass, passes[i]->getPriority(), passes[i], depth);
+            renderQueue.push( key, passes[i], *renderable, cv.getRenderableWorldMatrix(renderable) );
         }
     }
 
     // sort packets
-    std::sort( renderPackets.begin(), renderPackets.end(), sort_by_priority() );
+    renderQueue.sort();
 
-    // render packets
-    sgl::Device* device = currentDevice();
-    device->PushState(sgl::State::BLEND_STATE);
-    device->PushState(sgl::State::DEPTH_STENCIL_STATE);
-    device->PushState(sgl::State::RASTERIZER_STATE);
-    for (render_packet_iterator iter  = renderPackets.begin();
-                                iter != renderPackets.end();
-                                ++iter)
+    // record packets
+    recordTimer.start();
+    commandBuffer.clear();
+    commandBuffer.pushStates();
+    commandBuffer.invalidateTextures(); // filters and effects bind textures directly
+
+    size_t numPackets = renderQueue.size();
+    size_t numChunks  = numPackets / record_grain_size;
+    if (numChunks > 1)
+    {
+        recordBounds.resize(numChunks + 1);
+        for (size_t i = 0; i <= numChunks; ++i) {
+            recordBounds[i] = numPackets * i / numChunks;
+        }
+
+        if (recordBuffers.size() < numChunks) {
+            recordBuffers.resize(numChunks);
+        }
+
+        record_packets_task recordPackets = { &renderQueue, renderGroup, renderPass, &recordBounds, &recordBuffers };
+        parallel_for(0, numChunks, 1, recordPackets);
+        recordBuffers[numChunks - 1].popStates();
+    }
+    else
     {
-        iter->pass->begin();
-        iter->renderable->render();
-        iter->pass->end();
+        commandBuffer.recordPackets(renderGroup, renderPass, renderQueue.begin(), renderQueue.end());
+        commandBuffer.popStates();
+    }
+    recordTime += recordTimer.getTime();
+
+    // render packets
+    commandExecutor->execute(commandBuffer);
+    for (size_t i = 0; i<numChunks && numChunks > 1; ++i) {
+        commandExecutor->execute(recordBuffers[i]);
     }
-    device->PopState(sgl::State::BLEND_STATE);
-    device->PopState(sgl::State::DEPTH_STENCIL_STATE);
-    device->PopState(sgl::State::RASTERIZER_STATE);
+}
+
+bool ForwardRenderer::saveShaderManifest() const
+{
+    if (!initialized || headless) {
+        return false;
+    }
+
+    return EffectShaderProgram::updateManifest(shader_manifest);
 }
 
 long long ForwardRenderer::makePriority(RENDER_BIN bin, const void* programPtr)
 {
-    long long priority = (long)bin << (sizeof(long) / 8)
-                       | (long)programPtr;
-    return priority;
+    const long long programMask = (1LL << 56) - 1;
+    return ( (long long)bin << 56 ) | ( (long long)reinterpret_cast<size_t>(programPtr) & programMask );
 }
 
 } // namespace detail
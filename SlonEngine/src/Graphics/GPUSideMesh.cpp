@@ -215,6 +215,11 @@ void GPUSideMesh::deserialize(database::IArchive& ar)
 
 void GPUSideMesh::dirtyVertexLayout()
 {
+    // headless graphics manager has no device, mesh is only culled
+    if ( !currentDevice() ) {
+        return;
+    }
+
     // generate vertex layout
     std::vector<sgl::VertexLayout::ELEMENT> elements;
 
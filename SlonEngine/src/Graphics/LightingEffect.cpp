@@ -2,10 +2,12 @@
 #include "Database/Archive.h"
 #include "Graphics/Common.h"
 #include "Graphics/LightingEffect.h"
+#include "Graphics/DeferredRenderer.h"
 #include "Graphics/Detail/Pass.h"
 #include "Graphics/Detail/FFPPass.h"
 #include "Graphics/Detail/AttributeTable.h"
 #include "Graphics/Detail/ParameterTable.h"
+#include "Graphics/Detail/StateTable.h"
 #include "Graphics/FixedPipelineRenderer.h"
 #include "Graphics/ForwardRenderer.h"
 #include <boost/bind.hpp>
@@ -80,7 +82,19 @@ int LightingEffect::present(render_group_handle renderGroup, render_pass_handle
 
     int    numPasses = 0;
     size_t numLights = lightCountBinder->value();
-    if ( renderGroup == detail::ForwardRenderer::RG_REFLECT )
+    if ( gbufferPass && renderGroup == detail::ForwardRenderer::RG_MAIN )
+    {
+        // opaque objects are lit by the deferred renderer from the g-buffer
+        if ( renderPass == detail::DeferredRenderer::RP_GBUFFER )
+        {
+            p[0] = gbufferPass.get();
+            numPasses = 1;
+        }
+        else {
+            return TransformEffect::present(renderGroup, renderPass, p);
+        }
+    }
+    else if ( renderGroup == detail::ForwardRenderer::RG_REFLECT )
     {
         if (opacityBinder)
         {
@@ -102,6 +116,12 @@ int LightingEffect::present(render_group_handle renderGroup, render_pass_handle
                 p[1] = passes[scene::Light::SPOT][numLights].get();
                 numPasses = 2;
             }
+            else if ( renderPass == detail::ForwardRenderer::RP_CLUSTERED_LIGHTING && clusteredPass )
+            {
+                p[0] = clusteredBackFacePass.get();
+                p[1] = clusteredPass.get();
+                numPasses = 2;
+            }
         }
         else
         {
@@ -120,6 +140,11 @@ int LightingEffect::present(render_group_handle renderGroup, render_pass_handle
                 p[0] = backFacePasses[scene::Light::SPOT][numLights].get();
                 numPasses = 1;
             }
+            else if ( renderPass == detail::ForwardRenderer::RP_CLUSTERED_LIGHTING && clusteredPass )
+            {
+                p[0] = clusteredBackFacePass.get();
+                numPasses = 1;
+            }
             else {
                 return TransformEffect::present(renderGroup, renderPass, p);
             }
@@ -147,6 +172,12 @@ int LightingEffect::present(render_group_handle renderGroup, render_pass_handle
                 p[1] = backFacePasses[scene::Light::SPOT][numLights].get();
                 numPasses = 2;
             }
+            else if ( renderPass == detail::ForwardRenderer::RP_CLUSTERED_LIGHTING && clusteredPass )
+            {
+                p[0] = clusteredPass.get();
+                p[1] = clusteredBackFacePass.get();
+                numPasses = 2;
+            }
         }
         else
         {
@@ -165,6 +196,11 @@ int LightingEffect::present(render_group_handle renderGroup, render_pass_handle
                 p[0] = passes[scene::Light::SPOT][numLights].get();
                 numPasses = 1;
             }
+            else if ( renderPass == detail::ForwardRenderer::RP_CLUSTERED_LIGHTING && clusteredPass )
+            {
+                p[0] = clusteredPass.get();
+                numPasses = 1;
+            }
             else {
                 return TransformEffect::present(renderGroup, renderPass, p);
             }
@@ -216,10 +252,15 @@ void LightingEffect::dirty(const LightingMaterial* material_)
     material.reset(material_);
     for (int i = 0; i<scene::Light::NUM_LIGHT_TYPES; ++i)
     {
-        for (int j = MIN_NUM_LIGHTS; j < MAX_NUM_LIGHTS; ++j) {
+        for (int j = MIN_NUM_LIGHTS; j <= MAX_NUM_LIGHTS; ++j) 
+        {
             passes[i][j].reset();
+            backFacePasses[i][j].reset();
         }
     }
+    clusteredPass.reset();
+    clusteredBackFacePass.reset();
+    gbufferPass.reset();
 
     // create technique accordingly to renderer
     Renderer::RENDER_TECHNIQUE technique = currentRenderer()->getRenderTechnique();
@@ -228,6 +269,7 @@ void LightingEffect::dirty(const LightingMaterial* material_)
         switch (technique)
         {
             case Renderer::FORWARD_RENDERING:
+            case Renderer::DEFERRED_SHADING:
             {
                 using detail::ForwardRenderer;
 
@@ -280,13 +322,13 @@ void LightingEffect::dirty(const LightingMaterial* material_)
                 }
 
                 // create passes
-                EffectShaderProgram baseProgram(AUTO_LOGGER);
+                const char* vertexShader = "Data/Shaders/rigid.vert";
 				if (boneMatricesBinder || (boneRotationsBinder && boneTranslationsBinder)) {
-					baseProgram.addShader("Data/Shaders/skinned.vert");
-				}
-				else {
-					baseProgram.addShader("Data/Shaders/rigid.vert");
+					vertexShader = "Data/Shaders/skinned.vert";
 				}
+
+                EffectShaderProgram baseProgram(AUTO_LOGGER);
+                baseProgram.addShader(vertexShader);
                 baseProgram.addShader("Data/Shaders/Forward/normal.frag");
                 baseProgram.addShader("Data/Shaders/Forward/lighting.frag");
                 if (material->diffuseSpecularMap) {
@@ -314,7 +356,7 @@ void LightingEffect::dirty(const LightingMaterial* material_)
                         blendDesc.destBlendAlpha = sgl::BlendState::ONE;
                     }
                 }
-                desc.blendState = currentDevice()->CreateBlendState(blendDesc);
+                desc.blendState = detail::currentStateTable().createBlendState(blendDesc);
 
                 sgl::DepthStencilState::DESC dsDesc;
                 {
@@ -323,7 +365,7 @@ void LightingEffect::dirty(const LightingMaterial* material_)
                     dsDesc.stencilEnable  = false;
                     dsDesc.depthWriteMask = opacityBinder ? true : false;
                 }
-                desc.depthStencilState = currentDevice()->CreateDepthStencilState(dsDesc);
+                desc.depthStencilState = detail::currentStateTable().createDepthStencilState(dsDesc);
 
                 sgl::RasterizerState::DESC rastDesc;
                 {
@@ -331,7 +373,7 @@ void LightingEffect::dirty(const LightingMaterial* material_)
                     rastDesc.fillMode  = sgl::RasterizerState::SOLID;
                     rastDesc.colorMask = sgl::RasterizerState::RGBA;
                 }
-                desc.rasterizerState = currentDevice()->CreateRasterizerState(rastDesc);
+                desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
 
                 ForwardRenderer::RENDER_BIN frontPassBin = ForwardRenderer::OPAQUE_BIN;
                 ForwardRenderer::RENDER_BIN backPassBin  = ForwardRenderer::OPAQUE_BIN;
@@ -349,12 +391,12 @@ void LightingEffect::dirty(const LightingMaterial* material_)
                     desc.program = directionalProgram.getProgram();
 
                     rastDesc.cullMode    = sgl::RasterizerState::BACK;
-                    desc.rasterizerState = currentDevice()->CreateRasterizerState(rastDesc);
+                    desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
                     desc.priority        = ForwardRenderer::makePriority(frontPassBin, desc.program);
                     passes[scene::Light::DIRECTIONAL][i].reset( new detail::Pass(desc) );
 
                     rastDesc.cullMode    = sgl::RasterizerState::FRONT;
-                    desc.rasterizerState = currentDevice()->CreateRasterizerState(rastDesc);
+                    desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
                     desc.priority        = ForwardRenderer::makePriority(backPassBin, desc.program);
                     backFacePasses[scene::Light::DIRECTIONAL][i].reset( new detail::Pass(desc) );
 
@@ -364,16 +406,79 @@ void LightingEffect::dirty(const LightingMaterial* material_)
                     desc.program = pointProgram.getProgram();
 
                     rastDesc.cullMode    = sgl::RasterizerState::BACK;
-                    desc.rasterizerState = currentDevice()->CreateRasterizerState(rastDesc);
+                    desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
                     desc.priority        = ForwardRenderer::makePriority(frontPassBin, desc.program);
                     passes[scene::Light::POINT][i].reset( new detail::Pass(desc) );
 
                     rastDesc.cullMode    = sgl::RasterizerState::FRONT;
-                    desc.rasterizerState = currentDevice()->CreateRasterizerState(rastDesc);
+                    desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
                     desc.priority        = ForwardRenderer::makePriority(backPassBin, desc.program);
                     backFacePasses[scene::Light::POINT][i].reset( new detail::Pass(desc) );
                 }
 
+                // renderer bins point lights into the clusters
+                if ( detail::currentParameterTable().getParameterBinding( hash_string("lightGridMap") ) )
+                {
+                    detail::Pass::UNIFORM_DESC clusteredUniformDesc[20];
+                    std::copy(uniformDesc, uniformDesc + 14, clusteredUniformDesc);
+                    clusteredUniformDesc[1].parameterName  = "clusteredLightColorIntensity";
+                    clusteredUniformDesc[3].parameterName  = "clusteredLightViewPositionRadius";
+                    clusteredUniformDesc[14].uniformName   = "lightGridMap";
+                    clusteredUniformDesc[14].parameterName = "lightGridMap";
+                    clusteredUniformDesc[15].uniformName   = "lightIndexMap";
+                    clusteredUniformDesc[15].parameterName = "lightIndexMap";
+                    clusteredUniformDesc[16].uniformName   = "lightGridScaleBias";
+                    clusteredUniformDesc[16].parameterName = "lightGridScaleBias";
+                    clusteredUniformDesc[17].uniformName   = "lightGridDepthParams";
+                    clusteredUniformDesc[17].parameterName = "lightGridDepthParams";
+                    clusteredUniformDesc[18].uniformName   = "lightGridMapSize";
+                    clusteredUniformDesc[18].parameterName = "lightGridMapSize";
+                    clusteredUniformDesc[19].uniformName   = "lightIndexMapSize";
+                    clusteredUniformDesc[19].parameterName = "lightIndexMapSize";
+
+                    EffectShaderProgram clusteredProgram(baseProgram);
+                    clusteredProgram.addDefinition("#define CLUSTERED_LIGHTING");
+                    clusteredProgram.addDefinition("#define NUM_LIGHTS %d", MAX_NUM_CLUSTERED_LIGHTS);
+                    desc.program     = clusteredProgram.getProgram();
+                    desc.uniforms    = clusteredUniformDesc;
+                    desc.numUniforms = 20;
+
+                    rastDesc.cullMode    = sgl::RasterizerState::BACK;
+                    desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
+                    desc.priority        = ForwardRenderer::makePriority(frontPassBin, desc.program);
+                    clusteredPass.reset( new detail::Pass(desc) );
+
+                    rastDesc.cullMode    = sgl::RasterizerState::FRONT;
+                    desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
+                    desc.priority        = ForwardRenderer::makePriority(backPassBin, desc.program);
+                    clusteredBackFacePass.reset( new detail::Pass(desc) );
+                }
+
+                // opaque objects write material and normal into the g-buffer, transparent are lit by forward passes
+                if (technique == Renderer::DEFERRED_SHADING && !opacityBinder)
+                {
+                    EffectShaderProgram gbufferProgram(AUTO_LOGGER);
+                    gbufferProgram.addShader(vertexShader);
+                    gbufferProgram.addShader("Data/Shaders/Deferred/gbuffer.frag");
+                    if (material->diffuseSpecularMap) {
+                        gbufferProgram.addDefinition("#define ENABLE_DIFFUSE_SPECULAR_MAP");
+                    }
+                    desc.program     = gbufferProgram.getProgram();
+                    desc.uniforms    = uniformDesc;
+                    desc.numUniforms = 14;
+
+                    blendDesc.blendEnable = false;
+                    desc.blendState       = detail::currentStateTable().createBlendState(blendDesc);
+
+                    dsDesc.depthWriteMask  = true;
+                    desc.depthStencilState = detail::currentStateTable().createDepthStencilState(dsDesc);
+
+                    rastDesc.cullMode    = sgl::RasterizerState::BACK;
+                    desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
+                    desc.priority        = ForwardRenderer::makePriority(ForwardRenderer::OPAQUE_BIN, desc.program);
+                    gbufferPass.reset( new detail::Pass(desc) );
+                }
+
                 break; 
             }
 
@@ -390,9 +495,6 @@ void LightingEffect::dirty(const LightingMaterial* material_)
             break;
         }
 
-        case Renderer::DEFERRED_SHADING:
-            AUTO_LOGGER_MESSAGE(log::S_ERROR, "Deferred renderer is not supported by lighting effect." << std::endl);
-            break;
         }
     }
     catch(slon_error&)
@@ -0,0 +1,44 @@
+#include "stdafx.h"
+#include "Graphics/NullEffect.h"
+
+namespace slon {
+namespace graphics {
+
+NullEffect::NullEffect(unsigned renderPassMask_, long long priority)
+:   renderPassMask(renderPassMask_)
+,   pass( new NullPass(priority) )
+{
+}
+
+int NullEffect::present(render_group_handle /*renderGroup*/, render_pass_handle renderPass, Pass** passes)
+{
+    if ( renderPass < 32 && ( renderPassMask & (1 << renderPass) ) )
+    {
+        passes[0] = pass.get();
+        return 1;
+    }
+
+    return 0;
+}
+
+const abstract_parameter_binding* NullEffect::getParameter(hash_string name) const
+{
+    if ( name == hash_string("worldMatrix") ) {
+        return worldMatrixBinder.get();
+    }
+
+    return 0;
+}
+
+bool NullEffect::bindParameter(hash_string                        name,
+                               const abstract_parameter_binding*    binding)
+{
+    if ( name == hash_string("worldMatrix") && (worldMatrixBinder = cast_binding<math::Matrix4f>(binding)) ) {
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace graphics
+} // namespace slon
@@ -1,4 +1,5 @@
 #include "stdafx.h"
+#include "Engine.h"
 #include "Graphics/SkinnedMesh.h"
 #include "Scene/CullVisitor.h"
 #include "Scene/FilterVisitor.h"
@@ -157,6 +158,7 @@ namespace graphics {
 SkinnedMesh::SkinnedMesh(const DESC& desc)
 :	mesh(desc.mesh)
 ,	cpuSkinning(false)
+,	skinningFrame(~0u)
 ,	haveBindShapeBone(false)
 ,	bounds( mesh->getBounds() )
 ,	shadowCaster(true)
@@ -566,9 +568,17 @@ void SkinnedMesh::accept(scene::TransformVisitor& visitor)
 
 void SkinnedMesh::accept(scene::CullVisitor& visitor) const
 {
-    // perform CPU skinning
-	if (cpuSkinning)
+    if ( !visitor.isVisible(worldMatrix * getBounds()) ) {
+        return;
+    }
+
+    // perform CPU skinning once per frame, coarse detail levels are skinned every few frames
+    unsigned frame = Engine::Instance()->getFrameNumber();
+	if ( cpuSkinning 
+         && frame != skinningFrame
+         && (skinningFrame == ~0u || frame - skinningFrame >= visitor.getUpdateInterval()) )
     {
+        skinningFrame = frame;
         GPUSideMesh::buffer_lock lock = mesh->lockVertexBuffer(GPUSideMesh::LOCK_WRITE);
 
         if ( positionIter != mesh->endAttribute() )
@@ -618,11 +628,14 @@ void SkinnedMesh::accept(scene::CullVisitor& visitor) const
         }
     }
 
+    const math::AABBf& meshBounds = getBounds();
+    math::Vector3f     center     = math::xyz( worldMatrix * math::make_vec( (meshBounds.minVec + meshBounds.maxVec) * 0.5f, 1.0f ) );
+    float              depth      = visitor.getViewDepth(center);
     for( GPUSideMesh::subset_const_iterator subsetIter  = mesh->firstSubset();
                                      subsetIter != mesh->endSubset();
                                      ++subsetIter )
     {
-        visitor.addRenderable( subsetIter->get() );
+        visitor.addRenderable( subsetIter->get(), depth );
     }
 }
 
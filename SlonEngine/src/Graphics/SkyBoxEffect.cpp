@@ -32,6 +32,7 @@ void SkyBoxEffect::dirtyShaderTechniques()
         switch (renderTechnique)
         {
             case Renderer::FORWARD_RENDERING:
+            case Renderer::DEFERRED_SHADING:
             {
                 using detail::ForwardRenderer;
 
@@ -78,11 +79,6 @@ void SkyBoxEffect::dirtyShaderTechniques()
 
                 break;
             }
-
-            case Renderer::DEFERRED_SHADING:
-                pass.reset();
-                AUTO_LOGGER_MESSAGE(log::S_ERROR, "Deferred renderer is not supported by sky box effect." << std::endl);
-                break;
         }
     }
     catch(...)
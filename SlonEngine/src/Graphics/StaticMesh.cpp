@@ -8,14 +8,16 @@
 namespace slon {
 namespace graphics {
 
-StaticMesh::StaticMesh()
+StaticMesh::StaticMesh() :
+    occluder(false)
 {
 }
 
 StaticMesh::StaticMesh(const gpu_side_mesh_ptr& _mesh) :
 	mesh(_mesh),
 	shadowCaster(true),
-	shadowReceiver(true)
+	shadowReceiver(true),
+    occluder(false)
 {
     assert(mesh);
 
@@ -56,11 +58,27 @@ void StaticMesh::deserialize(database::IArchive& ar)
 // Override node
 void StaticMesh::accept(scene::CullVisitor& visitor) const
 {
+    const math::AABBf& bounds      = mesh->getBounds();
+    math::AABBf        worldBounds = worldMatrix * bounds;
+    if ( !visitor.isVisible(worldBounds) ) {
+        return;
+    }
+
+    math::Vector3f     center = math::xyz( worldMatrix * math::make_vec( (bounds.minVec + bounds.maxVec) * 0.5f, 1.0f ) );
+    float              depth  = visitor.getViewDepth(center);
+
+    // occluder is never occluded, rasterize transformed box, world bounds may cover more
+    if (occluder)
+    {
+        visitor.addOccluder(bounds, &worldMatrix);
+        worldBounds = slon::bounds<math::AABBf>::inv_infinite();
+    }
+
     for( GPUSideMesh::subset_const_iterator subsetIter  = mesh->firstSubset();
                                      subsetIter != mesh->endSubset();
                                      ++subsetIter )
     {
-        visitor.addRenderable( subsetIter->get() );
+        visitor.addRenderable( subsetIter->get(), depth, &worldMatrix, worldBounds );
     }
 }
 
@@ -3,6 +3,7 @@
 #include "Graphics/TransformEffect.h"
 #include "Graphics/Detail/ParameterTable.h"
 #include "Graphics/Detail/Pass.h"
+#include "Graphics/Detail/StateTable.h"
 #include "Graphics/ForwardRenderer.h"
 
 DECLARE_AUTO_LOGGER("graphics.TransformEffect")
@@ -76,7 +77,7 @@ void TransformEffect::dirty()
             dsDesc.stencilEnable  = false;
             dsDesc.depthWriteMask = true;
         }
-        desc.depthStencilState = currentDevice()->CreateDepthStencilState(dsDesc);
+        desc.depthStencilState = detail::currentStateTable().createDepthStencilState(dsDesc);
         
         sgl::RasterizerState::DESC rastDesc;
         {
@@ -84,7 +85,7 @@ void TransformEffect::dirty()
             rastDesc.fillMode  = sgl::RasterizerState::SOLID;
             rastDesc.colorMask = 0;
         }
-        desc.rasterizerState = currentDevice()->CreateRasterizerState(rastDesc);
+        desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
 
         depthPass.reset( new detail::Pass(desc) );
 
@@ -94,7 +95,7 @@ void TransformEffect::dirty()
             rastDesc.fillMode  = sgl::RasterizerState::SOLID;
             rastDesc.colorMask = 0;
         }
-        desc.rasterizerState = currentDevice()->CreateRasterizerState(rastDesc);
+        desc.rasterizerState = detail::currentStateTable().createRasterizerState(rastDesc);
         
         backFaceDepthPass.reset( new detail::Pass(desc) );
 		
@@ -313,6 +313,7 @@ void WaterEffect::dirtyShaderTechniques()
         switch (technique)
         {
             case Renderer::FORWARD_RENDERING:
+            case Renderer::DEFERRED_SHADING:
             {
                 using detail::ForwardRenderer;
 
@@ -396,10 +397,6 @@ void WaterEffect::dirtyShaderTechniques()
         case Renderer::FIXED_PIPELINE:
             AUTO_LOGGER_MESSAGE(log::S_ERROR, "Fixed pipeline renderer is not supported by water effect." << std::endl);
             break;
-
-        case Renderer::DEFERRED_SHADING:
-            AUTO_LOGGER_MESSAGE(log::S_ERROR, "Deferred renderer is not supported by water effect." << std::endl);
-            break;
         }
     }
     catch(slon_error&)
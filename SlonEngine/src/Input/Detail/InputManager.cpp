@@ -100,12 +100,21 @@ void InputManager::handleEvent(const SDL_Event* event)
         inputEvent.reset( createMouseButtonEvent(*event) );
         break;
 
+    case SDL_QUIT:
+        // window close
+        Engine::Instance()->stop();
+        break;
+
     default:
         break;
     }
 
     if (inputEvent)
     {
+        if (recorder) {
+            recorder->recordEvent(*inputEvent);
+        }
+
         for(size_t i = 0; i<inputHandlers.size(); ++i) {
             inputHandlers[i]->handleEvent(*inputEvent);
         }
@@ -115,8 +124,40 @@ void InputManager::handleEvent(const SDL_Event* event)
 void InputManager::handleEvents()
 {
     SDL_Event event;
-    while( SDL_PollEvent(&event) && Engine::Instance()->isRunning() ) {
-        handleEvent(&event);
+    if (player)
+    {
+        // drop user input, handlers receive recorded events only. Quit and window events
+        // are still dispatched, otherwise the window can't be closed during replay.
+        while( SDL_PollEvent(&event) && Engine::Instance()->isRunning() )
+        {
+            switch (event.type)
+            {
+            case SDL_KEYUP:
+            case SDL_KEYDOWN:
+            case SDL_MOUSEMOTION:
+            case SDL_MOUSEBUTTONUP:
+            case SDL_MOUSEBUTTONDOWN:
+                break;
+
+            default:
+                handleEvent(&event);
+                break;
+            }
+        }
+
+        for (size_t i = 0; i<replayEvents.size(); ++i)
+        {
+            for(size_t j = 0; j<inputHandlers.size(); ++j) {
+                inputHandlers[j]->handleEvent(*replayEvents[i]);
+            }
+        }
+        replayEvents.clear();
+    }
+    else
+    {
+        while( SDL_PollEvent(&event) && Engine::Instance()->isRunning() ) {
+            handleEvent(&event);
+        }
     }
 
     for(size_t i = 0; i<inputHandlers.size(); ++i) {
@@ -124,6 +165,37 @@ void InputManager::handleEvents()
     }
 }
 
+void InputManager::beginRecord(const std::string& fileName)
+{
+    player.reset();
+    recorder.reset( new InputRecorder(fileName) );
+}
+
+void InputManager::beginReplay(const std::string& fileName)
+{
+    recorder.reset();
+    player.reset( new InputPlayer(fileName) );
+}
+
+void InputManager::endRecord()
+{
+    recorder.reset();
+    player.reset();
+    replayEvents.clear();
+}
+
+bool InputManager::nextRecordFrame(double& time)
+{
+    if (player) {
+        return player->nextFrame(time, replayEvents);
+    }
+    else if (recorder) {
+        recorder->beginFrame(time);
+    }
+
+    return true;
+}
+
 void InputManager::setCursorPosition(unsigned int x, unsigned int y, bool generateEvent)
 {
     SDL_WarpMouse(x, y);
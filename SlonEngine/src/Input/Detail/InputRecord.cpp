@@ -0,0 +1,191 @@
+#include "stdafx.h"
+#include "Input/Detail/InputRecord.h"
+#include "Utility/error.hpp"
+#include <cstring>
+
+DECLARE_AUTO_LOGGER("input.InputRecord")
+
+namespace {
+
+    const char          recordSignature[4] = {'S', 'I', 'R', 'C'};
+    const unsigned int  recordVersion      = 1;
+
+    struct frame_header
+    {
+        double          time;
+        unsigned int    numEvents;
+    };
+
+} // anonymous namespace
+
+namespace slon {
+namespace input {
+namespace detail {
+
+InputRecorder::InputRecorder(const std::string& fileName)
+:   file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc)
+,   frameTime(0.0)
+,   frameStarted(false)
+,   numFrames(0)
+{
+    if ( !file.is_open() ) {
+        throw slon_error(AUTO_LOGGER, "Can't open input record file: " + fileName);
+    }
+
+    file.write( recordSignature, sizeof(recordSignature) );
+    file.write( reinterpret_cast<const char*>(&recordVersion), sizeof(recordVersion) );
+}
+
+InputRecorder::~InputRecorder()
+{
+    flush();
+}
+
+void InputRecorder::beginFrame(double time)
+{
+    flush();
+    frameTime    = time;
+    frameStarted = true;
+}
+
+void InputRecorder::recordEvent(const InputEvent& event)
+{
+    recorded_event recorded;
+    std::memset( &recorded, 0, sizeof(recorded) );
+
+    if ( const KeyboardEvent* keyboardEvent = event.asKeyboardEvent() )
+    {
+        recorded.type     = recorded_event::KEYBOARD;
+        recorded.state    = (unsigned char)keyboardEvent->state;
+        recorded.code     = (unsigned short)keyboardEvent->key;
+        recorded.modifier = (unsigned short)keyboardEvent->modifier;
+    }
+    else if ( const MouseEvent* mouseEvent = event.asMouseEvent() )
+    {
+        recorded.type  = recorded_event::MOUSE;
+        recorded.state = (unsigned char)mouseEvent->buttonState;
+        recorded.code  = (unsigned short)mouseEvent->button;
+        recorded.x     = (short)mouseEvent->x;
+        recorded.y     = (short)mouseEvent->y;
+        recorded.xrel  = (short)mouseEvent->xrel;
+        recorded.yrel  = (short)mouseEvent->yrel;
+    }
+    else {
+        return;
+    }
+
+    events.push_back(recorded);
+}
+
+void InputRecorder::flush()
+{
+    if (!frameStarted) {
+        return;
+    }
+
+    frame_header header;
+    header.time      = frameTime;
+    header.numEvents = (unsigned int)events.size();
+    file.write( reinterpret_cast<const char*>(&header.time), sizeof(header.time) );
+    file.write( reinterpret_cast<const char*>(&header.numEvents), sizeof(header.numEvents) );
+    if ( !events.empty() ) {
+        file.write( reinterpret_cast<const char*>(&events[0]), events.size() * sizeof(recorded_event) );
+    }
+
+    events.clear();
+    frameStarted = false;
+    ++numFrames;
+}
+
+InputPlayer::InputPlayer(const std::string& fileName)
+:   position(0)
+,   numFrames(0)
+{
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if ( !file.is_open() ) {
+        throw slon_error(AUTO_LOGGER, "Can't open input record file: " + fileName);
+    }
+
+    file.seekg(0, std::ios::end);
+    data.resize( size_t(file.tellg()) );
+    file.seekg(0, std::ios::beg);
+    if ( !data.empty() ) {
+        file.read( &data[0], data.size() );
+    }
+
+    unsigned int version = 0;
+    if ( data.size() < sizeof(recordSignature) + sizeof(version)
+         || std::memcmp(&data[0], recordSignature, sizeof(recordSignature)) != 0 )
+    {
+        throw slon_error(AUTO_LOGGER, "File is not an input record: " + fileName);
+    }
+
+    std::memcpy( &version, &data[sizeof(recordSignature)], sizeof(version) );
+    if (version != recordVersion) {
+        throw slon_error(AUTO_LOGGER, "Unsupported input record version: " + fileName);
+    }
+    position = sizeof(recordSignature) + sizeof(version);
+}
+
+bool InputPlayer::nextFrame(double& time, input_event_vector& frameEvents)
+{
+    frameEvents.clear();
+
+    frame_header header;
+    if ( position + sizeof(header.time) + sizeof(header.numEvents) > data.size() ) {
+        return false;
+    }
+    std::memcpy( &header.time, &data[position], sizeof(header.time) );
+    position += sizeof(header.time);
+    std::memcpy( &header.numEvents, &data[position], sizeof(header.numEvents) );
+    position += sizeof(header.numEvents);
+
+    if ( position + header.numEvents * sizeof(recorded_event) > data.size() ) 
+    {
+        position = data.size();
+        return false;
+    }
+
+    // storage doesn't reallocate while the frame is filled, so event pointers stay valid
+    keyboardEvents.clear();
+    mouseEvents.clear();
+    keyboardEvents.reserve(header.numEvents);
+    mouseEvents.reserve(header.numEvents);
+    frameEvents.reserve(header.numEvents);
+    for (unsigned int i = 0; i<header.numEvents; ++i)
+    {
+        recorded_event recorded;
+        std::memcpy( &recorded, &data[position], sizeof(recorded) );
+        position += sizeof(recorded);
+
+        if (recorded.type == recorded_event::KEYBOARD)
+        {
+            keyboardEvents.push_back( KeyboardEvent() );
+            KeyboardEvent& keyboardEvent = keyboardEvents.back();
+            keyboardEvent.state    = KeyboardEvent::key_state(recorded.state);
+            keyboardEvent.key      = key_sym(recorded.code);
+            keyboardEvent.modifier = key_modifier(recorded.modifier);
+            frameEvents.push_back(&keyboardEvent);
+        }
+        else
+        {
+            mouseEvents.push_back( MouseEvent() );
+            MouseEvent& mouseEvent = mouseEvents.back();
+            mouseEvent.button      = mouse_button(recorded.code);
+            mouseEvent.buttonState = MouseEvent::button_state(recorded.state);
+            mouseEvent.x           = recorded.x;
+            mouseEvent.y           = recorded.y;
+            mouseEvent.xrel        = recorded.xrel;
+            mouseEvent.yrel        = recorded.yrel;
+            frameEvents.push_back(&mouseEvent);
+        }
+    }
+
+    time = header.time;
+    ++numFrames;
+    return true;
+}
+
+} // namespace detail
+} // namespace input
+} // namespace slon
@@ -1,7 +1,10 @@
 #include "stdafx.h"
 #define _DEBUG_NEW_REDEFINE_NEW 0
 #include "Physics/Detail/PhysicsManager.h"
+#include "Thread/ThreadManager.h"
+#include "Thread/ThreadPool.h"
 #include "Thread/Utility.h"
+#include <boost/bind.hpp>
 #include <boost/thread/locks.hpp>
 
 #ifdef SLON_ENGINE_USE_BULLET
@@ -18,6 +21,12 @@ typedef BulletDynamicsWorld DynamicsWorldImpl;
 
 PhysicsManager::PhysicsManager()
 :   unsimulatedTime(0)
+,   parallelStepping(false)
+,   fixedRate(false)
+,   lastStepTime(0.0)
+,   lastStepInterval(0)
+,   stepCount(0)
+,   accessMutex("physics.PhysicsManager")
 {
 }
 
@@ -31,22 +40,107 @@ void PhysicsManager::removeDynamicsWorld(const dynamics_world_ptr& world)
     worlds.remove(world);
 }
 
-void PhysicsManager::handlePhysics()
+void PhysicsManager::stepWorld(size_t i, real dt, bool force)
 {
-    preFrameSignal();
-    if (timer)
+    steppedWorlds[i]->stepSimulation(dt, force);
+}
+
+void PhysicsManager::stepWorlds(real dt, bool force)
+{
+    if ( parallelStepping && worlds.size() > 1 )
+    {
+        steppedWorlds.assign( worlds.begin(), worlds.end() );
+        thread::currentThreadManager().getThreadPool().run( steppedWorlds.size(), 
+                                                            boost::bind(&PhysicsManager::stepWorld, this, _1, dt, force) );
+        steppedWorlds.clear();
+    }
+    else
     {
-        //thread::lock_ptr lock = dynamicsWorld->lockForWriting();
         for (dynamics_world_iterator it  = firstDynamicsWorld();
             it != endDynamicsWorld();
             ++it)
         {
-            (*it)->stepSimulation( (real)deltaTimer() );
+            (*it)->stepSimulation(dt, force);
+        }
+    }
+}
+
+size_t PhysicsManager::getNumSimulatedSteps() const
+{
+    size_t numSteps = 0;
+    for (dynamics_world_list::const_iterator it  = worlds.begin();
+                                             it != worlds.end();
+                                             ++it)
+    {
+        numSteps += (*it)->getNumSimulatedSteps();
+    }
+
+    return numSteps;
+}
+
+void PhysicsManager::handlePhysics()
+{
+    preFrameSignal();
+    if (timer)
+    {
+        // every world simulates same interval, worlds accumulate time shorter than their sub step
+        size_t numSteps = getNumSimulatedSteps();
+        stepWorlds( (real)deltaTimer(), false );
+
+        boost::lock_guard<boost::mutex> lock(stepMutex);
+        fixedRate = false;
+        if (getNumSimulatedSteps() != numSteps) {
+            ++stepCount;
+        }
+    }
+    postFrameSignal();
+}
+
+void PhysicsManager::stepSimulation(real dt)
+{
+    preFrameSignal();
+    if (timer)
+    {
+        // step is already fixed, world sub steps of other length would leave time unsimulated
+        size_t numSteps = getNumSimulatedSteps();
+        stepWorlds(dt, true);
+
+        // publish step, render thread will interpolate from here
+        boost::lock_guard<boost::mutex> lock(stepMutex);
+        lastStepInterval = dt;
+        lastStepTime     = timer->getTime();
+        fixedRate        = true;
+        if (getNumSimulatedSteps() != numSteps) {
+            ++stepCount;
         }
     }
     postFrameSignal();
 }
 
+real PhysicsManager::getInterpolationFactor() const
+{
+    unsigned stepCount;
+    return getInterpolationFactor(stepCount);
+}
+
+real PhysicsManager::getInterpolationFactor(unsigned& stepCount_) const
+{
+    boost::lock_guard<boost::mutex> lock(stepMutex);
+    stepCount_ = stepCount;
+    if (!fixedRate || !timer || lastStepInterval <= real(0)) {
+        return real(1);
+    }
+
+    real factor = real( (timer->getTime() - lastStepTime) / lastStepInterval );
+    return std::min(std::max(factor, real(0)), real(1));
+}
+
+unsigned PhysicsManager::getStepCount() const
+{
+    boost::lock_guard<boost::mutex> lock(stepMutex);
+    return stepCount;
+}
+
 void PhysicsManager::setTimer(const const_timer_ptr& timer_)
 {
     timer = timer_;
@@ -57,12 +151,12 @@ void PhysicsManager::setTimer(const const_timer_ptr& timer_)
 
 thread::lock_ptr PhysicsManager::lockForReading() const
 {
-    return thread::create_lock( new boost::shared_lock<boost::shared_mutex>(accessMutex) );
+    return thread::create_lock( new boost::shared_lock< thread::instrumented_mutex<boost::shared_mutex> >(accessMutex) );
 }
 
 thread::lock_ptr PhysicsManager::lockForWriting()
 {
-    return thread::create_lock( new boost::unique_lock<boost::shared_mutex>(accessMutex) );
+    return thread::create_lock( new boost::unique_lock< thread::instrumented_mutex<boost::shared_mutex> >(accessMutex) );
 }
 
 } // namespace detail
@@ -4,15 +4,22 @@
 #include "Log/LogVisitor.h"
 #include "Physics/RigidBody.h"
 #include "Physics/DynamicsWorld.h"
+#include "Physics/PhysicsManager.h"
 #include "Physics/PhysicsTransform.h"
 #include "Realm/Location.h"
 #include "Utility/functor_slot.hpp"
+#include <sgl/Math/Quaternion.hpp>
 
 namespace slon {
 namespace physics {
 
 PhysicsTransform::PhysicsTransform(const collision_object_ptr& collisionObject_) :
-    absolute(false)
+    absolute(false),
+    stateStamp(0),
+    stateStep(0),
+    resting(true),
+    interpolatedStamp(0),
+    interpolationFactor(1)
 {
     setCollisionObject(collisionObject_);
 }
@@ -52,6 +59,59 @@ const math::Matrix4f& PhysicsTransform::getInverseTransform() const
 	return invTransform;
 }
 
+unsigned int PhysicsTransform::getModifiedCount() const
+{
+    interpolateTransform();
+    return modifiedCount;
+}
+
+void PhysicsTransform::interpolateTransform() const
+{
+    unsigned step;
+    real     factor = currentPhysicsManager().getInterpolationFactor(step);
+    {
+        boost::lock_guard<boost::mutex> lock(stateMutex);
+
+        // last step published no state, object doesn't move anymore
+        if ( !resting && int(step - stateStep) > 0 ) 
+        {
+            states[0] = states[1];
+            resting   = true;
+        }
+
+        if (resting) {
+            factor = real(1);
+        }
+
+        if (interpolatedStamp == stateStamp && interpolationFactor == factor) {
+            return;
+        }
+
+        if ( factor < real(1) )
+        {
+            math::Quaternionf rotation    = math::slerp( math::from_matrix( math::get_rotation(states[0]) ), 
+                                                         math::from_matrix( math::get_rotation(states[1]) ), 
+                                                         float(factor) );
+            math::Vector3f    translation = math::lerp( math::get_translation(states[0]), 
+                                                        math::get_translation(states[1]), 
+                                                        float(factor) );
+            transform = math::RigidTransformf( math::to_matrix_4x4(rotation, translation), -1.0f );
+        }
+        else {
+            transform = states[1];
+        }
+
+        interpolatedStamp   = stateStamp;
+        interpolationFactor = factor;
+    }
+    ++const_cast<PhysicsTransform*>(this)->modifiedCount;
+
+    // keep interpolating in the next frames until current state is reached
+    if ( factor < real(1) ) {
+        const_cast<PhysicsTransform*>(this)->doUpdate(false);
+    }
+}
+
 void PhysicsTransform::setCollisionObject(const collision_object_ptr& collisionObject_)
 {
     collisionObject = collisionObject_;
@@ -60,6 +120,11 @@ void PhysicsTransform::setCollisionObject(const collision_object_ptr& collisionO
         transformConnection.reset( collisionObject->getTransformSignal(), 
                                    make_slot<void (const math::RigidTransformr&)>(boost::bind(&PhysicsTransform::setWorldTransform, this, _1)) );
         transform = collisionObject->getTransform();
+        
+        boost::lock_guard<boost::mutex> lock(stateMutex);
+        states[0] = states[1] = transform;
+        interpolatedStamp     = ++stateStamp;
+        resting               = true;
     }
     else {
         transformConnection.reset();
@@ -68,14 +133,23 @@ void PhysicsTransform::setCollisionObject(const collision_object_ptr& collisionO
 
 void PhysicsTransform::setWorldTransform(const math::RigidTransformr& transform_)
 {
+    // may be called from the physics thread, only publish state here,
+    // state belongs to the step in progress
+    unsigned step = currentPhysicsManager().getStepCount() + 1;
+    {
+        boost::lock_guard<boost::mutex> lock(stateMutex);
+        states[0] = states[1];
 #ifdef SLON_ENGINE_USE_DOUBLE_PRECISION_PHYSICS
-    // copy if using double precision physics
-    transform = math::RigidTransformf(transform_);
+        // copy if using double precision physics
+        states[1] = math::RigidTransformf(transform_);
 #else
-    transform = transform_;
+        states[1] = transform_;
 #endif
-    ++modifiedCount;
-    update(false);
+        stateStep = step;
+        resting   = false;
+        ++stateStamp;
+    }
+    doUpdate(false);
 }
 
 void PhysicsTransform::accept(log::LogVisitor& visitor) const
@@ -4,8 +4,11 @@
 #include "Physics/DynamicsWorld.h"
 #include "Realm/BVHLocation.h"
 #include "Realm/World.h"
+#include "Scene/Camera.h"
+#include "Scene/CullVisitor.h"
 #include "Scene/TransformVisitor.h"
 #include "Utility/math.hpp"
+#include <boost/thread/locks.hpp>
 
 namespace {
 
@@ -106,6 +109,23 @@ private:
 	Visitor&  visitor;
 };
 
+class visit_masked_node_functor
+{
+public:
+	visit_masked_node_functor(scene::CullVisitor& cv_)
+	:	cv(cv_)
+	{}
+
+	bool operator () (const bvh_location_node_ptr& node, unsigned viewMask) 
+	{ 
+		cv.traverse(*node->getChild(), viewMask); 
+		return false;
+	}
+
+private:
+	scene::CullVisitor& cv;
+};
+
 struct write_object
 {
     void operator () (database::OArchive& ar, const bvh_location_node_ptr& obj)
@@ -129,8 +149,8 @@ LocationVisitor<Location, Visitor> makeLocationVisitor(Location& location, Visit
 }
 
 BVHLocation::BVHLocation()
+:   accessMutex("realm.BVHLocation")
 {
-    eventVisitor.setLocation(this);
 }
 
 BVHLocation::~BVHLocation()
@@ -204,6 +224,19 @@ void BVHLocation::visitVisible(const math::Frustumf& frustum, scene::ConstVisito
     DEBUG_VISIT_TREE(debugMesh, nv);
 }
 
+void BVHLocation::visitVisible(scene::CullVisitor& cv, unsigned viewMask) const
+{
+    // node is tested only against the views seeing its parent
+    const math::Frustumf* frustums[scene::CullVisitor::max_views];
+    for (unsigned i = 0; i<cv.getNumViews(); ++i) {
+        frustums[i] = &cv.getViewCamera(i)->getFrustum();
+    }
+
+    perform_on_leaves(staticAABBTree, frustums, cv.getNumViews(), visit_masked_node_functor(cv), viewMask);
+    perform_on_leaves(dynamicAABBTree, frustums, cv.getNumViews(), visit_masked_node_functor(cv), viewMask);
+    DEBUG_VISIT_TREE(debugMesh, cv);
+}
+
 void BVHLocation::update(const scene::node_ptr& node)
 {
     BVHLocationNode* locNode = static_cast<BVHLocationNode*>( node->getParent() );
@@ -239,17 +272,21 @@ void BVHLocation::add(const scene::node_ptr& node, bool dynamic, bool activatePh
 
     // recompute aabb
     scene::TransformVisitor visitor(*node);
-    if (dynamic) {
-        locNode->setBVHIterator( dynamicAABBTree.insert(visitor.getBounds(), locNode) );
-    }
-    else {
-        locNode->setBVHIterator( staticAABBTree.insert(visitor.getBounds(), locNode) );
-    }
+    {
+        boost::unique_lock<mutex_type> lock(accessMutex);
+        if (dynamic) {
+            locNode->setBVHIterator( dynamicAABBTree.insert(visitor.getBounds(), locNode) );
+        }
+        else {
+            locNode->setBVHIterator( staticAABBTree.insert(visitor.getBounds(), locNode) );
+        }
 
-    aabb = math::merge( staticAABBTree.get_bounds(), dynamicAABBTree.get_bounds() );
-    DEBUG_UPDATE_TREE(debugMesh, aabb, staticAABBTree, dynamicAABBTree)
+        aabb = math::merge( staticAABBTree.get_bounds(), dynamicAABBTree.get_bounds() );
+        DEBUG_UPDATE_TREE(debugMesh, aabb, staticAABBTree, dynamicAABBTree)
+    }
 
-    eventVisitor.setType(EventVisitor::WORLD_ADD);
+    // nodes may update immediately and lock location for writing, so notify them unlocked
+    EventVisitor eventVisitor(EventVisitor::WORLD_ADD, this);
     eventVisitor.setPhysicsToggle(activatePhysics);
     eventVisitor.traverse(*node);
 }
@@ -258,23 +295,27 @@ bool BVHLocation::remove(const scene::node_ptr& node, bool deactivatePhysics)
 {
 	assert(node);
 
-    bvh_location_node_ptr locNode = static_cast<BVHLocationNode*>( node->getParent() );
-    if (!locNode || locNode->getLocation() != this) {
-        return false;
-    }
+    {
+        boost::unique_lock<mutex_type> lock(accessMutex);
+        bvh_location_node_ptr locNode = static_cast<BVHLocationNode*>( node->getParent() );
+        if (!locNode || locNode->getLocation() != this) {
+            return false;
+        }
 
-    if ( locNode->isDynamic() ) {
-        dynamicAABBTree.remove(locNode->getBVHIterator());
-    }
-    else {
-        staticAABBTree.remove(locNode->getBVHIterator());
-    }
-    locNode->removeChild(node.get());
+        if ( locNode->isDynamic() ) {
+            dynamicAABBTree.remove(locNode->getBVHIterator());
+        }
+        else {
+            staticAABBTree.remove(locNode->getBVHIterator());
+        }
+        locNode->removeChild(node.get());
 
-    aabb = math::merge( staticAABBTree.get_bounds(), dynamicAABBTree.get_bounds() );
-    DEBUG_UPDATE_TREE(debugMesh, aabb, staticAABBTree, dynamicAABBTree)
+        aabb = math::merge( staticAABBTree.get_bounds(), dynamicAABBTree.get_bounds() );
+        DEBUG_UPDATE_TREE(debugMesh, aabb, staticAABBTree, dynamicAABBTree)
+    }
     
-    eventVisitor.setType(EventVisitor::WORLD_REMOVE);
+    // nodes may update immediately and lock location for writing, so notify them unlocked
+    EventVisitor eventVisitor(EventVisitor::WORLD_REMOVE, this);
     eventVisitor.setPhysicsToggle(deactivatePhysics);
     eventVisitor.traverse(*node);
     return true;
@@ -282,20 +323,50 @@ bool BVHLocation::remove(const scene::node_ptr& node, bool deactivatePhysics)
 
 void BVHLocation::setDynamicsWorld(const physics::dynamics_world_ptr& dynamicsWorld_)
 {
+    // nodes may update immediately and lock location for writing, so notify them unlocked
+    std::vector<scene::node_ptr> nodes;
+    {
+        boost::unique_lock<mutex_type> lock(accessMutex);
+        for (object_tree_iterator iter = staticAABBTree.begin(); iter != staticAABBTree.end(); ++iter) {
+            nodes.push_back( scene::node_ptr((*iter)->getChild()) );
+        }
+        for (object_tree_iterator iter = dynamicAABBTree.begin(); iter != dynamicAABBTree.end(); ++iter) {
+            nodes.push_back( scene::node_ptr((*iter)->getChild()) );
+        }
+    }
+
+    EventVisitor eventVisitor(EventVisitor::WORLD_REMOVE, this);
+    eventVisitor.setPhysicsToggle(true);
     if (dynamicsWorld)
     {
-        dynamicsWorld.reset();
-        eventVisitor.setType(EventVisitor::WORLD_REMOVE);
-        visit(eventVisitor);
+        for (size_t i = 0; i<nodes.size(); ++i) {
+            eventVisitor.traverse(*nodes[i]);
+        }
     }
 
-    if (dynamicsWorld_)
     {
+        boost::unique_lock<mutex_type> lock(accessMutex);
         dynamicsWorld = dynamicsWorld_;
+    }
+
+    if (dynamicsWorld)
+    {
         eventVisitor.setType(EventVisitor::WORLD_ADD);
-        visit(eventVisitor);
+        for (size_t i = 0; i<nodes.size(); ++i) {
+            eventVisitor.traverse(*nodes[i]);
+        }
     }
 }
 
+thread::lock_ptr BVHLocation::lockForReading() const
+{
+    return thread::create_lock( new boost::shared_lock< thread::instrumented_mutex<boost::shared_mutex> >(accessMutex) );
+}
+
+thread::lock_ptr BVHLocation::lockForWriting()
+{
+    return thread::create_lock( new boost::unique_lock< thread::instrumented_mutex<boost::shared_mutex> >(accessMutex) );
+}
+
 } // namespace realm
 } // namespace slon
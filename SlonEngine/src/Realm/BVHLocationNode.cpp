@@ -35,7 +35,9 @@ void BVHLocationNode::deserialize(database::IArchive& ar)
 
 void BVHLocationNode::onUpdate()
 {
-    if (location) {
+    if (location) 
+    {
+        thread::lock_ptr lock = location->lockForWriting();
         location->update(firstChild);
     }
 }
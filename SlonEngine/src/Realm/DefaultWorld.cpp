@@ -2,6 +2,8 @@
 #include "Database/Archive.h"
 #include "Detail/Engine.h"
 #include "Realm/DefaultWorld.h"
+#include "Scene/Camera.h"
+#include "Scene/CullVisitor.h"
 #include "Scene/Visitor.h"
 #include "Utility/Algorithm/algorithm.hpp"
 #include "Utility/math.hpp"
@@ -66,6 +68,7 @@ WorldVisitor<World, Callback> makeWorldVisitor(World& world, Callback& cb)
 }
 
 DefaultWorld::DefaultWorld()
+:   accessMutex("realm.DefaultWorld")
 {
     eventVisitor.setWorld(this);
 }
@@ -147,6 +150,7 @@ void DefaultWorld::visitVisible(const math::Frustumf& frustum, scene::Visitor& n
 	// visit others
 	for (size_t i = 0; i<locations.size(); ++i)
 	{
+		boost::shared_lock<Location::mutex_type> lock( locations[i]->getAccessMutex() );
 		if ( test_intersection(locations[i]->getBounds(), frustum) ) {
 			locations[i]->visitVisible(frustum, nv);
 		}
@@ -163,12 +167,39 @@ void DefaultWorld::visitVisible(const math::Frustumf& frustum, scene::ConstVisit
 	// visit others
 	for (size_t i = 0; i<locations.size(); ++i)
 	{
+		boost::shared_lock<Location::mutex_type> lock( locations[i]->getAccessMutex() );
 		if ( test_intersection(locations[i]->getBounds(), frustum) ) {
 			locations[i]->visitVisible(frustum, nv);
 		}
 	}
 }
 
+void DefaultWorld::visitVisible(scene::CullVisitor& cv) const
+{
+	// infinite objects are seen by every view
+	scene::CullVisitor::view_mask allViews = cv.getNumViews() < scene::CullVisitor::max_views ? (1u << cv.getNumViews()) - 1 : ~0u;
+	for (size_t i = 0; i<infiniteObjects.size(); ++i) {
+		cv.traverse(*infiniteObjects[i], allViews);
+	}
+
+	// visit locations intersecting any view
+	for (size_t i = 0; i<locations.size(); ++i)
+	{
+		boost::shared_lock<Location::mutex_type> lock( locations[i]->getAccessMutex() );
+		scene::CullVisitor::view_mask            mask = 0;
+		for (unsigned j = 0; j<cv.getNumViews(); ++j)
+		{
+			if ( test_intersection(locations[i]->getBounds(), cv.getViewCamera(j)->getFrustum()) ) {
+				mask |= 1u << j;
+			}
+		}
+
+		if (mask) {
+			locations[i]->visitVisible(cv, mask);
+		}
+	}
+}
+
 bool DefaultWorld::removeInfiniteNode(const scene::node_ptr& node)
 {
     if ( quick_remove(infiniteObjects, node) ) 
@@ -195,12 +226,12 @@ bool DefaultWorld::haveInfiniteNode(const scene::node_ptr& node) const
 
 thread::lock_ptr DefaultWorld::lockForReading() const
 {
-    return thread::create_lock( new boost::shared_lock<boost::shared_mutex>(accessMutex) );
+    return thread::create_lock( new boost::shared_lock< thread::instrumented_mutex<boost::shared_mutex> >(accessMutex) );
 }
 
 thread::lock_ptr DefaultWorld::lockForWriting()
 {
-    return thread::create_lock( new boost::unique_lock<boost::shared_mutex>(accessMutex) );
+    return thread::create_lock( new boost::unique_lock< thread::instrumented_mutex<boost::shared_mutex> >(accessMutex) );
 }
 
 World* currentWorld()
@@ -7,6 +7,7 @@ using namespace scene;
 using namespace graphics;
 
 CommonCamera::CommonCamera()
+:   accessMutex("scene.CommonCamera")
 {
 }
 
@@ -31,10 +32,10 @@ const math::AABBf& CommonCamera::getBounds() const
 
 thread::lock_ptr CommonCamera::lockForReading() const
 {
-    return thread::create_lock( new boost::shared_lock<boost::shared_mutex>(accessMutex) );
+    return thread::create_lock( new boost::shared_lock< thread::instrumented_mutex<boost::shared_mutex> >(accessMutex) );
 }
 
 thread::lock_ptr CommonCamera::lockForWriting()
 {
-    return thread::create_lock( new boost::unique_lock<boost::shared_mutex>(accessMutex) );
+    return thread::create_lock( new boost::unique_lock< thread::instrumented_mutex<boost::shared_mutex> >(accessMutex) );
 }
\ No newline at end of file
@@ -1,42 +1,399 @@
 #include "stdafx.h"
 //#include "Log/LogVisitor.h"
+#include "Scene/Camera.h"
 #include "Scene/Entity.h"
 #include "Scene/Group.h"
+#include "Scene/LODGroup.h"
+#include "Scene/OcclusionBuffer.h"
 #include "Scene/CullVisitor.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <sgl/Math/Intersection.hpp>
 
 //DECLARE_AUTO_LOGGER("scene.CullVisitor");
 
 namespace slon {
 namespace scene {
 
+CullVisitor::CullVisitor(const Camera* camera_, linear_arena* arena)
+:   camera(camera_)
+,   forTraverse( node_vector::allocator_type(arena) )
+,   lights( light_vector::allocator_type(arena) )
+,   renderables( renderable_vector::allocator_type(arena) )
+,   depths( depth_vector::allocator_type(arena) )
+,   worldMatrices( transform_vector::allocator_type(arena) )
+,   renderableBounds( bounds_vector::allocator_type(arena) )
+,   occluders( occluder_vector::allocator_type(arena) )
+,   occlusionBuffer(0)
+,   minScreenArea(0.0f)
+,   updateInterval(1)
+,   numViews(camera_ ? 1 : 0)
+,   entityMask(~0u)
+,   hasDepthPosition(false)
+,   renderableViews( renderable_views_vector::allocator_type(arena) )
+,   lightMasks( mask_vector::allocator_type(arena) )
+,   occluderMasks( mask_vector::allocator_type(arena) )
+{
+    cameras[0] = camera_;
+}
+
+void CullVisitor::setCamera(const Camera* camera_)
+{
+    camera     = camera_;
+    cameras[0] = camera_;
+    numViews   = camera_ ? 1 : 0;
+}
+
+void CullVisitor::setCameras(const Camera* const* cameras_, unsigned numCameras)
+{
+    assert(numCameras <= max_views);
+    std::copy(cameras_, cameras_ + numCameras, cameras);
+    camera   = numCameras > 0 ? cameras_[0] : 0;
+    numViews = numCameras;
+}
+
 void CullVisitor::traverse(const Node& node)
+{
+    traverse(node, ~0u);
+}
+
+void CullVisitor::traverse(const Node& node, view_mask viewMask)
 {
     //AUTO_LOGGER_INIT;
     //log::LogVisitor vis(AUTO_LOGGER, log::S_FLOOD, node);
 
-    forTraverse.push(&node);
+    view_mask allViews = numViews < max_views ? (1u << numViews) - 1 : ~0u;
+    forTraverse.push_back( traverse_node(&node, 1, viewMask & allViews) );
     while ( !forTraverse.empty() )
     {
-        const Node* traversed = forTraverse.top(); forTraverse.pop();
+        traverse_node tn   = forTraverse.back(); forTraverse.pop_back();
+        Node::TYPE    type = tn.node->getNodeType();
 
         // add group children to traverse queue
-        if (traversed->getNodeType() & Node::ENTITY_BIT) {
-            static_cast<const Entity*>(traversed)->accept(*this);
+        if (type & Node::ENTITY_BIT) 
+        {
+            updateInterval   = tn.updateInterval;
+            entityMask       = tn.viewMask;
+            hasDepthPosition = false;
+            static_cast<const Entity*>(tn.node)->accept(*this);
+        }
+        else if (type & Node::LOD_BIT)
+        {
+            // traverse only selected level
+            const LODGroup* lodGroup = static_cast<const LODGroup*>(tn.node);
+            if (numViews > 1)
+            {
+                unsigned levels[max_views];
+                for (unsigned i = 0; i<numViews; ++i) 
+                {
+                    if ( tn.viewMask & (1u << i) ) {
+                        levels[i] = selectLevel(*lodGroup, *cameras[i], viewStatistics[i]);
+                    }
+                }
+
+                // views selected the same level traverse it together
+                view_mask remaining = tn.viewMask;
+                for (unsigned i = 0; remaining; ++i)
+                {
+                    if ( !(remaining & (1u << i)) ) {
+                        continue;
+                    }
+
+                    view_mask levelMask = 0;
+                    for (unsigned j = i; j<numViews; ++j)
+                    {
+                        if ( (remaining & (1u << j)) && levels[j] == levels[i] ) {
+                            levelMask |= 1u << j;
+                        }
+                    }
+                    remaining &= ~levelMask;
+
+                    if ( const Node* levelNode = lodGroup->getLevelNode(levels[i]) ) 
+                    {
+                        unsigned levelInterval = lodGroup->getLevel(levels[i]).updateInterval;
+                        forTraverse.push_back( traverse_node( levelNode, std::max(tn.updateInterval, levelInterval), levelMask ) );
+                    }
+                }
+            }
+            else
+            {
+                unsigned level = selectLevel(*lodGroup);
+                if ( const Node* levelNode = lodGroup->getLevelNode(level) ) 
+                {
+                    unsigned levelInterval = lodGroup->getLevel(level).updateInterval;
+                    forTraverse.push_back( traverse_node( levelNode, std::max(tn.updateInterval, levelInterval), tn.viewMask ) );
+                }
+            }
         }
-        else if (traversed->getNodeType() & Node::GROUP_BIT) 
+        else if (type & Node::GROUP_BIT) 
         {
-            const Group* group = static_cast<const Group*>(traversed);
+            const Group* group = static_cast<const Group*>(tn.node);
             for(const Node* i = group->getChild(); i; i = i->getRight()) {
-                forTraverse.push(i);
+                forTraverse.push_back( traverse_node(i, tn.updateInterval, tn.viewMask) );
+            }
+        }
+    }
+    updateInterval = 1;
+    entityMask     = ~0u;
+}
+
+float CullVisitor::getViewDepth(const math::Vector3f& position) const
+{
+    if (!camera) {
+        return 0.0f;
+    }
+
+    if (numViews > 1) 
+    {
+        hasDepthPosition = true;
+        depthPosition    = position;
+    }
+
+    return getViewDepth(position, *camera);
+}
+
+float CullVisitor::getViewDepth(const math::Vector3f& position, const Camera& camera) const
+{
+    // camera looks along -z in view space
+    const math::Matrix4f& viewMatrix = camera.getViewMatrix();
+    return -( viewMatrix[2][0] * position.x 
+            + viewMatrix[2][1] * position.y 
+            + viewMatrix[2][2] * position.z 
+            + viewMatrix[2][3] );
+}
+
+bool CullVisitor::isVisible(const math::AABBf& worldBounds)
+{
+    if (!camera) {
+        return true;
+    }
+
+    if (numViews > 1)
+    {
+        // narrow views of the objects collected by the entity
+        view_mask visibleMask = 0;
+        for (unsigned i = 0; i<numViews; ++i)
+        {
+            if ( (entityMask & (1u << i)) && isVisible(worldBounds, *cameras[i], viewStatistics[i]) ) {
+                visibleMask |= 1u << i;
+            }
+        }
+        entityMask = visibleMask;
+
+        return visibleMask != 0;
+    }
+
+    return isVisible(worldBounds, *camera, statistics);
+}
+
+bool CullVisitor::isVisible(const math::AABBf& worldBounds, const Camera& camera, STATISTICS& statistics) const
+{
+    ++statistics.numTested;
+    if ( !math::test_intersection(camera.getFrustum(), worldBounds) )
+    {
+        ++statistics.numFrustumCulled;
+        return false;
+    }
+
+    if (minScreenArea > 0.0f)
+    {
+        float screenRadius = getScreenRadius(worldBounds, camera);
+        if (screenRadius >= 0.0f && 3.1415926f * screenRadius * screenRadius < minScreenArea)
+        {
+            ++statistics.numSmallCulled;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+unsigned CullVisitor::selectLevel(const LODGroup& lodGroup)
+{
+    if (!camera) {
+        return 0;
+    }
+
+    return selectLevel(lodGroup, *camera, statistics);
+}
+
+unsigned CullVisitor::selectLevel(const LODGroup& lodGroup, const Camera& camera, STATISTICS& statistics) const
+{
+    const math::AABBf& worldBounds = lodGroup.getWorldBounds();
+    if ( worldBounds.minVec.x > worldBounds.maxVec.x ) {
+        return 0;
+    }
+
+    unsigned numLevels = lodGroup.getNumLevels();
+    if ( !isVisible(worldBounds, camera, statistics) ) {
+        return numLevels;
+    }
+
+    // camera inside bounds uses the most detailed level
+    float screenRadius = getScreenRadius(worldBounds, camera);
+    float screenSize   = screenRadius < 0.0f ? std::numeric_limits<float>::max() 
+                                             : 2.0f * screenRadius / std::max(float(camera.getViewport().height), 1.0f);
+    bool     switched  = false;
+    unsigned level     = lodGroup.selectLevel(&camera, screenSize, &switched);
+
+    ++statistics.numLODSelections;
+    statistics.numLODSwitches      += switched ? 1 : 0;
+    statistics.numLODBaseTriangles += lodGroup.getLevel(0).numTriangles;
+    if (level < numLevels) {
+        statistics.numLODTriangles += lodGroup.getLevel(level).numTriangles;
+    }
+    else {
+        ++statistics.numLODCulled;
+    }
+
+    return level;
+}
+
+float CullVisitor::getScreenRadius(const math::AABBf& worldBounds, const Camera& camera) const
+{
+    // projected radius of the bounding sphere, w is clip space w of the sphere center
+    math::Vector3f        center     = (worldBounds.minVec + worldBounds.maxVec) * 0.5f;
+    float                 radius     = math::length(worldBounds.maxVec - worldBounds.minVec) * 0.5f;
+    float                 depth      = getViewDepth(center, camera);
+    const math::Matrix4f& projection = camera.getProjectionMatrix();
+    float                 w          = projection[3][3] - projection[3][2] * depth;
+    if (depth <= radius || w <= 0.0f) {
+        return -1.0f;
+    }
+
+    return radius * projection[1][1] * 0.5f * camera.getViewport().height / w;
+}
+
+size_t CullVisitor::cullOccluded()
+{
+    if (!occlusionBuffer || !camera) {
+        return 0;
+    }
+
+    occlusionBuffer->setViewProjection( camera->getProjectionMatrix() * camera->getViewMatrix() );
+    for (size_t i = 0; i<occluders.size(); ++i) 
+    {
+        if (occluders[i].worldMatrix) {
+            occlusionBuffer->rasterize(occluders[i].bounds, *occluders[i].worldMatrix);
+        }
+        else {
+            occlusionBuffer->rasterize(occluders[i].bounds);
+        }
+    }
+    occlusionBuffer->buildHierarchy();
+
+    // compact visible renderables, subsets of the entity are collected one after another 
+    // and share bounds, so test result of the previous renderable is reused
+    size_t numVisible = 0;
+    bool   occluded   = false;
+    for (size_t i = 0; i<renderables.size(); ++i)
+    {
+        const math::AABBf& worldBounds = renderableBounds[i];
+        if ( i == 0 || std::memcmp(&worldBounds, &renderableBounds[i - 1], sizeof(math::AABBf)) != 0 ) 
+        {
+            bool empty = worldBounds.minVec.x > worldBounds.maxVec.x 
+                         || worldBounds.minVec.y > worldBounds.maxVec.y 
+                         || worldBounds.minVec.z > worldBounds.maxVec.z;
+            occluded = !empty && occlusionBuffer->isOccluded(worldBounds);
+        }
+
+        if (!occluded)
+        {
+            renderables[numVisible]      = renderables[i];
+            depths[numVisible]           = depths[i];
+            worldMatrices[numVisible]    = worldMatrices[i];
+            renderableBounds[numVisible] = renderableBounds[i];
+            ++numVisible;
+        }
+    }
+
+    size_t numCulled = renderables.size() - numVisible;
+    statistics.numOccluded += numCulled;
+    renderables.resize(numVisible);
+    depths.resize(numVisible);
+    worldMatrices.resize(numVisible);
+    renderableBounds.resize(numVisible);
+
+    return numCulled;
+}
+
+void CullVisitor::gatherView(const CullVisitor& multiView, unsigned view)
+{
+    assert(view < multiView.numViews);
+
+    clear();
+    setCamera(multiView.cameras[view]);
+    statistics = multiView.numViews > 1 ? multiView.viewStatistics[view] : multiView.statistics;
+
+    view_mask viewBit = 1u << view;
+    for (size_t i = 0; i<multiView.lights.size(); ++i)
+    {
+        if (multiView.numViews == 1 || (multiView.lightMasks[i] & viewBit)) {
+            lights.push_back(multiView.lights[i]);
+        }
+    }
+
+    if (occlusionBuffer)
+    {
+        for (size_t i = 0; i<multiView.occluders.size(); ++i)
+        {
+            if (multiView.numViews == 1 || (multiView.occluderMasks[i] & viewBit)) {
+                occluders.push_back(multiView.occluders[i]);
             }
         }
     }
+
+    for (size_t i = 0; i<multiView.renderables.size(); ++i)
+    {
+        float depth = multiView.depths[i];
+        if (multiView.numViews > 1)
+        {
+            const renderable_views& views = multiView.renderableViews[i];
+            if ( !(views.mask & viewBit) ) {
+                continue;
+            }
+
+            if (views.hasPosition) {
+                depth = getViewDepth(views.position, *camera);
+            }
+        }
+
+        renderables.push_back(multiView.renderables[i]);
+        depths.push_back(depth);
+        worldMatrices.push_back(multiView.worldMatrices[i]);
+        renderableBounds.push_back(multiView.renderableBounds[i]);
+    }
+    statistics.numEmitted = renderables.size();
 }
 
 void CullVisitor::clear()
 {
     renderables.clear();
+    depths.clear();
+    worldMatrices.clear();
+    renderableBounds.clear();
+    occluders.clear();
+    statistics = STATISTICS();
     lights.clear();
+    renderableViews.clear();
+    lightMasks.clear();
+    occluderMasks.clear();
+    std::fill(viewStatistics, viewStatistics + max_views, STATISTICS());
+}
+
+void CullVisitor::release()
+{
+    renderable_vector( renderables.get_allocator() ).swap(renderables);
+    depth_vector( depths.get_allocator() ).swap(depths);
+    transform_vector( worldMatrices.get_allocator() ).swap(worldMatrices);
+    bounds_vector( renderableBounds.get_allocator() ).swap(renderableBounds);
+    occluder_vector( occluders.get_allocator() ).swap(occluders);
+    light_vector( lights.get_allocator() ).swap(lights);
+    node_vector( forTraverse.get_allocator() ).swap(forTraverse);
+    renderable_views_vector( renderableViews.get_allocator() ).swap(renderableViews);
+    mask_vector( lightMasks.get_allocator() ).swap(lightMasks);
+    mask_vector( occluderMasks.get_allocator() ).swap(occluderMasks);
 }
 
 } // namespace scene
@@ -0,0 +1,208 @@
+#include "stdafx.h"
+#include "Database/Archive.h"
+#include "Database/Detail/SGLSerialization.h"
+#include "Scene/LODGroup.h"
+#include "Scene/TransformVisitor.h"
+
+namespace slon {
+namespace scene {
+
+LODGroup::LODGroup()
+:   hysteresis(0.1f)
+,   bounds( slon::bounds<math::AABBf>::inv_infinite() )
+,   worldBounds( slon::bounds<math::AABBf>::inv_infinite() )
+,   nextCamera(0)
+{
+    for (unsigned i = 0; i<max_cameras; ++i) {
+        cameraLevels[i].camera = 0;
+    }
+}
+
+LODGroup::LODGroup(const hash_string& name)
+:   Group(name)
+,   hysteresis(0.1f)
+,   bounds( slon::bounds<math::AABBf>::inv_infinite() )
+,   worldBounds( slon::bounds<math::AABBf>::inv_infinite() )
+,   nextCamera(0)
+{
+    for (unsigned i = 0; i<max_cameras; ++i) {
+        cameraLevels[i].camera = 0;
+    }
+}
+
+const char* LODGroup::serialize(database::OArchive& ar) const
+{
+	// serialize base class
+	Group::serialize(ar);
+
+	// serialize data
+	ar.writeChunk("hysteresis", &hysteresis);
+	database::serialize(ar, "bounds", bounds);
+	ar.openChunk("levels");
+	{
+		for (size_t i = 0; i<levels.size(); ++i)
+		{
+			unsigned numTriangles = unsigned(levels[i].numTriangles);
+			ar.openChunk("level");
+			ar.writeChunk("screenSize", &levels[i].screenSize);
+			ar.writeChunk("updateInterval", &levels[i].updateInterval);
+			ar.writeChunk("numTriangles", &numTriangles);
+			ar.closeChunk();
+		}
+	}
+	ar.closeChunk();
+
+	return "LODGroup";
+}
+
+void LODGroup::deserialize(database::IArchive& ar)
+{
+	// deserialize base class
+	Group::deserialize(ar);
+
+	// deserialize data
+	ar.readChunk("hysteresis", &hysteresis);
+	database::deserialize(ar, "bounds", bounds);
+
+	levels.clear();
+	database::IArchive::chunk_info info;
+	if ( ar.openChunk("levels", info) )
+	{
+		while ( ar.openChunk("level", info) )
+		{
+			level_desc desc;
+			unsigned   numTriangles;
+			ar.readChunk("screenSize", &desc.screenSize);
+			ar.readChunk("updateInterval", &desc.updateInterval);
+			ar.readChunk("numTriangles", &numTriangles);
+			desc.numTriangles = numTriangles;
+			levels.push_back(desc);
+			ar.closeChunk();
+		}
+		ar.closeChunk();
+	}
+}
+
+void LODGroup::setLevel(unsigned level, const level_desc& desc)
+{
+    if ( level >= levels.size() ) {
+        levels.resize( level + 1 );
+    }
+    levels[level] = desc;
+}
+
+unsigned LODGroup::getNumLevels() const
+{
+    unsigned numLevels = 0;
+    for (const Node* i = getChild(); i; i = i->getRight()) {
+        ++numLevels;
+    }
+
+    return numLevels;
+}
+
+const Node* LODGroup::getLevelNode(unsigned level) const
+{
+    const Node* node = getChild();
+    for (unsigned i = 0; node && i < level; ++i) {
+        node = node->getRight();
+    }
+
+    return node;
+}
+
+unsigned LODGroup::selectLevel(float screenSize, unsigned currentLevel) const
+{
+    unsigned numLevels = getNumLevels();
+    if (currentLevel > numLevels)
+    {
+        // no previous selection, use thresholds as is
+        unsigned level = 0;
+        while ( level < numLevels && screenSize < getLevel(level).screenSize ) {
+            ++level;
+        }
+
+        return level;
+    }
+
+    // move to the finer level only when it is noticeably larger than its threshold,
+    // to the coarser level only when it is noticeably smaller than current threshold
+    unsigned level = currentLevel;
+    while ( level > 0 && screenSize >= getLevel(level - 1).screenSize * (1.0f + hysteresis) ) {
+        --level;
+    }
+    while ( level < numLevels && screenSize < getLevel(level).screenSize * (1.0f - hysteresis) ) {
+        ++level;
+    }
+
+    return level;
+}
+
+unsigned LODGroup::selectLevel(const Camera* camera, float screenSize, bool* switched) const
+{
+    camera_level* cameraLevel = 0;
+    for (unsigned i = 0; i<max_cameras; ++i)
+    {
+        if (cameraLevels[i].camera == camera)
+        {
+            cameraLevel = &cameraLevels[i];
+            break;
+        }
+    }
+
+    if (!cameraLevel)
+    {
+        // replace oldest camera
+        cameraLevel         = &cameraLevels[nextCamera];
+        cameraLevel->camera = camera;
+        cameraLevel->level  = invalid_level;
+        nextCamera          = (nextCamera + 1) % max_cameras;
+    }
+
+    unsigned level = selectLevel(screenSize, cameraLevel->level);
+    if (switched) {
+        *switched = (cameraLevel->level != invalid_level && cameraLevel->level != level);
+    }
+    cameraLevel->level = level;
+
+    return level;
+}
+
+unsigned LODGroup::getUpdateInterval() const
+{
+    unsigned numLevels = getNumLevels();
+    unsigned finest    = numLevels;
+    for (unsigned i = 0; i<max_cameras; ++i)
+    {
+        if (cameraLevels[i].camera) {
+            finest = std::min(finest, cameraLevels[i].level);
+        }
+    }
+
+    if (numLevels == 0) {
+        return 1;
+    }
+
+    // group is not visible, update at the rate of the coarsest level
+    return getLevel( std::min(finest, numLevels - 1) ).updateInterval;
+}
+
+void LODGroup::accept(TransformVisitor& visitor)
+{
+    if (bounds.minVec.x > bounds.maxVec.x) {
+        worldBounds = bounds;
+    }
+    else {
+        worldBounds = visitor.getLocalToWorldTransform() * bounds;
+    }
+}
+
+void LODGroup::setLevelBounds(const math::AABBf& levelBounds)
+{
+    if (bounds.minVec.x > bounds.maxVec.x) {
+        worldBounds = levelBounds;
+    }
+}
+
+} // namespace scene
+} // namespace slon
@@ -0,0 +1,321 @@
+#include "stdafx.h"
+#include "Scene/OcclusionBuffer.h"
+#ifdef SLON_ENGINE_USE_SSE
+#   include <xmmintrin.h>
+#endif
+
+namespace {
+
+    using namespace slon;
+
+    const float w_epsilon = 1e-5f;
+
+    // triangles of the box, corner i has max x if bit 0 is set, max y - bit 1, max z - bit 2
+    const unsigned box_indices[36] =
+    {
+        0, 2, 6,  0, 6, 4, // -x
+        1, 3, 7,  1, 7, 5, // +x
+        0, 1, 5,  0, 5, 4, // -y
+        2, 3, 7,  2, 7, 6, // +y
+        0, 1, 3,  0, 3, 2, // -z
+        4, 5, 7,  4, 7, 6  // +z
+    };
+
+    math::Vector3f box_corner(const math::AABBf& box, unsigned i)
+    {
+        return math::Vector3f( (i & 1) ? box.maxVec.x : box.minVec.x,
+                               (i & 2) ? box.maxVec.y : box.minVec.y,
+                               (i & 4) ? box.maxVec.z : box.minVec.z );
+    }
+
+    // edge function A * x + B * y + C, positive inside counter clockwise triangle
+    struct edge
+    {
+        float a, b, c;
+
+        edge(const math::Vector4f& v0, const math::Vector4f& v1)
+        :   a(v0.y - v1.y)
+        ,   b(v1.x - v0.x)
+        ,   c(-(a * v0.x + b * v0.y))
+        {}
+    };
+
+} // anonymous namespace
+
+namespace slon {
+namespace scene {
+
+OcclusionBuffer::OcclusionBuffer(unsigned width, unsigned height)
+{
+    assert(width > 0 && height > 0);
+
+    level base;
+    base.width  = (width + 3) & ~3;
+    base.height = height;
+    base.depth.resize(base.width * base.height, 1.0f);
+    levels.push_back(base);
+
+    while (levels.back().width > 1 || levels.back().height > 1)
+    {
+        level next;
+        next.width  = (levels.back().width + 1) / 2;
+        next.height = (levels.back().height + 1) / 2;
+        next.depth.resize(next.width * next.height, 1.0f);
+        levels.push_back(next);
+    }
+}
+
+void OcclusionBuffer::setViewProjection(const math::Matrix4f& viewProjection_)
+{
+    viewProjection = viewProjection_;
+    for (size_t i = 0; i<levels.size(); ++i) {
+        std::fill(levels[i].depth.begin(), levels[i].depth.end(), 1.0f);
+    }
+}
+
+void OcclusionBuffer::rasterize(const math::Vector3f* vertices, const unsigned* indices, size_t numIndices)
+{
+    timer.start();
+
+    const float halfWidth  = 0.5f * levels[0].width;
+    const float halfHeight = 0.5f * levels[0].height;
+    for (size_t i = 0; i + 2 < numIndices; i += 3)
+    {
+        math::Vector4f screen[3];
+        bool           clipped = false;
+        for (int j = 0; j<3; ++j)
+        {
+            math::Vector4f clip = viewProjection * math::make_vec(vertices[ indices[i + j] ], 1.0f);
+            if (clip.w < w_epsilon || clip.z < -clip.w)
+            {
+                clipped = true;
+                break;
+            }
+
+            float invW = 1.0f / clip.w;
+            screen[j] = math::Vector4f( (clip.x * invW + 1.0f) * halfWidth,
+                                        (clip.y * invW + 1.0f) * halfHeight,
+                                        clip.z * invW,
+                                        1.0f );
+        }
+
+        if (!clipped)
+        {
+            rasterizeTriangle(screen[0], screen[1], screen[2]);
+            ++statistics.numOccluderTriangles;
+        }
+    }
+
+    statistics.rasterizeTime += timer.getTime();
+}
+
+void OcclusionBuffer::rasterize(const math::AABBf& box)
+{
+    math::Vector3f corners[8];
+    for (unsigned i = 0; i<8; ++i) {
+        corners[i] = box_corner(box, i);
+    }
+
+    rasterize(corners, box_indices, 36);
+}
+
+void OcclusionBuffer::rasterize(const math::AABBf& box, const math::Matrix4f& worldMatrix)
+{
+    math::Vector3f corners[8];
+    for (unsigned i = 0; i<8; ++i) {
+        corners[i] = math::xyz( worldMatrix * math::make_vec(box_corner(box, i), 1.0f) );
+    }
+
+    rasterize(corners, box_indices, 36);
+}
+
+void OcclusionBuffer::rasterizeTriangle(const math::Vector4f& a, const math::Vector4f& b, const math::Vector4f& c)
+{
+    // make counter clockwise, skip degenerate
+    float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+    if ( std::abs(area) < 1e-6f ) {
+        return;
+    }
+
+    const math::Vector4f& v0 = a;
+    const math::Vector4f& v1 = area > 0.0f ? b : c;
+    const math::Vector4f& v2 = area > 0.0f ? c : b;
+    area = std::abs(area);
+
+    // bounding rect clamped to the buffer
+    level& base = levels[0];
+    int minX = std::max( int( std::floor( std::min(v0.x, std::min(v1.x, v2.x)) ) ), 0 );
+    int minY = std::max( int( std::floor( std::min(v0.y, std::min(v1.y, v2.y)) ) ), 0 );
+    int maxX = std::min( int( std::ceil( std::max(v0.x, std::max(v1.x, v2.x)) ) ), int(base.width) - 1 );
+    int maxY = std::min( int( std::ceil( std::max(v0.y, std::max(v1.y, v2.y)) ) ), int(base.height) - 1 );
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
+
+    // edge opposite to the vertex i is weight of the vertex i
+    edge  e0(v1, v2);
+    edge  e1(v2, v0);
+    edge  e2(v0, v1);
+    float invArea = 1.0f / area;
+    float za      = (e0.a * v0.z + e1.a * v1.z + e2.a * v2.z) * invArea;
+    float zb      = (e0.b * v0.z + e1.b * v1.z + e2.b * v2.z) * invArea;
+    float zc      = (e0.c * v0.z + e1.c * v1.z + e2.c * v2.z) * invArea;
+
+    // process 4 pixel blocks, width of the buffer is multiple of 4
+    minX &= ~3;
+#ifdef SLON_ENGINE_USE_SSE
+    const __m128 zero    = _mm_setzero_ps();
+    const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128 e0a     = _mm_set1_ps(e0.a);
+    const __m128 e1a     = _mm_set1_ps(e1.a);
+    const __m128 e2a     = _mm_set1_ps(e2.a);
+    const __m128 zaa     = _mm_set1_ps(za);
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float  py  = y + 0.5f;
+        __m128 e0r = _mm_set1_ps(e0.b * py + e0.c);
+        __m128 e1r = _mm_set1_ps(e1.b * py + e1.c);
+        __m128 e2r = _mm_set1_ps(e2.b * py + e2.c);
+        __m128 zr  = _mm_set1_ps(zb * py + zc);
+        float* row = &base.depth[y * base.width];
+        for (int x = minX; x <= maxX; x += 4)
+        {
+            __m128 px     = _mm_add_ps(_mm_set1_ps( float(x) ), offsets);
+            __m128 inside = _mm_and_ps( _mm_and_ps( _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e0a, px), e0r), zero),
+                                                    _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e1a, px), e1r), zero) ),
+                                        _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e2a, px), e2r), zero) );
+            if ( !_mm_movemask_ps(inside) ) {
+                continue;
+            }
+
+            __m128 depth   = _mm_loadu_ps(row + x);
+            __m128 covered = _mm_min_ps( depth, _mm_add_ps(_mm_mul_ps(zaa, px), zr) );
+            _mm_storeu_ps( row + x, _mm_or_ps( _mm_and_ps(inside, covered), _mm_andnot_ps(inside, depth) ) );
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float  py  = y + 0.5f;
+        float  e0r = e0.b * py + e0.c;
+        float  e1r = e1.b * py + e1.c;
+        float  e2r = e2.b * py + e2.c;
+        float  zr  = zb * py + zc;
+        float* row = &base.depth[y * base.width];
+        for (int x = minX; x <= maxX; ++x)
+        {
+            float px = x + 0.5f;
+            if (e0.a * px + e0r >= 0.0f && e1.a * px + e1r >= 0.0f && e2.a * px + e2r >= 0.0f) {
+                row[x] = std::min(row[x], za * px + zr);
+            }
+        }
+    }
+#endif
+}
+
+void OcclusionBuffer::buildHierarchy()
+{
+    timer.start();
+    for (size_t i = 1; i<levels.size(); ++i)
+    {
+        const level& prev = levels[i - 1];
+        level&       next = levels[i];
+        for (unsigned y = 0; y<next.height; ++y)
+        {
+            unsigned y0 = 2 * y;
+            unsigned y1 = std::min(y0 + 1, prev.height - 1);
+            for (unsigned x = 0; x<next.width; ++x)
+            {
+                unsigned x0 = 2 * x;
+                unsigned x1 = std::min(x0 + 1, prev.width - 1);
+                next.depth[y * next.width + x] = std::max( std::max(prev.depth[y0 * prev.width + x0], prev.depth[y0 * prev.width + x1]),
+                                                           std::max(prev.depth[y1 * prev.width + x0], prev.depth[y1 * prev.width + x1]) );
+            }
+        }
+    }
+    statistics.rasterizeTime += timer.getTime();
+}
+
+bool OcclusionBuffer::isOccluded(const math::AABBf& box)
+{
+    timer.start();
+    ++statistics.numTested;
+
+    // screen rect and nearest depth of the box
+    float minX     = std::numeric_limits<float>::max();
+    float minY     = std::numeric_limits<float>::max();
+    float maxX     = -std::numeric_limits<float>::max();
+    float maxY     = -std::numeric_limits<float>::max();
+    float minDepth = std::numeric_limits<float>::max();
+    for (unsigned i = 0; i<8; ++i)
+    {
+        math::Vector4f clip = viewProjection * math::make_vec(box_corner(box, i), 1.0f);
+        if (clip.w < w_epsilon || clip.z < -clip.w)
+        {
+            // box crosses near plane
+            statistics.testTime += timer.getTime();
+            return false;
+        }
+
+        float invW = 1.0f / clip.w;
+        float x    = clip.x * invW;
+        float y    = clip.y * invW;
+        minX       = std::min(minX, x);
+        minY       = std::min(minY, y);
+        maxX       = std::max(maxX, x);
+        maxY       = std::max(maxY, y);
+        minDepth   = std::min(minDepth, clip.z * invW);
+    }
+
+    const level& base = levels[0];
+    int x0 = int( std::floor( (minX + 1.0f) * 0.5f * base.width ) );
+    int y0 = int( std::floor( (minY + 1.0f) * 0.5f * base.height ) );
+    int x1 = int( std::floor( (maxX + 1.0f) * 0.5f * base.width ) );
+    int y1 = int( std::floor( (maxY + 1.0f) * 0.5f * base.height ) );
+    if ( x1 < 0 || y1 < 0 || x0 >= int(base.width) || y0 >= int(base.height) )
+    {
+        // out of the screen, frustum culling decides
+        statistics.testTime += timer.getTime();
+        return false;
+    }
+
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, int(base.width) - 1);
+    y1 = std::min(y1, int(base.height) - 1);
+
+    // coarsest level where box covers at most 4x4 texels
+    size_t levelIndex = 0;
+    while ( levelIndex + 1 < levels.size() && (x1 - x0 > 3 || y1 - y0 > 3) )
+    {
+        x0 >>= 1;
+        y0 >>= 1;
+        x1 >>= 1;
+        y1 >>= 1;
+        ++levelIndex;
+    }
+
+    const level& l = levels[levelIndex];
+    bool occluded  = true;
+    for (int y = y0; y <= y1 && occluded; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            if ( minDepth <= l.depth[y * l.width + x] )
+            {
+                occluded = false;
+                break;
+            }
+        }
+    }
+
+    if (occluded) {
+        ++statistics.numCulled;
+    }
+    statistics.testTime += timer.getTime();
+
+    return occluded;
+}
+
+} // namespace scene
+} // namespace slon
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 //#include "Log/LogVisitor.h"
 #include "Scene/Entity.h"
+#include "Scene/LODGroup.h"
 #include "Scene/Skeleton.h"
 #include "Scene/TransformVisitor.h"
 #include "Utility/math.hpp"
@@ -33,6 +34,7 @@ void TransformVisitor::traverse(Node& node)
 
     // initialize
     aabb = bounds<math::AABBf>::inv_infinite();
+    outerBounds.clear();
 /*
     // traverse
     forTraverse.push( traverse_node(&node) );
@@ -77,8 +79,12 @@ void TransformVisitor::traverse(Node& node)
             currentGroup = visitedTransform = static_cast<Transform*>(currentNode);
             visitTransform(currentTransform, *visitedTransform);
         }
-        else if (type & Node::GROUP_BIT) {
+        else if (type & Node::GROUP_BIT) 
+        {
             currentGroup = static_cast<Group*>(currentNode);
+            if (type & Node::LOD_BIT) {
+                beginLODGroup( static_cast<LODGroup&>(*currentNode) );
+            }
         }
         else if (type & Node::SKELETON_BIT) {
             visitSkeleton( static_cast<Skeleton&>(*currentNode) );
@@ -106,6 +112,9 @@ void TransformVisitor::traverse(Node& node)
                 if (currentNode == currentTransform) {
                     currentTransform = 0;
                 }
+                if (currentNode->getNodeType() & Node::LOD_BIT) {
+                    endLODGroup( static_cast<LODGroup&>(*currentNode) );
+                }
             }
 
             if (currentNode == &node) {
@@ -172,6 +181,25 @@ void TransformVisitor::visitSkeleton(Skeleton& skeleton)
     }
 }
 
+void TransformVisitor::beginLODGroup(LODGroup& lodGroup)
+{
+    lodGroup.accept(*this);
+    outerBounds.push_back(aabb);
+    aabb = bounds<math::AABBf>::inv_infinite();
+
+    // group without levels is not visited on the way up
+    if ( !lodGroup.getChild() ) {
+        endLODGroup(lodGroup);
+    }
+}
+
+void TransformVisitor::endLODGroup(LODGroup& lodGroup)
+{
+    lodGroup.setLevelBounds(aabb);
+    aabb = math::merge( outerBounds.back(), aabb );
+    outerBounds.pop_back();
+}
+
 void TransformVisitor::visitJoint(Transform* parentTransform, Joint& joint)
 {
     if ( visitTransform(parentTransform, joint) ) {
@@ -1,13 +1,43 @@
 #include "stdafx.h"
 #include "Thread/Detail/ThreadManager.h"
+#include "Thread/Utility.h"
+#include <boost/bind.hpp>
 
 namespace slon {
 namespace thread {
+
+THREAD_PLACEMENT applyThreadDesc(const THREAD_DESC& desc)
+{
+    THREAD_PLACEMENT placement;
+    placement.started   = true;
+    placement.succeeded = true;
+    if ( !desc.name.empty() ) {
+        placement.succeeded &= setCurrentThreadName(desc.name);
+    }
+    if (desc.affinityMask) {
+        placement.succeeded &= setCurrentThreadAffinity(desc.affinityMask);
+    }
+    if (desc.setPriority) {
+        placement.succeeded &= setCurrentThreadPriority(desc.priority);
+    }
+
+    placement.name         = desc.name;
+    placement.affinityMask = getCurrentThreadAffinity();
+    placement.priority     = getCurrentThreadPriority();
+    return placement;
+}
+
 namespace detail {
 
 ThreadManager::ThreadManager()
 {
     mainThreadId = boost::this_thread::get_id();
+
+    descs[MAIN_THREAD + 1].name       = "slon-main";
+    descs[SIMULATION_THREAD + 1].name = "slon-simulation";
+    descs[RESOURCE_THREAD + 1].name   = "slon-resource";
+    descs[NETWORK_THREAD + 1].name    = "slon-network";
+    workerDesc.name                   = "slon-worker";
 }
 
 THREAD_SEMANTIC ThreadManager::getCurrentThreadSemantic() const
@@ -62,6 +92,68 @@ void ThreadManager::delegateToThread(THREAD_SEMANTIC thread, const void_function
     }
 }
 
+ThreadPool& ThreadManager::getThreadPool()
+{
+    boost::lock_guard<boost::mutex> lock(threadPoolMutex);
+    if (!threadPool) {
+        threadPool.reset( new ThreadPool(-1, workerDesc) );
+    }
+
+    return *threadPool;
+}
+
+void ThreadManager::setThreadDesc(THREAD_SEMANTIC thread, const THREAD_DESC& desc)
+{
+    assert( thread == MAIN_THREAD || thread >= 0 && thread < MAX_THREAD_SEMANTIC );
+    {
+        boost::lock_guard<boost::mutex> lock(placementMutex);
+        descs[thread + 1] = desc;
+    }
+
+    if (thread == MAIN_THREAD) {
+        delegateToThread( MAIN_THREAD, boost::bind(&ThreadManager::threadEntry, this, MAIN_THREAD, void_function()) );
+    }
+}
+
+const THREAD_DESC& ThreadManager::getThreadDesc(THREAD_SEMANTIC thread) const
+{
+    assert( thread == MAIN_THREAD || thread >= 0 && thread < MAX_THREAD_SEMANTIC );
+    return descs[thread + 1];
+}
+
+void ThreadManager::setWorkerThreadDesc(const THREAD_DESC& desc)
+{
+    boost::lock_guard<boost::mutex> lock(threadPoolMutex);
+    assert(!threadPool && "Worker settings must be specified before thread pool is created");
+    workerDesc = desc;
+}
+
+THREAD_PLACEMENT ThreadManager::getThreadPlacement(THREAD_SEMANTIC thread) const
+{
+    assert( thread == MAIN_THREAD || thread >= 0 && thread < MAX_THREAD_SEMANTIC );
+    boost::lock_guard<boost::mutex> lock(placementMutex);
+    return placements[thread + 1];
+}
+
+void ThreadManager::threadEntry(THREAD_SEMANTIC semantic, const void_function& function)
+{
+    THREAD_DESC desc;
+    {
+        boost::lock_guard<boost::mutex> lock(placementMutex);
+        desc = descs[semantic + 1];
+    }
+
+    THREAD_PLACEMENT placement = applyThreadDesc(desc);
+    {
+        boost::lock_guard<boost::mutex> lock(placementMutex);
+        placements[semantic + 1] = placement;
+    }
+
+    if (function) {
+        function();
+    }
+}
+
 bool ThreadManager::performDelayedFunctions(THREAD_SEMANTIC thread)
 {
     assert( thread == MAIN_THREAD || thread >= 0 && thread < MAX_THREAD_SEMANTIC );
@@ -102,7 +194,7 @@ bool ThreadManager::performDelayedFunctions(THREAD_SEMANTIC thread)
 void ThreadManager::startThread(THREAD_SEMANTIC semantic, const void_function& function)
 {
     assert(semantic >= 0 && semantic < MAX_THREAD_SEMANTIC);
-    boost::thread thread(function);
+    boost::thread thread( boost::bind(&ThreadManager::threadEntry, this, semantic, function) );
     threads[semantic].swap(thread);
 }
 
@@ -0,0 +1,143 @@
+#include "stdafx.h"
+#include "Thread/Atomic.h"
+#include "Thread/LockStatistics.h"
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+#ifdef WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace {
+
+    using namespace slon::thread;
+
+    // zero initialized before any static constructor, so mutexes of the static objects can register
+    lock_statistics namedLocks[max_num_lock_statistics];
+    volatile long   numNamedLocks;
+    volatile long   registrationLock;
+
+} // anonymous namespace
+
+namespace slon {
+namespace thread {
+
+lock_statistics* get_lock_statistics(const char* name)
+{
+    assert(name);
+
+    // spin, registration is rare
+    while ( atomic_compare_exchange(&registrationLock, 1, 0) != 0 ) {}
+
+    lock_statistics* statistics = 0;
+    for (long i = 0; i<numNamedLocks; ++i)
+    {
+        if ( std::strcmp(namedLocks[i].name, name) == 0 ) 
+        {
+            statistics = &namedLocks[i];
+            break;
+        }
+    }
+
+    if ( !statistics && size_t(numNamedLocks) < max_num_lock_statistics )
+    {
+        statistics       = &namedLocks[numNamedLocks];
+        statistics->name = name;
+        atomic_increment(&numNamedLocks);
+    }
+
+    atomic_exchange(&registrationLock, 0);
+    return statistics;
+}
+
+size_t get_num_lock_statistics()
+{
+    return size_t(numNamedLocks);
+}
+
+const lock_statistics& get_lock_statistics(size_t i)
+{
+    assert( i < get_num_lock_statistics() );
+    return namedLocks[i];
+}
+
+void reset_lock_statistics()
+{
+    for (long i = 0; i<numNamedLocks; ++i)
+    {
+        lock_statistics& statistics = namedLocks[i];
+        atomic_exchange(&statistics.numAcquisitions, 0);
+        atomic_exchange(&statistics.numContendedAcquisitions, 0);
+        atomic_exchange(&statistics.totalWaitTime, 0);
+        for (size_t j = 0; j<lock_wait_histogram_size; ++j) {
+            atomic_exchange(&statistics.waitHistogram[j], 0);
+        }
+    }
+}
+
+void dump_lock_statistics(std::ostream& os)
+{
+    os << std::setw(32) << std::left << "lock" << std::right
+       << std::setw(12) << "acquired"
+       << std::setw(12) << "contended"
+       << std::setw(14) << "wait (us)"
+       << "  wait histogram, bucket i < 2^i us" << std::endl;
+
+    for (long i = 0; i<numNamedLocks; ++i)
+    {
+        const lock_statistics& statistics = namedLocks[i];
+        os << std::setw(32) << std::left << statistics.name << std::right
+           << std::setw(12) << statistics.numAcquisitions
+           << std::setw(12) << statistics.numContendedAcquisitions
+           << std::setw(14) << statistics.totalWaitTime
+           << " ";
+        for (size_t j = 0; j<lock_wait_histogram_size; ++j) {
+            os << " " << statistics.waitHistogram[j];
+        }
+        os << std::endl;
+    }
+}
+
+double get_lock_statistics_time()
+{
+#ifdef WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+    return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+#else
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec * 1E-6;
+#endif
+}
+
+void record_lock_wait(lock_statistics* statistics, double waitTime)
+{
+    if (!statistics) {
+        return;
+    }
+
+    long waitTimeUS = long(waitTime * 1E6);
+    size_t bucket = 0;
+    while ( bucket + 1 < lock_wait_histogram_size && waitTimeUS >= (1L << bucket) ) {
+        ++bucket;
+    }
+
+    atomic_increment(&statistics->numContendedAcquisitions);
+    atomic_increment(&statistics->waitHistogram[bucket]);
+
+    // no atomic add, wait time is coarse anyway
+    long totalWaitTime = statistics->totalWaitTime;
+    while ( atomic_compare_exchange(&statistics->totalWaitTime, totalWaitTime + waitTimeUS, totalWaitTime) != totalWaitTime ) {
+        totalWaitTime = statistics->totalWaitTime;
+    }
+}
+
+} // namespace thread
+} // namespace slon
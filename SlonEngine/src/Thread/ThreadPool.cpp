@@ -0,0 +1,160 @@
+#include "stdafx.h"
+#include "Thread/Atomic.h"
+#include "Thread/ThreadPool.h"
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <sstream>
+
+namespace slon {
+namespace thread {
+
+ThreadPool::ThreadPool(int numWorkers, const THREAD_DESC& workerDesc_)
+:   workerDesc(workerDesc_)
+,   currentJob(0)
+,   generation(0)
+,   numActiveWorkers(0)
+,   numPlacedWorkers(0)
+,   stopping(false)
+{
+    if (numWorkers < 0) {
+        numWorkers = std::max(int(boost::thread::hardware_concurrency()) - 1, 0);
+    }
+
+    workerPlacements.resize(numWorkers);
+    for (int i = 0; i<numWorkers; ++i) {
+        workers.push_back( new boost::thread(boost::bind(&ThreadPool::workerCycle, this, i)) );
+    }
+
+    // wait for workers to apply scheduling settings, so placement is known
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while ( numPlacedWorkers < workers.size() ) {
+        doneCondition.wait(lock);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (size_t i = 0; i<workers.size(); ++i)
+    {
+        workers[i]->join();
+        delete workers[i];
+    }
+}
+
+void ThreadPool::execute(job& j)
+{
+    long i;
+    while ( (i = atomic_increment(&j.nextTask) - 1) < j.numTasks ) {
+        (*j.task)( size_t(i) );
+    }
+}
+
+THREAD_PLACEMENT ThreadPool::getWorkerPlacement(size_t i) const
+{
+    assert( i < workerPlacements.size() );
+    boost::lock_guard<boost::mutex> lock(mutex);
+    return workerPlacements[i];
+}
+
+void ThreadPool::workerCycle(size_t index)
+{
+    // name worker & pin to the processor from the mask
+    THREAD_DESC desc(workerDesc);
+    if ( !desc.name.empty() ) 
+    {
+        std::ostringstream ss;
+        ss << desc.name << "-" << index;
+        desc.name = ss.str();
+    }
+
+    if (desc.affinityMask)
+    {
+        std::vector<unsigned long long> processors;
+        for (int i = 0; i<64; ++i)
+        {
+            if ( desc.affinityMask & (1ULL << i) ) {
+                processors.push_back(1ULL << i);
+            }
+        }
+        desc.affinityMask = processors[index % processors.size()];
+    }
+
+    THREAD_PLACEMENT placement = applyThreadDesc(desc);
+    {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        workerPlacements[index] = placement;
+        ++numPlacedWorkers;
+    }
+    doneCondition.notify_all();
+
+    unsigned seenGeneration = 0;
+    for (;;)
+    {
+        job* j = 0;
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            while (!stopping && (generation == seenGeneration || !currentJob) ) {
+                wakeCondition.wait(lock);
+            }
+
+            if (stopping) {
+                return;
+            }
+
+            seenGeneration = generation;
+            j              = currentJob;
+            ++numActiveWorkers;
+        }
+
+        execute(*j);
+
+        {
+            boost::lock_guard<boost::mutex> lock(mutex);
+            --numActiveWorkers;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void ThreadPool::run(size_t numTasks, const task_function& task)
+{
+    if ( workers.empty() || numTasks < 2 || !jobMutex.try_lock() )
+    {
+        for (size_t i = 0; i<numTasks; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    job j;
+    j.task     = &task;
+    j.numTasks = long(numTasks);
+    j.nextTask = 0;
+    {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        currentJob = &j;
+        ++generation;
+    }
+    wakeCondition.notify_all();
+
+    execute(j);
+
+    // all tasks are taken, wait for workers to finish theirs
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        currentJob = 0;
+        while (numActiveWorkers > 0) {
+            doneCondition.wait(lock);
+        }
+    }
+    jobMutex.unlock();
+}
+
+} // namespace thread
+} // namespace slon
@@ -5,9 +5,54 @@
 #define NOMINMAX
 #include <windows.h>
 #else
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #endif
 
+namespace {
+
+#ifdef WIN32
+    // http://msdn.microsoft.com/en-us/library/xcb2z8hs.aspx
+    const DWORD MS_VC_EXCEPTION = 0x406D1388;
+
+#pragma pack(push, 8)
+    struct THREADNAME_INFO
+    {
+        DWORD  dwType;
+        LPCSTR szName;
+        DWORD  dwThreadID;
+        DWORD  dwFlags;
+    };
+#pragma pack(pop)
+
+    // nice value ranges mapped onto windows priority levels
+    int priorityToWindows(int priority)
+    {
+        if (priority <= -15) return THREAD_PRIORITY_TIME_CRITICAL;
+        if (priority <= -10) return THREAD_PRIORITY_HIGHEST;
+        if (priority <= -5)  return THREAD_PRIORITY_ABOVE_NORMAL;
+        if (priority < 5)    return THREAD_PRIORITY_NORMAL;
+        if (priority < 15)   return THREAD_PRIORITY_BELOW_NORMAL;
+        return THREAD_PRIORITY_LOWEST;
+    }
+#else
+    // nice applies to the kernel thread on linux
+    id_t currentThreadId()
+    {
+#ifdef __linux__
+        return id_t( syscall(SYS_gettid) );
+#else
+        return 0;
+#endif
+    }
+#endif
+
+} // anonymous namespace
+
 namespace slon {
 namespace thread {
 
@@ -20,5 +65,114 @@ void sleep(double time)
 #endif
 }
 
+bool setCurrentThreadName(const std::string& name)
+{
+#if defined(WIN32) && defined(_MSC_VER)
+    THREADNAME_INFO info;
+    info.dwType     = 0x1000;
+    info.szName     = name.c_str();
+    info.dwThreadID = DWORD(-1);
+    info.dwFlags    = 0;
+
+    __try {
+        RaiseException( MS_VC_EXCEPTION, 0, sizeof(info) / sizeof(ULONG_PTR), (ULONG_PTR*)&info );
+    }
+    __except(EXCEPTION_EXECUTE_HANDLER) {
+    }
+    return true;
+#elif defined(__linux__)
+    return pthread_setname_np( pthread_self(), name.substr(0, 15).c_str() ) == 0;
+#else
+    return false;
+#endif
+}
+
+bool setCurrentThreadAffinity(unsigned long long affinityMask)
+{
+#ifdef WIN32
+    DWORD_PTR processMask, systemMask;
+    if ( !GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) ) {
+        return false;
+    }
+
+    DWORD_PTR mask = affinityMask ? DWORD_PTR(affinityMask) : processMask;
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int i = 0; i < 64 && i < CPU_SETSIZE; ++i)
+    {
+        if ( !affinityMask || (affinityMask & (1ULL << i)) ) {
+            CPU_SET(i, &cpuSet);
+        }
+    }
+    return pthread_setaffinity_np( pthread_self(), sizeof(cpuSet), &cpuSet ) == 0;
+#else
+    return affinityMask == 0;
+#endif
+}
+
+unsigned long long getCurrentThreadAffinity()
+{
+#ifdef WIN32
+    // there is no GetThreadAffinityMask, set & restore
+    DWORD_PTR processMask, systemMask;
+    if ( !GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) ) {
+        return 0;
+    }
+
+    DWORD_PTR mask = SetThreadAffinityMask(GetCurrentThread(), processMask);
+    if (mask) {
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
+    return mask;
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    if ( pthread_getaffinity_np( pthread_self(), sizeof(cpuSet), &cpuSet ) != 0 ) {
+        return 0;
+    }
+
+    unsigned long long affinityMask = 0;
+    for (int i = 0; i < 64 && i < CPU_SETSIZE; ++i)
+    {
+        if ( CPU_ISSET(i, &cpuSet) ) {
+            affinityMask |= 1ULL << i;
+        }
+    }
+    return affinityMask;
+#else
+    return 0;
+#endif
+}
+
+bool setCurrentThreadPriority(int priority)
+{
+#ifdef WIN32
+    return SetThreadPriority( GetCurrentThread(), priorityToWindows(priority) ) != 0;
+#else
+    return setpriority( PRIO_PROCESS, currentThreadId(), priority ) == 0;
+#endif
+}
+
+int getCurrentThreadPriority()
+{
+#ifdef WIN32
+    switch ( GetThreadPriority( GetCurrentThread() ) )
+    {
+    case THREAD_PRIORITY_TIME_CRITICAL: return -15;
+    case THREAD_PRIORITY_HIGHEST:       return -10;
+    case THREAD_PRIORITY_ABOVE_NORMAL:  return -5;
+    case THREAD_PRIORITY_BELOW_NORMAL:  return 5;
+    case THREAD_PRIORITY_LOWEST:        return 15;
+    case THREAD_PRIORITY_IDLE:          return 19;
+    default:                            return 0;
+    }
+#else
+    errno = 0;
+    int priority = getpriority( PRIO_PROCESS, currentThreadId() );
+    return errno ? 0 : priority;
+#endif
+}
+
 } // namespace thread
 } // namespace slon
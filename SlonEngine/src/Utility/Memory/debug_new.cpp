@@ -52,6 +52,7 @@
 #include "Utility/Memory/aligned_allocator.hpp"
 #include "Utility/Memory/fast_mutex.h"
 #include "Utility/Memory/static_assert.h"
+#include "Thread/LockStatistics.h"
 
 #if !_FAST_MUTEX_CHECK_INITIALIZATION && !defined(_NOTHREADS)
 #error "_FAST_MUTEX_CHECK_INITIALIZATION not set: check_leaks may not work"
@@ -257,15 +258,20 @@ static new_ptr_list_t new_ptr_list = {
     MAGIC
 };
 
+/**
+ * Mutex type of the guards, collects lock statistics if enabled.
+ */
+typedef slon::thread::instrumented_mutex<fast_mutex> debug_new_mutex;
+
 /**
  * The mutex guard to protect simultaneous access to the pointer list.
  */
-static fast_mutex new_ptr_lock;
+static debug_new_mutex new_ptr_lock("debug_new.ptr");
 
 /**
  * The mutex guard to protect simultaneous output to #new_output_fp.
  */
-static fast_mutex new_output_lock;
+static debug_new_mutex new_output_lock("debug_new.output");
 
 /**
  * Total memory allocated in bytes.
@@ -475,7 +481,7 @@ static void* alloc_mem(size_t size, const char* file, int line, bool is_array, i
 #if _DEBUG_NEW_STD_OPER_NEW
         return NULL;
 #else
-        fast_mutex_autolock lock(new_output_lock);
+        debug_new_mutex::scoped_lock lock(new_output_lock);
         fprintf(new_output_fp,
                 "Out of memory when allocating %lu bytes\n",
                 (unsigned long)size);
@@ -498,7 +504,7 @@ static void* alloc_mem(size_t size, const char* file, int line, bool is_array, i
     ptr->size = size;
     ptr->magic = MAGIC;
     {
-        fast_mutex_autolock lock(new_ptr_lock);
+        debug_new_mutex::scoped_lock lock(new_ptr_lock);
         ptr->prev = new_ptr_list.prev;
         ptr->next = &new_ptr_list;
         new_ptr_list.prev->next = ptr;
@@ -510,7 +516,7 @@ static void* alloc_mem(size_t size, const char* file, int line, bool is_array, i
 #endif
     if (new_verbose_flag)
     {
-        fast_mutex_autolock lock(new_output_lock);
+        debug_new_mutex::scoped_lock lock(new_output_lock);
         fprintf(new_output_fp,
                 "new%s: allocated %p (size %lu, ",
                 is_array ? "[]" : "",
@@ -542,7 +548,7 @@ static void free_pointer(void* pointer, void* addr, bool is_array)
     if (ptr->magic != MAGIC)
     {
         {
-            fast_mutex_autolock lock(new_output_lock);
+            debug_new_mutex::scoped_lock lock(new_output_lock);
             fprintf(new_output_fp, "delete%s: invalid pointer %p (",
                     is_array ? "[]" : "", pointer);
             print_position(addr, 0);
@@ -559,7 +565,7 @@ static void free_pointer(void* pointer, void* addr, bool is_array)
             msg = "delete[] after new";
         else
             msg = "delete after new[]";
-        fast_mutex_autolock lock(new_output_lock);
+        debug_new_mutex::scoped_lock lock(new_output_lock);
         fprintf(new_output_fp,
                 "%s: pointer %p (size %lu)\n\tat ",
                 msg,
@@ -584,7 +590,7 @@ static void free_pointer(void* pointer, void* addr, bool is_array)
     }
 #endif
     {
-        fast_mutex_autolock lock(new_ptr_lock);
+        debug_new_mutex::scoped_lock lock(new_ptr_lock);
         total_mem_alloc -= ptr->size;
         ptr->magic = 0;
         ptr->prev->next = ptr->next;
@@ -592,7 +598,7 @@ static void free_pointer(void* pointer, void* addr, bool is_array)
     }
     if (new_verbose_flag)
     {
-        fast_mutex_autolock lock(new_output_lock);
+        debug_new_mutex::scoped_lock lock(new_output_lock);
         fprintf(new_output_fp,
                 "delete%s: freed %p (size %lu, %lu bytes still allocated)\n",
                 is_array ? "[]" : "",
@@ -611,8 +617,8 @@ static void free_pointer(void* pointer, void* addr, bool is_array)
 int check_leaks()
 {
     int leak_cnt = 0;
-    fast_mutex_autolock lock_ptr(new_ptr_lock);
-    fast_mutex_autolock lock_output(new_output_lock);
+    debug_new_mutex::scoped_lock lock_ptr(new_ptr_lock);
+    debug_new_mutex::scoped_lock lock_output(new_output_lock);
     new_ptr_list_t* ptr = new_ptr_list.next;
     while (ptr != &new_ptr_list)
     {
@@ -657,8 +663,8 @@ int check_leaks()
 int check_mem_corruption()
 {
     int corrupt_cnt = 0;
-    fast_mutex_autolock lock_ptr(new_ptr_lock);
-    fast_mutex_autolock lock_output(new_output_lock);
+    debug_new_mutex::scoped_lock lock_ptr(new_ptr_lock);
+    debug_new_mutex::scoped_lock lock_output(new_output_lock);
     fprintf(new_output_fp, "*** Checking for memory corruption: START\n");
     for (new_ptr_list_t* ptr = new_ptr_list.next;
             ptr != &new_ptr_list;
@@ -717,14 +723,14 @@ void __debug_new_recorder::_M_process(void* pointer)
             (new_ptr_list_t*)((char*)pointer - ALIGNED_LIST_ITEM_SIZE);
     if (ptr->magic != MAGIC || ptr->line != 0)
     {
-        fast_mutex_autolock lock(new_output_lock);
+        debug_new_mutex::scoped_lock lock(new_output_lock);
         fprintf(new_output_fp,
                 "warning: debug_new used with placement new (%s:%d)\n",
                 _M_file, _M_line);
         return;
     }
     if (new_verbose_flag) {
-        fast_mutex_autolock lock(new_output_lock);
+        debug_new_mutex::scoped_lock lock(new_output_lock);
         fprintf(new_output_fp,
                 "info: pointer %p allocated from %s:%d\n",
                 pointer, _M_file, _M_line);
@@ -810,7 +816,7 @@ void operator delete(void* pointer, const char* file, int line) throw()
 {
     if (new_verbose_flag)
     {
-        fast_mutex_autolock lock(new_output_lock);
+        debug_new_mutex::scoped_lock lock(new_output_lock);
         fprintf(new_output_fp,
                 "info: exception thrown on initializing object at %p (",
                 pointer);
@@ -824,7 +830,7 @@ void operator delete[](void* pointer, const char* file, int line) throw()
 {
     if (new_verbose_flag)
     {
-        fast_mutex_autolock lock(new_output_lock);
+        debug_new_mutex::scoped_lock lock(new_output_lock);
         fprintf(new_output_fp,
                 "info: exception thrown on initializing objects at %p (",
                 pointer);
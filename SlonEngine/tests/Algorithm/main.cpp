@@ -0,0 +1,714 @@
+#include "Graphics/Detail/CommandExecutor.h"
+#include "Graphics/Detail/LightGrid.h"
+#include "Graphics/Detail/ShadowSilhouette.h"
+#include "Graphics/Renderable.h"
+#include "Scene/CullVisitor.h"
+#include "Scene/Entity.h"
+#include "Scene/LODGroup.h"
+#include "Scene/LookAtCamera.h"
+#include "Scene/MatrixTransform.h"
+#include "Scene/OcclusionBuffer.h"
+#include "Scene/TransformVisitor.h"
+#include "Thread/ThreadPool.h"
+#include "Utility/Algorithm/aabb_tree.hpp"
+#include "Utility/Algorithm/parallel.hpp"
+#include "Utility/Algorithm/radix_sort.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#define BOOST_TEST_MODULE AlgorithmTest
+#include <boost/test/unit_test.hpp>
+
+using namespace slon;
+
+namespace {
+
+	const size_t num_keys = 1 << 16;
+
+	struct keyed_value
+	{
+		unsigned long long	key;
+		size_t				index;
+	};
+
+	struct value_key
+	{
+		unsigned long long operator () (const keyed_value& value) const { return value.key; }
+	};
+
+	bool less_by_key(const keyed_value& a, const keyed_value& b)
+	{
+		return a.key < b.key;
+	}
+
+	unsigned long long random_key()
+	{
+		return (unsigned long long)(rand()) << 48 ^ (unsigned long long)(rand()) << 24 ^ (unsigned long long)(rand());
+	}
+
+	// boxes of the grid parallel to the view plane
+	math::AABBf grid_box(int x, int y, float depth)
+	{
+		return math::AABBf( float(x) - 0.3f, float(y) - 0.3f, -depth - 1.0f,
+		                    float(x) + 0.3f, float(y) + 0.3f, -depth );
+	}
+
+	// box centered on the -z axis at the distance from the origin
+	math::AABBf depth_box(float halfSize, float depth)
+	{
+		return math::AABBf( -halfSize, -halfSize, -depth - halfSize,
+		                    halfSize, halfSize, -depth + halfSize );
+	}
+
+	// closed torus around z axis, faces are counter clockwise looking from outside
+	void make_torus(unsigned numRings, unsigned numSides, std::vector<math::Vector3f>& vertices, std::vector<unsigned>& indices)
+	{
+		const float pi = 3.1415926f;
+
+		vertices.resize(numRings * numSides);
+		indices.resize(numRings * numSides * 6);
+		for (unsigned i = 0; i<numRings; ++i)
+		{
+			float ringAngle = 2.0f * pi * i / numRings;
+			for (unsigned j = 0; j<numSides; ++j)
+			{
+				float sideAngle = 2.0f * pi * j / numSides;
+				float radius    = 2.0f + 0.5f * std::cos(sideAngle);
+				vertices[i * numSides + j] = math::Vector3f( radius * std::cos(ringAngle), 
+				                                             radius * std::sin(ringAngle), 
+				                                             0.5f * std::sin(sideAngle) );
+
+				unsigned  a    = i * numSides + j;
+				unsigned  b    = ( (i + 1) % numRings ) * numSides + j;
+				unsigned  c    = ( (i + 1) % numRings ) * numSides + (j + 1) % numSides;
+				unsigned  d    = i * numSides + (j + 1) % numSides;
+				unsigned* quad = &indices[(i * numSides + j) * 6];
+				quad[0] = a; quad[1] = b; quad[2] = c;
+				quad[3] = a; quad[4] = c; quad[5] = d;
+			}
+		}
+	}
+
+		size_t numPaired = 0;
+		for (size_t i = 0; i<indices.size(); ++i) {
+			numPaired += edgeMap.count( vertex_pair(indices[i % 3 == 2 ? i - 2 : i + 1], indices[i]) );
+		}
+
+		return numPaired / 2;
+	}
+
+	typedef aabb_tree<unsigned>	object_tree;
+
+	// collect leaves visible by the single view
+	struct collect_leaves
+	{
+		std::vector<unsigned>* leaves;
+
+		bool operator () (unsigned leaf) const
+		{
+			leaves->push_back(leaf);
+			return false;
+		}
+	};
+
+	// collect leaves with the masks of the views seeing them
+	struct collect_masked_leaves
+	{
+		std::vector<unsigned>* leaves;
+		std::vector<unsigned>* masks;
+
+		bool operator () (unsigned leaf, unsigned mask) const
+		{
+			leaves->push_back(leaf);
+			masks->push_back(mask);
+			return false;
+		}
+	};
+
+	// field of the boxes on the xz plane
+	void make_box_field(object_tree& tree, unsigned numBoxes)
+	{
+		for (unsigned i = 0; i<numBoxes; ++i)
+		{
+			float x = 400.0f * rand() / RAND_MAX - 200.0f;
+			float z = 400.0f * rand() / RAND_MAX - 200.0f;
+			tree.insert( math::AABBf(x - 0.5f, 0.0f, z - 0.5f, x + 0.5f, 2.0f, z + 0.5f), i );
+		}
+	}
+
+	// cameras at the center of the field looking around with overlapping frustums
+	void make_ring_cameras(unsigned numCameras, std::vector< boost::intrusive_ptr<scene::LookAtCamera> >& cameras)
+	{
+		for (unsigned i = 0; i<numCameras; ++i)
+		{
+			float angle = 2.0f * 3.1415926f * i / numCameras;
+			boost::intrusive_ptr<scene::LookAtCamera> camera(new scene::LookAtCamera);
+			camera->setPosition( math::Vector3f(0.0f, 1.0f, 0.0f) );
+			camera->setDirection( math::Vector3f( std::sin(angle), 0.0f, -std::cos(angle) ) );
+			camera->setProjectionMatrix( math::Matrix4f::perspective(1.5f, 4.0f / 3.0f, 1.0f, 150.0f) );
+			camera->setViewport( sgl::rectangle(0, 0, 800, 600) );
+			cameras.push_back(camera);
+		}
+	}
+
+	// renderable counting draws
+	class counting_renderable :
+		public graphics::Renderable
+	{
+	public:
+		counting_renderable() : numDraws(0) {}
+
+		void render() const { ++numDraws; }
+
+		graphics::Effect* getEffect() const { return 0; }
+
+		mutable size_t numDraws;
+	};
+
+	// cull visitor exposing projected radius of the bounds
+	class screen_radius_visitor :
+		public scene::CullVisitor
+	{
+	public:
+		explicit screen_radius_visitor(const scene::Camera* camera_) : scene::CullVisitor(camera_) {}
+
+		float screenRadius(const math::AABBf& worldBounds) const { return getScreenRadius(worldBounds, *camera); }
+	};
+
+	// entity having only bounds
+	class box_entity :
+		public scene::Entity
+	{
+	public:
+		explicit box_entity(const math::AABBf& bounds_) : bounds(bounds_) {}
+
+		const math::AABBf& getBounds() const { return bounds; }
+
+	private:
+		math::AABBf bounds;
+	};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(radix_sort_stable)
+{
+	// few distinct keys in the high bits: most passes are skipped, many equal keys
+	std::vector<keyed_value> values(num_keys);
+	for (size_t i = 0; i<values.size(); ++i)
+	{
+		values[i].key   = (unsigned long long)(rand() % 64) << 56;
+		values[i].index = i;
+	}
+
+	std::vector<keyed_value> sorted(values);
+	std::stable_sort(sorted.begin(), sorted.end(), less_by_key);
+
+	std::vector<keyed_value> buffer;
+	radix_sort(values, buffer, value_key());
+	for (size_t i = 0; i<values.size(); ++i)
+	{
+		BOOST_REQUIRE_EQUAL(values[i].key, sorted[i].key);
+		BOOST_REQUIRE_EQUAL(values[i].index, sorted[i].index);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(radix_sort_random_keys)
+{
+	// random keys use every pass
+	std::vector<unsigned long long> keys(num_keys);
+	for (size_t i = 0; i<keys.size(); ++i) {
+		keys[i] = random_key();
+	}
+
+	std::vector<unsigned long long> sorted(keys);
+	std::sort( sorted.begin(), sorted.end() );
+
+	std::vector<unsigned long long> buffer;
+	radix_sort( keys, buffer, radix_key<unsigned long long>() );
+	BOOST_CHECK( keys == sorted );
+}
+
+BOOST_AUTO_TEST_CASE(parallel_aabb_matches_serial)
+{
+	thread::ThreadPool pool(3);
+
+	// homogeneous points with random w, bounds are taken by xyz
+	std::vector<math::Vector4f> points(100003);
+	std::vector<math::Vector3f> points3(points.size());
+	for (size_t i = 0; i<points.size(); ++i)
+	{
+		points[i] = math::Vector4f( 200.0f * rand() / RAND_MAX - 100.0f,
+		                            200.0f * rand() / RAND_MAX - 100.0f,
+		                            200.0f * rand() / RAND_MAX - 100.0f,
+		                            1000.0f * rand() / RAND_MAX );
+		points3[i] = math::xyz(points[i]);
+	}
+
+	math::AABBf serial = compute_aabb<float>(points3.begin(), points3.end());
+	math::AABBf aabbs[] =
+	{
+		parallel_compute_aabb<float>(pool, points3.begin(), points3.end(), 1000),
+		parallel_compute_aabb<float>(pool, points.begin(), points.end(), 1000),
+		compute_aabb<float>(points.begin(), points.end())
+	};
+
+	for (size_t i = 0; i<sizeof(aabbs) / sizeof(aabbs[0]); ++i)
+	{
+		for (int j = 0; j<3; ++j)
+		{
+			BOOST_CHECK_EQUAL(aabbs[i].minVec[j], serial.minVec[j]);
+			BOOST_CHECK_EQUAL(aabbs[i].maxVec[j], serial.maxVec[j]);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(occlusion_culling)
+{
+	// camera at the origin looking along -z, wall occluder in front of the camera
+	scene::OcclusionBuffer occlusionBuffer;
+	occlusionBuffer.setViewProjection( math::Matrix4f::perspective(0.7853982f, 2.0f, 1.0f, 100.0f) );
+	occlusionBuffer.rasterize( math::AABBf(-5.0f, -5.0f, -11.0f, 5.0f, 5.0f, -10.0f) );
+	occlusionBuffer.buildHierarchy();
+
+	// boxes behind the wall are culled, in front of it and around it are not
+	size_t numBehind  = 0;
+	size_t numVisible = 0;
+	for (int x = -4; x <= 4; ++x)
+	{
+		for (int y = -4; y <= 4; ++y)
+		{
+			numBehind  += occlusionBuffer.isOccluded( grid_box(x, y, 20.0f) ) ? 1 : 0;
+			numVisible += occlusionBuffer.isOccluded( grid_box(x, y, 5.0f) ) ? 0 : 1;
+			numVisible += occlusionBuffer.isOccluded( grid_box(x + 30, y, 40.0f) ) ? 0 : 1;
+		}
+	}
+	BOOST_CHECK_EQUAL(numBehind, 81);
+	BOOST_CHECK_EQUAL(numVisible, 162);
+	BOOST_CHECK( !occlusionBuffer.isOccluded( math::AABBf(-30.0f, -1.0f, -41.0f, 30.0f, 1.0f, -40.0f) ) );
+
+	// box crossing the near plane is never occluded
+	BOOST_CHECK( !occlusionBuffer.isOccluded( math::AABBf(-1.0f, -1.0f, -20.0f, 1.0f, 1.0f, 1.0f) ) );
+}
+
+BOOST_AUTO_TEST_CASE(oriented_occluder)
+{
+	// wall rotated by 45 degrees around y, its world bounds cover much more than the wall
+	math::AABBf    wall(-5.0f, -5.0f, -0.5f, 5.0f, 5.0f, 0.5f);
+	math::Matrix4f worldMatrix = math::make_translation(0.0f, 0.0f, -10.0f);
+	worldMatrix[0][0] =  0.7071068f;
+	worldMatrix[0][2] =  0.7071068f;
+	worldMatrix[2][0] = -0.7071068f;
+	worldMatrix[2][2] =  0.7071068f;
+
+	// box in front of the wall but behind the front face of the wall world bounds
+	math::AABBf box(2.3f, -0.2f, -9.2f, 2.7f, 0.2f, -8.8f);
+
+	scene::OcclusionBuffer occlusionBuffer;
+	occlusionBuffer.setViewProjection( math::Matrix4f::perspective(0.7853982f, 2.0f, 1.0f, 100.0f) );
+	occlusionBuffer.rasterize(wall, worldMatrix);
+	occlusionBuffer.buildHierarchy();
+	BOOST_CHECK( !occlusionBuffer.isOccluded(box) );
+
+	// box behind the wall
+	BOOST_CHECK( occlusionBuffer.isOccluded( math::AABBf(-3.2f, -0.2f, -12.2f, -2.8f, 0.2f, -11.8f) ) );
+
+	// world bounds of the wall hide the box
+	occlusionBuffer.setViewProjection( math::Matrix4f::perspective(0.7853982f, 2.0f, 1.0f, 100.0f) );
+	occlusionBuffer.rasterize(worldMatrix * wall);
+	occlusionBuffer.buildHierarchy();
+	BOOST_CHECK( occlusionBuffer.isOccluded(box) );
+}
+
+BOOST_AUTO_TEST_CASE(cull_visitor_screen_area)
+{
+	// camera at the origin looking along -z
+	boost::intrusive_ptr<scene::LookAtCamera> camera(new scene::LookAtCamera);
+	camera->setDirection( math::Vector3f(0.0f, 0.0f, -1.0f) );
+	camera->setProjectionMatrix( math::Matrix4f::perspective(0.7853982f, 4.0f / 3.0f, 1.0f, 1000.0f) );
+	camera->setViewport( sgl::rectangle(0, 0, 800, 600) );
+
+	// bounding sphere radius * cot(fovy / 2) * half viewport height / depth
+	screen_radius_visitor cullVisitor( camera.get() );
+	BOOST_CHECK_CLOSE( cullVisitor.screenRadius( depth_box(0.5f, 10.0f) ), 0.8660254f / 0.4142136f * 300.0f / 10.0f, 0.1f );
+	BOOST_CHECK_EQUAL( cullVisitor.screenRadius( depth_box(2.0f, 0.0f) ), -1.0f );
+
+	// boxes just above and just below the minimum area
+	float radius = cullVisitor.screenRadius( depth_box(0.1f, 10.0f) );
+	cullVisitor.setMinScreenArea(3.1415926f * radius * radius);
+	BOOST_CHECK( cullVisitor.isVisible( depth_box(0.105f, 10.0f) ) );
+	BOOST_CHECK( !cullVisitor.isVisible( depth_box(0.095f, 10.0f) ) );
+
+	// box behind the camera is outside the frustum, box around the camera is never too small
+	BOOST_CHECK( !cullVisitor.isVisible( depth_box(1.0f, -10.0f) ) );
+	BOOST_CHECK( cullVisitor.isVisible( depth_box(2.0f, 0.0f) ) );
+
+	const scene::CullVisitor::STATISTICS& statistics = cullVisitor.getStatistics();
+	BOOST_CHECK_EQUAL(statistics.numTested, 4u);
+	BOOST_CHECK_EQUAL(statistics.numSmallCulled, 1u);
+	BOOST_CHECK_EQUAL(statistics.numFrustumCulled, 1u);
+
+	// 0 disables screen area culling
+	cullVisitor.setMinScreenArea(0.0f);
+	cullVisitor.clear();
+	BOOST_CHECK( cullVisitor.isVisible( depth_box(0.095f, 10.0f) ) );
+	BOOST_CHECK_EQUAL(statistics.numSmallCulled, 0u);
+	BOOST_CHECK_EQUAL(statistics.numFrustumCulled, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(light_grid_binning)
+{
+	using graphics::detail::LightGrid;
+
+	LightGrid lightGrid;
+	lightGrid.setProjection( math::Matrix4f::perspective(0.7853982f, 2.0f, 1.0f, 100.0f) );
+
+	// light in the screen center, light behind the camera
+	math::Vector4f lights[] =
+	{
+		math::Vector4f(0.0f, 0.0f, -20.0f, 1.0f),
+		math::Vector4f(0.0f, 0.0f, 20.0f, 1.0f)
+	};
+	lightGrid.bin(lights, 2);
+
+	unsigned slice = lightGrid.getSlice(20.0f);
+	unsigned x     = LightGrid::cluster_x / 2;
+	unsigned y     = LightGrid::cluster_y / 2;
+	BOOST_REQUIRE_EQUAL(lightGrid.getClusterLightCount(x, y, slice), 1u);
+	BOOST_CHECK_EQUAL(lightGrid.getLightIndex( lightGrid.getClusterOffset(x, y, slice) ), 0u);
+	BOOST_CHECK_EQUAL(lightGrid.getClusterLightCount(0, 0, slice), 0u);
+	BOOST_CHECK_EQUAL(lightGrid.getClusterLightCount(x, y, 0), 0u);
+	BOOST_CHECK_EQUAL(lightGrid.getClusterLightCount(x, y, LightGrid::cluster_z - 1), 0u);
+	BOOST_CHECK(lightGrid.getStatistics().numLightIndices > 0);
+}
+
+BOOST_AUTO_TEST_CASE(lod_level_selection)
+{
+	scene::lod_group_ptr lodGroup(new scene::LODGroup);
+	for (int i = 0; i<3; ++i) {
+		lodGroup->addChild( scene::node_ptr(new scene::Group) );
+	}
+	lodGroup->setLevel( 0, scene::LODGroup::level_desc(0.2f) );
+	lodGroup->setLevel( 1, scene::LODGroup::level_desc(0.05f) );
+	lodGroup->setLevel( 2, scene::LODGroup::level_desc(0.01f) );
+	lodGroup->setHysteresis(0.1f);
+
+	// first selection uses thresholds
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.3f), 0u);
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.15f), 1u);
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.005f), 3u);
+
+	// level is kept within hysteresis band around the threshold
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.19f, 0), 0u);
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.17f, 0), 1u);
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.21f, 1), 1u);
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.23f, 1), 0u);
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.001f, 0), 3u);
+	BOOST_CHECK_EQUAL(lodGroup->selectLevel(0.3f, 3), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(lod_level_bounds)
+{
+	// levels keep entities below transforms, nested group is merged with its own levels
+	scene::lod_group_ptr lodGroup(new scene::LODGroup);
+	scene::matrix_transform_ptr fine( new scene::MatrixTransform( math::Matrix4f::translation(10.0f, 0.0f, 0.0f) ) );
+	fine->addChild( scene::node_ptr( new box_entity( math::AABBf(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f) ) ) );
+	lodGroup->addChild(fine);
+
+	scene::lod_group_ptr nested(new scene::LODGroup);
+	nested->addChild( scene::node_ptr( new box_entity( math::AABBf(-2.0f, -2.0f, -2.0f, -1.0f, -1.0f, -1.0f) ) ) );
+	lodGroup->addChild(nested);
+
+	scene::matrix_transform_ptr root( new scene::MatrixTransform( math::Matrix4f::translation(0.0f, 0.0f, -5.0f) ) );
+	root->addChild(lodGroup);
+	scene::TransformVisitor transformVisitor(*root);
+
+	const math::AABBf& bounds = lodGroup->getWorldBounds();
+	BOOST_CHECK_CLOSE(bounds.minVec.x, -2.0f, 1e-3f);
+	BOOST_CHECK_CLOSE(bounds.maxVec.x, 11.0f, 1e-3f);
+	BOOST_CHECK_CLOSE(bounds.minVec.z, -7.0f, 1e-3f);
+	BOOST_CHECK_CLOSE(bounds.maxVec.z, -4.0f, 1e-3f);
+	BOOST_CHECK_CLOSE(nested->getWorldBounds().maxVec.x, -1.0f, 1e-3f);
+	BOOST_CHECK_CLOSE(transformVisitor.getBounds().maxVec.x, 11.0f, 1e-3f);
+
+	// bounds set by user are kept
+	lodGroup->setBounds( math::AABBf(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f) );
+	transformVisitor.traverse(*root);
+	BOOST_CHECK_CLOSE(lodGroup->getWorldBounds().maxVec.x, 1.0f, 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(lod_triangle_reduction)
+{
+	// row of the LOD groups going away from the camera
+	const size_t num_groups = 50;
+
+	scene::group_ptr					root(new scene::Group);
+	std::vector<scene::lod_group_ptr>	lodGroups;
+	for (size_t i = 0; i<num_groups; ++i)
+	{
+		scene::lod_group_ptr lodGroup(new scene::LODGroup);
+		for (int j = 0; j<3; ++j) {
+			lodGroup->addChild( scene::node_ptr(new scene::Group) );
+		}
+		lodGroup->setLevel( 0, scene::LODGroup::level_desc(0.2f, 1, 10000) );
+		lodGroup->setLevel( 1, scene::LODGroup::level_desc(0.05f, 2, 2500) );
+		lodGroup->setLevel( 2, scene::LODGroup::level_desc(0.01f, 4, 600) );
+		lodGroup->setBounds( math::AABBf(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f) );
+
+		scene::matrix_transform_ptr transform( new scene::MatrixTransform( math::Matrix4f::translation(0.0f, 0.0f, -5.0f - 4.0f * i) ) );
+		transform->addChild(lodGroup);
+		root->addChild(transform);
+		lodGroups.push_back(lodGroup);
+	}
+	scene::TransformVisitor transformVisitor(*root);
+
+	boost::intrusive_ptr<scene::LookAtCamera> camera(new scene::LookAtCamera);
+	camera->setDirection( math::Vector3f(0.0f, 0.0f, -1.0f) );
+	camera->setProjectionMatrix( math::Matrix4f::perspective(0.7853982f, 4.0f / 3.0f, 1.0f, 1000.0f) );
+	camera->setViewport( sgl::rectangle(0, 0, 800, 600) );
+
+	scene::CullVisitor cullVisitor( camera.get() );
+	cullVisitor.traverse(*root);
+
+	const scene::CullVisitor::STATISTICS& statistics = cullVisitor.getStatistics();
+	BOOST_CHECK_EQUAL(statistics.numLODSelections, num_groups);
+	BOOST_CHECK_EQUAL(statistics.numLODBaseTriangles, num_groups * 10000);
+	BOOST_CHECK(statistics.numLODTriangles < statistics.numLODBaseTriangles / 2);
+	BOOST_CHECK_EQUAL(lodGroups.front()->getUpdateInterval(), 1u);
+	BOOST_CHECK_EQUAL(lodGroups.back()->getUpdateInterval(), 4u);
+
+	// same view doesn't switch levels
+	cullVisitor.clear();
+	cullVisitor.traverse(*root);
+	BOOST_CHECK_EQUAL(statistics.numLODSwitches, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(shadow_silhouette_extraction)
+{
+	using graphics::detail::ShadowSilhouette;
+
+	std::vector<math::Vector3f> vertices;
+	std::vector<unsigned>       indices;
+	make_torus(64, 32, vertices, indices);
+
+	thread::ThreadPool pool;
+	ShadowSilhouette   silhouette;
+	silhouette.setup( pool, &vertices[0], vertices.size(), &indices[0], indices.size() );
+
+	// closed mesh, every edge has two faces
+	const ShadowSilhouette::edge_vector& edges = silhouette.getEdges();
+	BOOST_REQUIRE_EQUAL(edges.size(), indices.size() / 2);
+	size_t numOpen = 0;
+	for (size_t i = 0; i<edges.size(); ++i) {
+		numOpen += (edges[i].face1 == ShadowSilhouette::invalid_face) ? 1 : 0;
+	}
+	BOOST_CHECK_EQUAL(numOpen, 0u);
+
+	// light above the torus lights upper half of the faces
+	BOOST_CHECK( silhouette.extract( math::Vector4f(0.0f, 0.0f, 100.0f, 1.0f) ) );
+	size_t numLit = 0;
+	for (unsigned i = 0; i<silhouette.getNumFaces(); ++i) {
+		numLit += silhouette.isLit(i) ? 1 : 0;
+	}
+	BOOST_CHECK(numLit > 0 && numLit < silhouette.getNumFaces());
+	BOOST_CHECK(silhouette.getNumSilhouetteEdges() > 0);
+	BOOST_CHECK_EQUAL( silhouette.getNumVertices(), (silhouette.getNumSilhouetteEdges() * 2 + numLit * 2) * 3 );
+
+	// same light reuses volume, moved light rebuilds it
+	BOOST_CHECK( !silhouette.extract( math::Vector4f(0.0f, 0.0f, 100.0f, 1.0f) ) );
+	BOOST_CHECK( silhouette.extract( math::Vector4f(10.0f, 0.0f, 10.0f, 1.0f) ) );
+	BOOST_CHECK_EQUAL(silhouette.getStatistics().numCached, 1u);
+
+	// directional light has no dark cap
+	BOOST_CHECK( silhouette.extract( math::Vector4f(1.0f, 0.0f, 1.0f, 0.0f), false ) );
+	BOOST_CHECK_EQUAL( silhouette.getNumVertices(), silhouette.getNumSilhouetteEdges() * 6 );
+}
+
+BOOST_AUTO_TEST_CASE(shadow_silhouette_adjacency)
+{
+	using graphics::detail::ShadowSilhouette;
+
+	std::vector<math::Vector3f> vertices;
+	std::vector<unsigned>       indices;
+	make_torus(16, 8, vertices, indices);
+	size_t numFaces = indices.size() / 3;
+
+	// fin sharing the edge of the first face, degenerate face
+	unsigned a = indices[0];
+	unsigned b = indices[1];
+	vertices.push_back( math::Vector3f(0.0f, 0.0f, 5.0f) );
+	indices.push_back(a);
+	indices.push_back(b);
+	indices.push_back( unsigned(vertices.size() - 1) );
+	indices.push_back(a);
+	indices.push_back(a);
+	indices.push_back(b);
+
+	thread::ThreadPool pool;
+	ShadowSilhouette   silhouette;
+	silhouette.setup( pool, &vertices[0], vertices.size(), &indices[0], indices.size() );
+
+	// fin edges are open, torus edges stay paired
+	BOOST_CHECK_EQUAL(silhouette.getNumNonManifoldEdges(), 1u);
+	BOOST_CHECK_EQUAL(silhouette.getNumOpenEdges(), 3u);
+	BOOST_CHECK_EQUAL(silhouette.getEdges().size(), numFaces * 3 / 2 + 3);
+	BOOST_CHECK( silhouette.extract( math::Vector4f(0.0f, 0.0f, 100.0f, 1.0f) ) );
+	BOOST_CHECK(silhouette.getNumSilhouetteEdges() > 0);
+
+	// open mesh
+	std::vector<math::Vector3f> quad;
+	quad.push_back( math::Vector3f(0.0f, 0.0f, 0.0f) );
+	quad.push_back( math::Vector3f(1.0f, 0.0f, 0.0f) );
+	quad.push_back( math::Vector3f(1.0f, 1.0f, 0.0f) );
+	quad.push_back( math::Vector3f(0.0f, 1.0f, 0.0f) );
+	unsigned quadIndices[] = { 0, 1, 2, 0, 2, 3 };
+	silhouette.setup( pool, &quad[0], quad.size(), quadIndices, 6 );
+	BOOST_CHECK_EQUAL(silhouette.getEdges().size(), 5u);
+	BOOST_CHECK_EQUAL(silhouette.getNumOpenEdges(), 4u);
+	BOOST_CHECK( silhouette.extract( math::Vector4f(0.5f, 0.5f, 10.0f, 1.0f) ) );
+	BOOST_CHECK_EQUAL(silhouette.getNumSilhouetteEdges(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(shadow_silhouette_setup_threads)
+{
+	using graphics::detail::ShadowSilhouette;
+
+	std::vector<math::Vector3f> vertices;
+	std::vector<unsigned>       indices;
+	make_torus(64, 32, vertices, indices);
+
+	thread::ThreadPool serialPool(0);
+	ShadowSilhouette   serialSilhouette;
+	serialSilhouette.setup( serialPool, &vertices[0], vertices.size(), &indices[0], indices.size() );
+
+	thread::ThreadPool pool;
+	ShadowSilhouette   silhouette;
+	silhouette.setup( pool, &vertices[0], vertices.size(), &indices[0], indices.size() );
+
+	// result doesn't depend on the number of threads
+	const ShadowSilhouette::edge_vector& serialEdges = serialSilhouette.getEdges();
+	const ShadowSilhouette::edge_vector& edges       = silhouette.getEdges();
+	BOOST_REQUIRE_EQUAL(edges.size(), serialEdges.size());
+	BOOST_CHECK_EQUAL(edges.size(), indices.size() / 2);
+	BOOST_CHECK_EQUAL(silhouette.getNumOpenEdges(), 0u);
+	size_t numMismatches = 0;
+	for (size_t i = 0; i<edges.size(); ++i)
+	{
+		numMismatches += ( edges[i].v0 != serialEdges[i].v0 
+		                   || edges[i].face0 != serialEdges[i].face0 
+		                   || edges[i].face1 != serialEdges[i].face1 ) ? 1 : 0;
+	}
+	BOOST_CHECK_EQUAL(numMismatches, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(multi_view_traversal)
+{
+	const unsigned num_boxes   = 4096;
+	const unsigned num_cameras = 6;
+
+	object_tree tree;
+	make_box_field(tree, num_boxes);
+
+	std::vector< boost::intrusive_ptr<scene::LookAtCamera> > cameras;
+	make_ring_cameras(num_cameras, cameras);
+
+	const math::Frustumf* frustums[num_cameras];
+	for (unsigned i = 0; i<num_cameras; ++i) {
+		frustums[i] = &cameras[i]->getFrustum();
+	}
+
+	std::vector<unsigned> leaves;
+	std::vector<unsigned> masks;
+	collect_masked_leaves collectMasked = { &leaves, &masks };
+	perform_on_leaves(tree, frustums, num_cameras, collectMasked);
+
+	// every view of the shared traversal must see the same leaves as the separate traversal
+	for (unsigned i = 0; i<num_cameras; ++i)
+	{
+		std::vector<unsigned> viewLeaves;
+		collect_leaves collect = { &viewLeaves };
+		perform_on_leaves(tree, *frustums[i], collect);
+
+		std::vector<unsigned> maskedLeaves;
+		for (size_t j = 0; j<leaves.size(); ++j)
+		{
+			if ( masks[j] & (1u << i) ) {
+				maskedLeaves.push_back(leaves[j]);
+			}
+		}
+
+		std::sort( viewLeaves.begin(), viewLeaves.end() );
+		std::sort( maskedLeaves.begin(), maskedLeaves.end() );
+		BOOST_CHECK(!viewLeaves.empty());
+		BOOST_CHECK(viewLeaves == maskedLeaves);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(command_buffer_recording)
+{
+	using graphics::detail::CommandBuffer;
+
+	counting_renderable		renderables[4];
+	math::Matrix4f			worldMatrices[4];
+	const graphics::Pass*	pass = reinterpret_cast<const graphics::Pass*>(&renderables[0]); // never dereferenced
+
+	// three packets using matrix of the effect, then four packets of the shared effect setting own matrix
+	graphics::detail::RenderQueue renderQueue;
+	for (int i = 1; i<4; ++i) {
+		renderQueue.push(0, pass, &renderables[i]);
+	}
+	for (int i = 0; i<4; ++i) {
+		renderQueue.push(0, pass, &renderables[i % 2], &worldMatrices[i]);
+	}
+
+	CommandBuffer commandBuffer;
+	commandBuffer.pushStates();
+	commandBuffer.recordPackets(0, 1, renderQueue.begin(), renderQueue.end());
+	commandBuffer.popStates();
+
+	graphics::detail::NullCommandExecutor executor;
+	executor.execute(commandBuffer);
+
+	const graphics::detail::CommandExecutor::STATISTICS& statistics = executor.getStatistics();
+	BOOST_CHECK_EQUAL(statistics.numBuffers, 1u);
+	BOOST_CHECK_EQUAL(statistics.numCommands[CommandBuffer::PUSH_STATES], 1u);
+	BOOST_CHECK_EQUAL(statistics.numCommands[CommandBuffer::POP_STATES], 1u);
+	BOOST_CHECK_EQUAL(statistics.numCommands[CommandBuffer::BEGIN_PASS], 7u);
+	BOOST_CHECK_EQUAL(statistics.numCommands[CommandBuffer::DRAW], 7u);
+	BOOST_CHECK_EQUAL(statistics.numCommands[CommandBuffer::END_PASS], 7u);
+	BOOST_CHECK_EQUAL(statistics.numCommands[CommandBuffer::BEGIN_WORLD_MATRICES], 1u);
+	BOOST_CHECK_EQUAL(statistics.numCommands[CommandBuffer::WORLD_MATRIX], 4u);
+	BOOST_CHECK_EQUAL(statistics.numCommands[CommandBuffer::END_WORLD_MATRICES], 1u);
+
+	// null executor doesn't touch renderables
+	for (int i = 0; i<4; ++i) {
+		BOOST_CHECK_EQUAL(renderables[i].numDraws, 0u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(render_queue_depth_order)
+{
+	using graphics::detail::RenderQueue;
+
+	counting_renderable		renderables[4];
+	math::Matrix4f			worldMatrices[5];
+	const graphics::Pass*	pass = reinterpret_cast<const graphics::Pass*>(&renderables[0]); // never dereferenced
+
+	// opaque packets of the pass are drawn front to back, repeated renderables included
+	RenderQueue renderQueue;
+	renderQueue.push(RenderQueue::makeKey(1, 0, pass, 5.0f), pass, &renderables[3], &worldMatrices[4]);
+	renderQueue.push(RenderQueue::makeKey(1, 0, pass, 4.0f), pass, &renderables[0], &worldMatrices[3]);
+	renderQueue.push(RenderQueue::makeKey(1, 0, pass, 3.0f), pass, &renderables[2], &worldMatrices[2]);
+	renderQueue.push(RenderQueue::makeKey(1, 0, pass, 2.0f), pass, &renderables[0], &worldMatrices[1]);
+	renderQueue.push(RenderQueue::makeKey(1, 0, pass, 1.0f), pass, &renderables[1], &worldMatrices[0]);
+	renderQueue.sort();
+
+	const graphics::Renderable* expected[] = { &renderables[1], &renderables[0], &renderables[2], &renderables[0], &renderables[3] };
+	for (int i = 0; i<5; ++i) 
+	{
+		BOOST_CHECK_EQUAL(renderQueue.begin()[i].renderable, expected[i]);
+		BOOST_CHECK(renderQueue.begin()[i].worldMatrix == &worldMatrices[i]);
+	}
+	BOOST_CHECK_EQUAL(renderQueue.getStatistics().numPassSwitches, 0u);
+}
@@ -0,0 +1,419 @@
+#include "Graphics/Detail/LightGrid.h"
+#include "Graphics/Detail/ShadowSilhouette.h"
+#include "Scene/CullVisitor.h"
+#include "Scene/LODGroup.h"
+#include "Scene/LookAtCamera.h"
+#include "Scene/MatrixTransform.h"
+#include "Scene/OcclusionBuffer.h"
+#include "Scene/TransformVisitor.h"
+#include "Thread/StartStopTimer.h"
+#include "Thread/ThreadPool.h"
+#include "Utility/Algorithm/aabb_tree.hpp"
+#include "Utility/Algorithm/radix_sort.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#define BOOST_TEST_MODULE BenchmarkTest
+#include <boost/test/unit_test.hpp>
+
+using namespace slon;
+
+namespace {
+
+	const size_t num_keys = 1 << 16;
+
+	unsigned long long random_key()
+	{
+		return (unsigned long long)(rand()) << 48 ^ (unsigned long long)(rand()) << 24 ^ (unsigned long long)(rand());
+	}
+
+	// boxes of the grid parallel to the view plane
+	math::AABBf grid_box(int x, int y, float depth)
+	{
+		return math::AABBf( float(x) - 0.3f, float(y) - 0.3f, -depth - 1.0f,
+		                    float(x) + 0.3f, float(y) + 0.3f, -depth );
+	}
+
+	// random view space point light in front of the camera
+	math::Vector4f random_light()
+	{
+		float depth = 2.0f + 98.0f * rand() / RAND_MAX;
+		return math::Vector4f( depth * (2.0f * rand() / RAND_MAX - 1.0f),
+		                       depth * (1.0f * rand() / RAND_MAX - 0.5f),
+		                       -depth,
+		                       1.0f + 4.0f * rand() / RAND_MAX );
+	}
+
+	// closed torus around z axis, faces are counter clockwise looking from outside
+	void make_torus(unsigned numRings, unsigned numSides, std::vector<math::Vector3f>& vertices, std::vector<unsigned>& indices)
+	{
+		const float pi = 3.1415926f;
+
+		vertices.resize(numRings * numSides);
+		indices.resize(numRings * numSides * 6);
+		for (unsigned i = 0; i<numRings; ++i)
+		{
+			float ringAngle = 2.0f * pi * i / numRings;
+			for (unsigned j = 0; j<numSides; ++j)
+			{
+				float sideAngle = 2.0f * pi * j / numSides;
+				float radius    = 2.0f + 0.5f * std::cos(sideAngle);
+				vertices[i * numSides + j] = math::Vector3f( radius * std::cos(ringAngle), 
+				                                             radius * std::sin(ringAngle), 
+				                                             0.5f * std::sin(sideAngle) );
+
+				unsigned  a    = i * numSides + j;
+				unsigned  b    = ( (i + 1) % numRings ) * numSides + j;
+				unsigned  c    = ( (i + 1) % numRings ) * numSides + (j + 1) % numSides;
+				unsigned  d    = i * numSides + (j + 1) % numSides;
+				unsigned* quad = &indices[(i * numSides + j) * 6];
+				quad[0] = a; quad[1] = b; quad[2] = c;
+				quad[3] = a; quad[4] = c; quad[5] = d;
+			}
+		}
+	}
+
+	// edge pairing by the ordered map of the directed edges, as shadow volumes were built before
+	size_t map_adjacency(const std::vector<unsigned>& indices)
+	{
+		typedef std::pair<unsigned, unsigned>	vertex_pair;
+		typedef std::map<vertex_pair, size_t>	edge_map;
+
+		edge_map edgeMap;
+		for (size_t i = 0; i<indices.size(); ++i) {
+			edgeMap.insert( edge_map::value_type( vertex_pair(indices[i], indices[i % 3 == 2 ? i - 2 : i + 1]), i ) );
+		}
+
+		size_t numPaired = 0;
+		for (size_t i = 0; i<indices.size(); ++i) {
+			numPaired += edgeMap.count( vertex_pair(indices[i % 3 == 2 ? i - 2 : i + 1], indices[i]) );
+		}
+
+		return numPaired / 2;
+	}
+
+	typedef aabb_tree<unsigned>	object_tree;
+
+	// collect leaves visible by the single view
+	struct collect_leaves
+	{
+		std::vector<unsigned>* leaves;
+
+		bool operator () (unsigned leaf) const
+		{
+			leaves->push_back(leaf);
+			return false;
+		}
+	};
+
+	// collect leaves with the masks of the views seeing them
+	struct collect_masked_leaves
+	{
+		std::vector<unsigned>* leaves;
+		std::vector<unsigned>* masks;
+
+		bool operator () (unsigned leaf, unsigned mask) const
+		{
+			leaves->push_back(leaf);
+			masks->push_back(mask);
+			return false;
+		}
+	};
+
+	// field of the boxes on the xz plane
+	void make_box_field(object_tree& tree, unsigned numBoxes)
+	{
+		for (unsigned i = 0; i<numBoxes; ++i)
+		{
+			float x = 400.0f * rand() / RAND_MAX - 200.0f;
+			float z = 400.0f * rand() / RAND_MAX - 200.0f;
+			tree.insert( math::AABBf(x - 0.5f, 0.0f, z - 0.5f, x + 0.5f, 2.0f, z + 0.5f), i );
+		}
+	}
+
+	// cameras at the center of the field looking around with overlapping frustums
+	void make_ring_cameras(unsigned numCameras, std::vector< boost::intrusive_ptr<scene::LookAtCamera> >& cameras)
+	{
+		for (unsigned i = 0; i<numCameras; ++i)
+		{
+			float angle = 2.0f * 3.1415926f * i / numCameras;
+			boost::intrusive_ptr<scene::LookAtCamera> camera(new scene::LookAtCamera);
+			camera->setPosition( math::Vector3f(0.0f, 1.0f, 0.0f) );
+			camera->setDirection( math::Vector3f( std::sin(angle), 0.0f, -std::cos(angle) ) );
+			camera->setProjectionMatrix( math::Matrix4f::perspective(1.5f, 4.0f / 3.0f, 1.0f, 150.0f) );
+			camera->setViewport( sgl::rectangle(0, 0, 800, 600) );
+			cameras.push_back(camera);
+		}
+	}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(radix_sort_benchmark)
+{
+	std::vector<unsigned long long> keys(num_keys);
+	for (size_t i = 0; i<keys.size(); ++i) {
+		keys[i] = random_key();
+	}
+
+	std::vector<unsigned long long> sorted(keys);
+	std::vector<unsigned long long> buffer;
+
+	StartStopTimer timer;
+	timer.start();
+	radix_sort( keys, buffer, radix_key<unsigned long long>() );
+	double radixTime = timer.getTime();
+
+	timer.start();
+	std::sort( sorted.begin(), sorted.end() );
+	double sortTime = timer.getTime();
+
+	BOOST_CHECK( keys == sorted );
+	std::cout << "keys\tradix_sort (s)\tstd::sort (s)" << std::endl
+	          << num_keys << "\t" << radixTime << "\t" << sortTime << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(occlusion_culling_benchmark)
+{
+	// occluder rasterization and box tests, camera at the origin looking along -z
+	const size_t num_frames = 100;
+
+	scene::OcclusionBuffer occlusionBuffer;
+	for (size_t i = 0; i<num_frames; ++i)
+	{
+		occlusionBuffer.setViewProjection( math::Matrix4f::perspective(0.7853982f, 2.0f, 1.0f, 100.0f) );
+		for (int j = 0; j<16; ++j) {
+			occlusionBuffer.rasterize( math::AABBf(-20.0f + 2.5f * j, -5.0f, -12.0f - j, -18.0f + 2.5f * j, 5.0f, -10.0f - j) );
+		}
+		occlusionBuffer.buildHierarchy();
+
+		for (int x = -16; x <= 16; ++x)
+		{
+			for (int y = -16; y <= 16; ++y) {
+				occlusionBuffer.isOccluded( grid_box(x, y, 50.0f) );
+			}
+		}
+	}
+
+	const scene::OcclusionBuffer::STATISTICS& statistics = occlusionBuffer.getStatistics();
+	BOOST_CHECK(statistics.numCulled > 0 && statistics.numCulled < statistics.numTested);
+	std::cout << "frames\ttriangles\ttested\tculled\trasterize (s)\ttest (s)" << std::endl
+	          << num_frames << "\t" 
+	          << statistics.numOccluderTriangles << "\t" 
+	          << statistics.numTested << "\t" 
+	          << statistics.numCulled << "\t" 
+	          << statistics.rasterizeTime << "\t" 
+	          << statistics.testTime << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(light_grid_benchmark)
+{
+	using graphics::detail::LightGrid;
+
+	// lights per pass of the LightingEffect: per light type passes and clustered pass
+	const size_t forward_lights_per_pass   = 3;
+	const size_t clustered_lights_per_pass = 32;
+	const size_t num_frames                = 100;
+
+	std::cout << "lights\tforward passes\tclustered passes\tlight indices\tbin (s)" << std::endl;
+	for (size_t numLights = 4; numLights <= 1024; numLights *= 4)
+	{
+		std::vector<math::Vector4f> lights(numLights);
+		for (size_t i = 0; i<lights.size(); ++i) {
+			lights[i] = random_light();
+		}
+
+		LightGrid lightGrid;
+		lightGrid.setProjection( math::Matrix4f::perspective(0.7853982f, 2.0f, 1.0f, 100.0f) );
+		for (size_t i = 0; i<num_frames; ++i)
+		{
+			for (size_t j = 0; j<numLights; j += clustered_lights_per_pass) {
+				lightGrid.bin( &lights[j], std::min(clustered_lights_per_pass, numLights - j) );
+			}
+		}
+
+		const LightGrid::STATISTICS& statistics = lightGrid.getStatistics();
+		BOOST_CHECK_EQUAL(statistics.numLights, numLights * num_frames);
+		std::cout << numLights << "\t" 
+		          << (numLights + forward_lights_per_pass - 1) / forward_lights_per_pass << "\t"
+		          << (numLights + clustered_lights_per_pass - 1) / clustered_lights_per_pass << "\t"
+		          << statistics.numLightIndices / num_frames << "\t"
+		          << statistics.binTime / num_frames << std::endl;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(lod_triangle_reduction_benchmark)
+{
+	// row of the LOD groups going away from the camera
+	const size_t num_groups = 50;
+
+	scene::group_ptr root(new scene::Group);
+	for (size_t i = 0; i<num_groups; ++i)
+	{
+		scene::lod_group_ptr lodGroup(new scene::LODGroup);
+		for (int j = 0; j<3; ++j) {
+			lodGroup->addChild( scene::node_ptr(new scene::Group) );
+		}
+		lodGroup->setLevel( 0, scene::LODGroup::level_desc(0.2f, 1, 10000) );
+		lodGroup->setLevel( 1, scene::LODGroup::level_desc(0.05f, 2, 2500) );
+		lodGroup->setLevel( 2, scene::LODGroup::level_desc(0.01f, 4, 600) );
+		lodGroup->setBounds( math::AABBf(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f) );
+
+		scene::matrix_transform_ptr transform( new scene::MatrixTransform( math::Matrix4f::translation(0.0f, 0.0f, -5.0f - 4.0f * i) ) );
+		transform->addChild(lodGroup);
+		root->addChild(transform);
+	}
+	scene::TransformVisitor transformVisitor(*root);
+
+	boost::intrusive_ptr<scene::LookAtCamera> camera(new scene::LookAtCamera);
+	camera->setDirection( math::Vector3f(0.0f, 0.0f, -1.0f) );
+	camera->setProjectionMatrix( math::Matrix4f::perspective(0.7853982f, 4.0f / 3.0f, 1.0f, 1000.0f) );
+	camera->setViewport( sgl::rectangle(0, 0, 800, 600) );
+
+	scene::CullVisitor cullVisitor( camera.get() );
+	cullVisitor.traverse(*root);
+
+	const scene::CullVisitor::STATISTICS& statistics = cullVisitor.getStatistics();
+	BOOST_CHECK(statistics.numLODTriangles < statistics.numLODBaseTriangles);
+	std::cout << "groups\tbase triangles\tlod triangles\tculled" << std::endl
+	          << statistics.numLODSelections << "\t"
+	          << statistics.numLODBaseTriangles << "\t"
+	          << statistics.numLODTriangles << "\t"
+	          << statistics.numLODCulled << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(shadow_silhouette_extraction_benchmark)
+{
+	using graphics::detail::ShadowSilhouette;
+
+	std::vector<math::Vector3f> vertices;
+	std::vector<unsigned>       indices;
+	make_torus(64, 32, vertices, indices);
+
+	thread::ThreadPool pool;
+	ShadowSilhouette   silhouette;
+	silhouette.setup( pool, &vertices[0], vertices.size(), &indices[0], indices.size() );
+
+	// compare with the volume extruding degenerate quads of every edge
+	const size_t num_frames = 100;
+	for (size_t i = 0; i<num_frames; ++i) {
+		silhouette.extract( math::Vector4f(20.0f * std::cos(0.1f * i), 20.0f * std::sin(0.1f * i), 10.0f, 1.0f) );
+	}
+
+	const ShadowSilhouette::STATISTICS& statistics = silhouette.getStatistics();
+	size_t fullTriangles = silhouette.getNumFaces() * 4;
+	BOOST_CHECK(statistics.numTriangles / num_frames < fullTriangles);
+	std::cout << "faces\tfull volume triangles\tsilhouette edges\tvolume triangles\textract (s)" << std::endl
+	          << silhouette.getNumFaces() << "\t"
+	          << fullTriangles << "\t"
+	          << statistics.numSilhouetteEdges / num_frames << "\t"
+	          << statistics.numTriangles / num_frames << "\t"
+	          << statistics.extractTime / num_frames << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(shadow_silhouette_setup_benchmark)
+{
+	using graphics::detail::ShadowSilhouette;
+
+	thread::ThreadPool serialPool(0);
+	thread::ThreadPool pool;
+
+	std::cout << "faces\tmap (s)\tsorted, 1 thread (s)\tsorted, " << pool.getNumWorkers() + 1 << " threads (s)" << std::endl;
+	for (unsigned numRings = 128; numRings <= 1024; numRings *= 2)
+	{
+		std::vector<math::Vector3f> vertices;
+		std::vector<unsigned>       indices;
+		make_torus(numRings, numRings / 2, vertices, indices);
+
+		StartStopTimer timer;
+		timer.start();
+		size_t numMapEdges = map_adjacency(indices);
+		double mapTime     = timer.getTime();
+
+		ShadowSilhouette serialSilhouette;
+		serialSilhouette.setup( serialPool, &vertices[0], vertices.size(), &indices[0], indices.size() );
+
+		ShadowSilhouette silhouette;
+		silhouette.setup( pool, &vertices[0], vertices.size(), &indices[0], indices.size() );
+
+		// result doesn't depend on the number of threads
+		const ShadowSilhouette::edge_vector& serialEdges = serialSilhouette.getEdges();
+		const ShadowSilhouette::edge_vector& edges       = silhouette.getEdges();
+		BOOST_REQUIRE_EQUAL(edges.size(), serialEdges.size());
+		BOOST_CHECK_EQUAL(edges.size(), numMapEdges);
+		BOOST_CHECK_EQUAL(silhouette.getNumOpenEdges(), 0u);
+		size_t numMismatches = 0;
+		for (size_t i = 0; i<edges.size(); ++i)
+		{
+			numMismatches += ( edges[i].v0 != serialEdges[i].v0 
+			                   || edges[i].face0 != serialEdges[i].face0 
+			                   || edges[i].face1 != serialEdges[i].face1 ) ? 1 : 0;
+		}
+		BOOST_CHECK_EQUAL(numMismatches, 0u);
+
+		std::cout << indices.size() / 3 << "\t"
+		          << mapTime << "\t"
+		          << serialSilhouette.getStatistics().setupTime << "\t"
+		          << silhouette.getStatistics().setupTime << std::endl;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(multi_view_traversal_benchmark)
+{
+	const unsigned num_boxes      = 65536;
+	const unsigned num_cameras    = 6;
+	const unsigned num_iterations = 20;
+
+	object_tree tree;
+	make_box_field(tree, num_boxes);
+
+	std::vector< boost::intrusive_ptr<scene::LookAtCamera> > cameras;
+	make_ring_cameras(num_cameras, cameras);
+
+	const math::Frustumf* frustums[num_cameras];
+	for (unsigned i = 0; i<num_cameras; ++i) {
+		frustums[i] = &cameras[i]->getFrustum();
+	}
+
+	std::vector<unsigned> leaves;
+	std::vector<unsigned> masks;
+	leaves.reserve(num_boxes * num_cameras);
+	masks.reserve(num_boxes);
+
+	StartStopTimer timer;
+	timer.start();
+	for (unsigned i = 0; i<num_iterations; ++i)
+	{
+		leaves.clear();
+		collect_leaves collect = { &leaves };
+		for (unsigned j = 0; j<num_cameras; ++j) {
+			perform_on_leaves(tree, *frustums[j], collect);
+		}
+	}
+	double separateTime = timer.getTime() / num_iterations;
+	size_t numSeparate  = leaves.size();
+
+	timer.start();
+	for (unsigned i = 0; i<num_iterations; ++i)
+	{
+		leaves.clear();
+		masks.clear();
+		collect_masked_leaves collectMasked = { &leaves, &masks };
+		perform_on_leaves(tree, frustums, num_cameras, collectMasked);
+	}
+	double sharedTime = timer.getTime() / num_iterations;
+
+	// shared traversal visits every leaf once
+	BOOST_CHECK(leaves.size() <= numSeparate);
+
+	std::cout << "views\tseparate leaves\tshared leaves\tseparate time\tshared time\tsaved" << std::endl
+	          << num_cameras << "\t"
+	          << numSeparate << "\t"
+	          << leaves.size() << "\t"
+	          << separateTime << "\t"
+	          << sharedTime << "\t"
+	          << separateTime - sharedTime << std::endl;
+}
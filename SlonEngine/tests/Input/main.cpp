@@ -0,0 +1,112 @@
+#include "Input/Detail/InputRecord.h"
+#include <cstdio>
+#include <vector>
+
+#define BOOST_TEST_MODULE InputTest
+#include <boost/test/unit_test.hpp>
+
+using namespace slon;
+using namespace slon::input;
+
+namespace {
+
+	KeyboardEvent make_keyboard_event(key_sym key, KeyboardEvent::key_state state, key_modifier modifier)
+	{
+		KeyboardEvent event;
+		event.key      = key;
+		event.state    = state;
+		event.modifier = modifier;
+		return event;
+	}
+
+	MouseEvent make_mouse_event(mouse_button button, MouseEvent::button_state state, int x, int y, int xrel, int yrel)
+	{
+		MouseEvent event;
+		event.button      = button;
+		event.buttonState = state;
+		event.x           = x;
+		event.y           = y;
+		event.xrel        = xrel;
+		event.yrel        = yrel;
+		return event;
+	}
+
+	void check_equal(const InputEvent& lhs, const InputEvent& rhs)
+	{
+		if ( const KeyboardEvent* keyboardEvent = lhs.asKeyboardEvent() )
+		{
+			BOOST_REQUIRE( rhs.asKeyboardEvent() );
+			BOOST_CHECK_EQUAL( keyboardEvent->key, rhs.asKeyboardEvent()->key );
+			BOOST_CHECK_EQUAL( keyboardEvent->state, rhs.asKeyboardEvent()->state );
+			BOOST_CHECK_EQUAL( keyboardEvent->modifier, rhs.asKeyboardEvent()->modifier );
+		}
+		else
+		{
+			const MouseEvent* mouseEvent = lhs.asMouseEvent();
+			BOOST_REQUIRE( mouseEvent && rhs.asMouseEvent() );
+			BOOST_CHECK_EQUAL( mouseEvent->button, rhs.asMouseEvent()->button );
+			BOOST_CHECK_EQUAL( mouseEvent->buttonState, rhs.asMouseEvent()->buttonState );
+			BOOST_CHECK_EQUAL( mouseEvent->x, rhs.asMouseEvent()->x );
+			BOOST_CHECK_EQUAL( mouseEvent->y, rhs.asMouseEvent()->y );
+			BOOST_CHECK_EQUAL( mouseEvent->xrel, rhs.asMouseEvent()->xrel );
+			BOOST_CHECK_EQUAL( mouseEvent->yrel, rhs.asMouseEvent()->yrel );
+		}
+	}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(input_record_round_trip)
+{
+	using detail::InputPlayer;
+	using detail::InputRecorder;
+
+	const char* fileName = "./test_input.rec";
+
+	// frames with keyboard, mouse and no events
+	std::vector<KeyboardEvent> keyboardEvents;
+	keyboardEvents.push_back( make_keyboard_event(KEY_a, KeyboardEvent::DOWN, KMOD_LSHIFT) );
+	keyboardEvents.push_back( make_keyboard_event(KEY_a, KeyboardEvent::UP, KMOD_NONE) );
+
+	std::vector<MouseEvent> mouseEvents;
+	mouseEvents.push_back( make_mouse_event(MBUTTON_LEFT, MouseEvent::DOWN, 320, 240, 0, 0) );
+	mouseEvents.push_back( make_mouse_event(MBUTTON_NONE, MouseEvent::UP, 310, 250, -10, 10) );
+
+	std::vector< std::vector<const InputEvent*> > frames(4);
+	frames[0].push_back(&keyboardEvents[0]);
+	frames[0].push_back(&mouseEvents[0]);
+	frames[2].push_back(&mouseEvents[1]);
+	frames[3].push_back(&keyboardEvents[1]);
+
+	const double frameTime = 1.0 / 60.0;
+	{
+		InputRecorder recorder(fileName);
+		for (size_t i = 0; i<frames.size(); ++i)
+		{
+			recorder.beginFrame(i * frameTime);
+			for (size_t j = 0; j<frames[i].size(); ++j) {
+				recorder.recordEvent(*frames[i][j]);
+			}
+		}
+		recorder.flush();
+		BOOST_CHECK_EQUAL( recorder.getNumFrames(), frames.size() );
+	}
+
+	InputPlayer                     player(fileName);
+	InputPlayer::input_event_vector frameEvents;
+	double                          time;
+	for (size_t i = 0; i<frames.size(); ++i)
+	{
+		BOOST_REQUIRE( player.nextFrame(time, frameEvents) );
+		BOOST_CHECK_EQUAL( time, i * frameTime );
+		BOOST_REQUIRE_EQUAL( frameEvents.size(), frames[i].size() );
+		for (size_t j = 0; j<frames[i].size(); ++j) {
+			check_equal(*frames[i][j], *frameEvents[j]);
+		}
+	}
+
+	BOOST_CHECK( !player.nextFrame(time, frameEvents) );
+	BOOST_CHECK( frameEvents.empty() );
+	BOOST_CHECK_EQUAL( player.getNumFrames(), frames.size() );
+
+	std::remove(fileName);
+}
@@ -0,0 +1,161 @@
+#include "Thread/StartStopTimer.h"
+#include "Utility/Memory/linear_allocator.hpp"
+#include "Utility/Memory/object_in_pool.hpp"
+#include "Utility/Memory/thread_cache.hpp"
+#include <boost/thread/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#define BOOST_TEST_MODULE MemoryPoolTest
+#include <boost/test/unit_test.hpp>
+
+using namespace slon;
+
+namespace {
+
+	const size_t num_objects    = 1 << 12;
+	const size_t num_iterations = 64;
+
+	struct pooled_object :
+		public object_in_pool<pooled_object>
+	{
+		char data[48];
+	};
+
+	struct heap_object
+	{
+		char data[48];
+	};
+
+	// allocate & free batches of objects, touching every object
+	template<typename T>
+	void allocation_loop(boost::barrier& barrier)
+	{
+		std::vector<T*> objects(num_objects);
+
+		barrier.wait();
+		for (size_t i = 0; i<num_iterations; ++i)
+		{
+			for (size_t j = 0; j<num_objects; ++j)
+			{
+				objects[j] = new T;
+				objects[j]->data[0] = char(j);
+			}
+
+			for (size_t j = 0; j<num_objects; ++j) {
+				delete objects[(j * 7) % num_objects];
+			}
+		}
+	}
+
+	template<typename T>
+	double run_threads(size_t numThreads)
+	{
+		boost::barrier      barrier(numThreads + 1);
+		boost::thread_group threads;
+		for (size_t i = 0; i<numThreads; ++i) {
+			threads.create_thread( boost::bind(&allocation_loop<T>, boost::ref(barrier)) );
+		}
+
+		StartStopTimer timer;
+		timer.start();
+		barrier.wait();
+		threads.join_all();
+
+		return timer.getTime();
+	}
+
+	// allocate in one thread, free in other
+	void producer(thread_cached_block_allocator<>& allocator, std::vector<void*>& blocks)
+	{
+		for (size_t i = 0; i<blocks.size(); ++i) {
+			blocks[i] = allocator.allocate();
+		}
+	}
+
+	void consumer(thread_cached_block_allocator<>& allocator, std::vector<void*>& blocks)
+	{
+		for (size_t i = 0; i<blocks.size(); ++i) {
+			allocator.deallocate(blocks[i]);
+		}
+	}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(thread_cache_cross_thread)
+{
+	thread_cached_block_allocator<> allocator(16, 0, 32, 8);
+
+	std::vector<void*> blocks[4];
+	for (size_t i = 0; i<4; ++i) {
+		blocks[i].resize(num_objects);
+	}
+
+	// allocate concurrently, every block must be unique
+	{
+		boost::thread_group threads;
+		for (size_t i = 0; i<4; ++i) {
+			threads.create_thread( boost::bind(producer, boost::ref(allocator), boost::ref(blocks[i])) );
+		}
+		threads.join_all();
+
+		std::vector<void*> all;
+		for (size_t i = 0; i<4; ++i) {
+			all.insert(all.end(), blocks[i].begin(), blocks[i].end());
+		}
+		std::sort(all.begin(), all.end());
+		BOOST_CHECK( std::adjacent_find(all.begin(), all.end()) == all.end() );
+	}
+
+	// free in the other threads, everything returns to the central list on thread exit
+	{
+		boost::thread_group threads;
+		for (size_t i = 0; i<4; ++i) {
+			threads.create_thread( boost::bind(consumer, boost::ref(allocator), boost::ref(blocks[(i + 1) % 4])) );
+		}
+		threads.join_all();
+	}
+
+	BOOST_CHECK_EQUAL(allocator.num_outstanding(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(object_in_pool_benchmark)
+{
+	std::cout << "threads\tpool (s)\tnew/delete (s)" << std::endl;
+	for (size_t numThreads = 1; numThreads <= 8; numThreads *= 2)
+	{
+		double poolTime = run_threads<pooled_object>(numThreads);
+		double heapTime = run_threads<heap_object>(numThreads);
+		std::cout << numThreads << "\t" << poolTime << "\t" << heapTime << std::endl;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(linear_arena_reuse)
+{
+	typedef std::vector< int, linear_allocator<int> > arena_vector;
+
+	linear_arena arena(1024);
+	for (size_t frame = 0; frame < 4; ++frame)
+	{
+		arena_vector values( (linear_allocator<int>(&arena)) );
+		for (size_t i = 0; i<num_objects; ++i) {
+			values.push_back( int(i) );
+		}
+
+		for (size_t i = 0; i<num_objects; ++i) {
+			BOOST_REQUIRE_EQUAL( values[i], int(i) );
+		}
+
+		// blocks are allocated during first frame only
+		BOOST_CHECK( arena.num_allocations() > 0 );
+		if (frame > 0) {
+			BOOST_CHECK_EQUAL( arena.num_heap_allocations(), 0u );
+		}
+
+		arena_vector( values.get_allocator() ).swap(values);
+		arena.reset();
+		arena.reset_statistics();
+	}
+}
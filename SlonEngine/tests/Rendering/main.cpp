@@ -0,0 +1,273 @@
+#define _DEBUG_NEW_REDEFINE_NEW 0
+#include "Engine.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystemManager.h"
+#include "Graphics/DeferredRenderer.h"
+#include "Graphics/Detail/EffectShaderProgram.h"
+#include "Graphics/ForwardRenderer.h"
+#include "Graphics/GraphicsManager.h"
+#include "Graphics/NullEffect.h"
+#include "Graphics/StaticMesh.h"
+#include "Realm/BVHLocation.h"
+#include "Realm/World.h"
+#include "Scene/DirectionalLight.h"
+#include "Scene/LookAtCamera.h"
+#include "Scene/MatrixTransform.h"
+#include "Thread/StartStopTimer.h"
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <iostream>
+
+#define BOOST_TEST_MODULE RenderingTest
+#include <boost/test/unit_test.hpp>
+
+using namespace slon;
+
+namespace {
+
+	// grid of the meshes around the origin, every mesh is subset of the null effect
+	void make_mesh_field(realm::Location& location, graphics::Effect* effect, unsigned numMeshes)
+	{
+		graphics::GPUSideMesh::DESC desc;
+		desc.aabb          = math::AABBf(-0.3f, -0.3f, -0.3f, 0.3f, 0.3f, 0.3f);
+		desc.vertexSize    = 0;
+		desc.numAttributes = 0;
+		desc.attributes    = 0;
+		desc.indexType     = sgl::IndexBuffer::UINT_32;
+
+		graphics::gpu_side_mesh_ptr mesh( new graphics::GPUSideMesh(desc) );
+		mesh->addPlainSubset(effect, sgl::TRIANGLES, 0, 36);
+
+		int side = int( std::sqrt( float(numMeshes) ) );
+		for (unsigned i = 0; i<numMeshes; ++i)
+		{
+			float x = float( int(i) % side - side / 2 );
+			float z = float( int(i) / side - side / 2 );
+			scene::MatrixTransform* transform = new scene::MatrixTransform( math::make_translation(x, 0.0f, z) );
+			transform->addChild( new graphics::StaticMesh(mesh) );
+			location.add(scene::node_ptr(transform), false, false);
+		}
+	}
+
+	// counts render signals of the cameras
+	struct count_renders
+	{
+		size_t* numRenders;
+
+		void operator () (const scene::Camera& /*camera*/) const { ++*numRenders; }
+	};
+
+	void write_file(const char* fileName, const std::string& content)
+	{
+		filesystem::file_ptr file( filesystem::currentFileSystemManager().createFile(fileName) );
+		BOOST_REQUIRE( file && file->open(filesystem::File::out) );
+		file->write( content.data(), content.length() );
+		file->close();
+	}
+
+	// spot light, deferred renderer ignores it
+	class test_spot_light :
+		public scene::Light
+	{
+	public:
+		test_spot_light()
+		:	aabb(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f)
+		{}
+
+		void               accept(scene::CullVisitor& visitor) const { visitor.addLight(this); }
+		const math::AABBf& getBounds() const      { return aabb; }
+		LIGHT_TYPE         getLightType() const   { return SPOT; }
+		bool               isShadowCaster() const { return false; }
+
+	private:
+		math::AABBf aabb;
+	};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(headless_frame_benchmark)
+{
+	using graphics::detail::CommandBuffer;
+	using graphics::detail::ForwardRenderer;
+
+	const unsigned num_meshes     = 16384;
+	const unsigned num_cameras    = 4;
+	const unsigned num_iterations = 20;
+
+	// no window and device, renderer only records commands
+	graphics::GraphicsManager& graphicsManager = Engine::Instance()->getGraphicsManager();
+	graphics::ForwardRendererDesc desc;
+	desc.useMultiViewCulling = true;
+
+	ForwardRenderer* renderer = static_cast<ForwardRenderer*>( graphicsManager.initHeadlessRenderer(desc) );
+	BOOST_REQUIRE(renderer);
+	BOOST_CHECK(renderer->isHeadless());
+
+	graphics::null_effect_ptr effect( new graphics::NullEffect(1 << ForwardRenderer::RP_OPAQUE) );
+	realm::location_ptr location( new realm::BVHLocation );
+	make_mesh_field(*location, effect.get(), num_meshes);
+
+	realm::World& world = *Engine::Instance()->getWorld();
+	world.addLocation(location);
+
+	scene::camera_ptr cameras[num_cameras];
+	for (unsigned i = 0; i<num_cameras; ++i)
+	{
+		float angle = 2.0f * 3.1415926f * i / num_cameras;
+		scene::LookAtCamera* camera = new scene::LookAtCamera;
+		camera->setPosition( math::Vector3f(0.0f, 1.0f, 0.0f) );
+		camera->setDirection( math::Vector3f( std::sin(angle), 0.0f, -std::cos(angle) ) );
+		camera->setProjectionMatrix( math::Matrix4f::perspective(1.5f, 4.0f / 3.0f, 1.0f, 150.0f) );
+		camera->setViewport( sgl::rectangle(0, 0, 800, 600) );
+		graphicsManager.addCamera(camera);
+		cameras[i].reset(camera);
+	}
+
+	// headless renderer signals every camera as the regular one
+	size_t        numPreRenders  = 0;
+	size_t        numPostRenders = 0;
+	count_renders countPre       = { &numPreRenders };
+	count_renders countPost      = { &numPostRenders };
+	graphics::Renderer::connection_type preConnection  = renderer->connectPreRenderCallback(countPre);
+	graphics::Renderer::connection_type postConnection = renderer->connectPostRenderCallback(countPost);
+
+	// first frame warms up the frame arena
+	graphicsManager.render(world);
+	BOOST_CHECK_EQUAL(numPreRenders, num_cameras);
+	BOOST_CHECK_EQUAL(numPostRenders, num_cameras);
+	renderer->disconnectPreRenderCallback(preConnection);
+	renderer->disconnectPostRenderCallback(postConnection);
+
+	StartStopTimer timer;
+	timer.start();
+	for (unsigned i = 0; i<num_iterations; ++i) {
+		graphicsManager.render(world);
+	}
+	double frameTime = timer.getTime() / num_iterations;
+
+	// statistics of the previous frame are taken when the frame begins
+	graphicsManager.render(world);
+	const ForwardRenderer::FRAME_STATISTICS& statistics = renderer->getFrameStatistics();
+	size_t numDraws = statistics.commands.numCommands[CommandBuffer::DRAW];
+	BOOST_CHECK(numDraws > 0);
+	BOOST_CHECK_EQUAL(statistics.numWorldTraversals, 1u);
+
+	std::cout << "meshes\tcameras\tdraws\tframe time\tcull time\trecord time" << std::endl
+	          << num_meshes << "\t"
+	          << num_cameras << "\t"
+	          << numDraws << "\t"
+	          << frameTime << "\t"
+	          << statistics.cullTime << "\t"
+	          << statistics.recordTime << std::endl;
+
+	world.removeLocation(location);
+	for (unsigned i = 0; i<num_cameras; ++i) {
+		graphicsManager.removeCamera( cameras[i].get() );
+	}
+}
+
+BOOST_AUTO_TEST_CASE(headless_deferred_frame)
+{
+	using graphics::detail::CommandBuffer;
+	using graphics::detail::DeferredRenderer;
+	using graphics::detail::ForwardRenderer;
+
+	const unsigned num_meshes = 64;
+
+	graphics::GraphicsManager& graphicsManager = Engine::Instance()->getGraphicsManager();
+	graphics::DeferredRendererDesc desc;
+
+	DeferredRenderer* renderer = static_cast<DeferredRenderer*>( graphicsManager.initHeadlessRenderer(desc) );
+	BOOST_REQUIRE(renderer);
+	BOOST_CHECK(renderer->isHeadless());
+	BOOST_CHECK_EQUAL(renderer->getRenderTechnique(), graphics::Renderer::DEFERRED_SHADING);
+
+	// meshes are written into the g-buffer, spot light is not supported and ignored
+	graphics::null_effect_ptr effect( new graphics::NullEffect( (1 << DeferredRenderer::RP_GBUFFER) | (1 << ForwardRenderer::RP_SPOT_LIGHTING) ) );
+	realm::location_ptr location( new realm::BVHLocation );
+	make_mesh_field(*location, effect.get(), num_meshes);
+
+	scene::MatrixTransform* spotTransform = new scene::MatrixTransform( math::make_translation(0.0f, 0.0f, -3.0f) );
+	spotTransform->addChild( new test_spot_light );
+	location->add(scene::node_ptr(spotTransform), false, false);
+
+	realm::World& world = *Engine::Instance()->getWorld();
+	scene::node_ptr directionalLight( new scene::DirectionalLight );
+	world.addLocation(location);
+	world.addInfiniteNode(directionalLight);
+
+	scene::LookAtCamera* camera = new scene::LookAtCamera;
+	scene::camera_ptr cameraPtr(camera);
+	camera->setPosition( math::Vector3f(0.0f, 1.0f, 0.0f) );
+	camera->setDirection( math::Vector3f(0.0f, 0.0f, -1.0f) );
+	camera->setProjectionMatrix( math::Matrix4f::perspective(1.5f, 4.0f / 3.0f, 1.0f, 150.0f) );
+	camera->setViewport( sgl::rectangle(0, 0, 800, 600) );
+	graphicsManager.addCamera(camera);
+
+	size_t        numPostRenders = 0;
+	count_renders countPost      = { &numPostRenders };
+	graphics::Renderer::connection_type postConnection = renderer->connectPostRenderCallback(countPost);
+
+	// statistics of the previous frame are taken when the frame begins
+	graphicsManager.render(world);
+	graphicsManager.render(world);
+	renderer->disconnectPostRenderCallback(postConnection);
+	BOOST_CHECK_EQUAL(numPostRenders, 2u);
+
+	// deferred and forward directional passes, no spot pass
+	const ForwardRenderer::FRAME_STATISTICS& statistics = renderer->getFrameStatistics();
+	BOOST_CHECK_EQUAL(statistics.numLightingPasses, 2u);
+	BOOST_CHECK(statistics.commands.numCommands[CommandBuffer::DRAW] > 0);
+
+	world.removeInfiniteNode(directionalLight);
+	world.removeLocation(location);
+	graphicsManager.removeCamera(camera);
+}
+
+BOOST_AUTO_TEST_CASE(shader_source_cache)
+{
+	using graphics::EffectShaderProgram;
+
+	const char* fileName = "./test_shader.frag";
+	write_file(fileName, "#version 120\nvoid main() {}\n");
+
+	EffectShaderProgram::clearSourceCache();
+	BOOST_CHECK( EffectShaderProgram::cacheSource(fileName) );
+	BOOST_CHECK( !EffectShaderProgram::cacheSource(fileName) );
+
+	// modification time is the part of the cache key
+	std::time_t writeTime = boost::filesystem::last_write_time(fileName);
+	boost::filesystem::last_write_time(fileName, writeTime + 10);
+	BOOST_CHECK( EffectShaderProgram::cacheSource(fileName) );
+	BOOST_CHECK( !EffectShaderProgram::cacheSource(fileName) );
+
+	EffectShaderProgram::clearSourceCache();
+	boost::filesystem::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(shader_manifest_round_trip)
+{
+	using graphics::EffectShaderProgram;
+	typedef EffectShaderProgram::uber_program_hash uber_program_hash;
+
+	// sorted as by EffectShaderProgram::constructProgram
+	const char* definitions[] = { "#define DIRECTIONAL_LIGHTING", "#define NUM_LIGHTS 2" };
+	const char* shaders[]     = { "Data/Shaders/Forward/lighting.frag", "Data/Shaders/rigid.vert" };
+
+	EffectShaderProgram::program_manifest programs;
+	programs.push_back( uber_program_hash(definitions, definitions + 2, shaders, shaders + 2) );
+	programs.push_back( uber_program_hash(definitions, definitions, shaders + 1, shaders + 2) );
+
+	const char* fileName = "./test_manifest";
+	BOOST_REQUIRE( EffectShaderProgram::saveManifest(fileName, programs) );
+
+	EffectShaderProgram::program_manifest loaded;
+	BOOST_REQUIRE( EffectShaderProgram::loadManifest(fileName, loaded) );
+	BOOST_REQUIRE_EQUAL( loaded.size(), programs.size() );
+	for (size_t i = 0; i<programs.size(); ++i) {
+		BOOST_CHECK( !(loaded[i] < programs[i]) && !(programs[i] < loaded[i]) );
+	}
+
+	boost::filesystem::remove(fileName);
+	BOOST_CHECK( !EffectShaderProgram::loadManifest(fileName, loaded) );
+}
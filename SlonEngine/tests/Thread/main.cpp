@@ -0,0 +1,295 @@
+#include "Log/Logger.h"
+#include "Thread/LockFreeQueue.h"
+#include "Thread/LockStatistics.h"
+#include "Thread/StartStopTimer.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/Utility.h"
+#include "Utility/Algorithm/parallel.hpp"
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#define BOOST_TEST_MODULE ThreadTest
+#include <boost/test/unit_test.hpp>
+
+DECLARE_AUTO_LOGGER("tests.Thread")
+
+using namespace slon;
+
+namespace {
+
+	const size_t num_items_per_producer = 1 << 10;
+	const size_t num_rounds             = 256;
+	const size_t num_tasks              = 1 << 12;
+
+	struct update_request :
+		public thread::mpsc_queue_hook<update_request>
+	{
+		update_request() : numUpdates(0) {}
+
+		int numUpdates;
+	};
+
+	typedef std::vector<update_request*> request_vector;
+
+	// queue as it was in the engine: vector under mutex
+	struct locked_queue
+	{
+		void push(update_request* request)
+		{
+			boost::lock_guard<boost::mutex> lock(mutex);
+			requests.push_back(request);
+		}
+
+		template<typename OutputIterator>
+		OutputIterator pop_all(OutputIterator out)
+		{
+			request_vector tmp;
+			{
+				boost::lock_guard<boost::mutex> lock(mutex);
+				tmp.swap(requests);
+			}
+			return std::copy(tmp.begin(), tmp.end(), out);
+		}
+
+		boost::mutex	mutex;
+		request_vector	requests;
+	};
+
+	// every producer enqueues its items twice per round, consumer processes requests
+	template<typename Queue>
+	void producer(Queue& queue, boost::barrier& barrier, update_request* items)
+	{
+		for (size_t round = 0; round < num_rounds; ++round)
+		{
+			barrier.wait();
+			for (size_t i = 0; i<num_items_per_producer; ++i)
+			{
+				queue.push(&items[i]);
+				queue.push(&items[i]);
+			}
+			barrier.wait();
+		}
+	}
+
+	template<typename Queue>
+	double run_producers(size_t numProducers, std::vector<update_request>& items)
+	{
+		Queue               queue;
+		boost::barrier      barrier(numProducers + 1);
+		boost::thread_group threads;
+		for (size_t i = 0; i<numProducers; ++i) {
+			threads.create_thread( boost::bind(&producer<Queue>, boost::ref(queue), boost::ref(barrier), &items[i * num_items_per_producer]) );
+		}
+
+		StartStopTimer timer;
+		timer.start();
+
+		request_vector requests;
+		for (size_t round = 0; round < num_rounds; ++round)
+		{
+			barrier.wait();
+			barrier.wait();
+
+			requests.clear();
+			queue.pop_all( std::back_inserter(requests) );
+			for (size_t i = 0; i<requests.size(); ++i) {
+				++requests[i]->numUpdates;
+			}
+		}
+		threads.join_all();
+
+		return timer.getTime();
+	}
+
+	void count_task(std::vector<int>& counts, size_t i)
+	{
+		++counts[i];
+	}
+
+	// pool is busy, nested job is performed sequentially
+	void nested_task(thread::ThreadPool& pool, std::vector< std::vector<int> >& counts, size_t i)
+	{
+		pool.run( counts[i].size(), boost::bind(&count_task, boost::ref(counts[i]), _1) );
+	}
+
+	typedef thread::instrumented_mutex<boost::mutex> instrumented_mutex;
+
+	void lock_loop(instrumented_mutex& mutex, boost::barrier& barrier, int& counter)
+	{
+		barrier.wait();
+		for (size_t i = 0; i<num_tasks; ++i)
+		{
+			boost::lock_guard<instrumented_mutex> lock(mutex);
+			++counter;
+		}
+	}
+
+	struct fill_indices
+	{
+		void operator () (size_t first, size_t last) const
+		{
+			for (size_t i = first; i<last; ++i) {
+				(*values)[i] = int(i);
+			}
+		}
+
+		std::vector<int>* values;
+	};
+
+	struct sum_values
+	{
+		long operator () (size_t first, size_t last) const
+		{
+			long sum = 0;
+			for (size_t i = first; i<last; ++i) {
+				sum += (*values)[i];
+			}
+			return sum;
+		}
+
+		const std::vector<int>* values;
+	};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(mpsc_queue_order)
+{
+	std::vector<update_request> items(16);
+	thread::mpsc_queue<update_request> queue;
+	for (size_t i = 0; i<items.size(); ++i) {
+		BOOST_CHECK( queue.push(&items[i]) );
+	}
+	BOOST_CHECK( !queue.push(&items[0]) );
+
+	request_vector requests;
+	queue.pop_all( std::back_inserter(requests) );
+	BOOST_REQUIRE_EQUAL( requests.size(), items.size() );
+	for (size_t i = 0; i<items.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL( requests[i], &items[i] );
+		BOOST_CHECK( !items[i].in_queue() );
+	}
+	BOOST_CHECK( queue.empty() );
+}
+
+BOOST_AUTO_TEST_CASE(update_queue_contention)
+{
+	std::cout << "producers\tmpsc_queue (s)\tlocked vector (s)" << std::endl;
+	for (size_t numProducers = 1; numProducers <= 8; numProducers *= 2)
+	{
+		std::vector<update_request> items(numProducers * num_items_per_producer);
+		double lockFreeTime = run_producers< thread::mpsc_queue<update_request> >(numProducers, items);
+
+		// duplicates are dropped by the lock free queue
+		for (size_t i = 0; i<items.size(); ++i) {
+			BOOST_CHECK_EQUAL(items[i].numUpdates, int(num_rounds));
+		}
+
+		double lockedTime = run_producers<locked_queue>(numProducers, items);
+		std::cout << numProducers << "\t" << lockFreeTime << "\t" << lockedTime << std::endl;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_run)
+{
+	thread::ThreadPool pool(3);
+	BOOST_CHECK_EQUAL(pool.getNumWorkers(), 3u);
+
+	for (size_t round = 0; round < num_rounds; ++round)
+	{
+		std::vector<int> counts(num_tasks);
+		pool.run( counts.size(), boost::bind(&count_task, boost::ref(counts), _1) );
+		BOOST_CHECK( std::count(counts.begin(), counts.end(), 1) == int(num_tasks) );
+	}
+
+	std::vector< std::vector<int> > nestedCounts( 4, std::vector<int>(num_items_per_producer) );
+	pool.run( nestedCounts.size(), boost::bind(&nested_task, boost::ref(pool), boost::ref(nestedCounts), _1) );
+	for (size_t i = 0; i<nestedCounts.size(); ++i) {
+		BOOST_CHECK( std::count(nestedCounts[i].begin(), nestedCounts[i].end(), 1) == int(num_items_per_producer) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_placement)
+{
+	// pin workers to the first processor the process is allowed to run on
+	unsigned long long allowedMask = thread::getCurrentThreadAffinity();
+	unsigned long long firstMask   = allowedMask & (~allowedMask + 1);
+
+	thread::THREAD_DESC desc;
+	desc.name         = "test-worker";
+	desc.affinityMask = firstMask;
+
+	thread::ThreadPool pool(2, desc);
+
+	for (size_t i = 0; i<pool.getNumWorkers(); ++i)
+	{
+		thread::THREAD_PLACEMENT placement = pool.getWorkerPlacement(i);
+		BOOST_CHECK( placement.started );
+		if (firstMask) {
+			BOOST_CHECK_EQUAL( placement.affinityMask, firstMask );
+		}
+		AUTO_LOGGER_MESSAGE( log::S_NOTICE, placement.name << "\taffinity " << std::hex << placement.affinityMask << std::dec 
+		                                    << "\tpriority " << placement.priority << std::endl );
+	}
+}
+
+BOOST_AUTO_TEST_CASE(parallel_algorithms)
+{
+	thread::ThreadPool pool(3);
+	std::vector<int>   values(num_tasks * 25 + 3);
+
+	fill_indices fill = { &values };
+	parallel_for(pool, 0, values.size(), 1000, fill);
+	for (size_t i = 0; i<values.size(); ++i) {
+		BOOST_REQUIRE_EQUAL( values[i], int(i) );
+	}
+
+	sum_values sum = { &values };
+	long total = parallel_reduce<long>( pool, 0, values.size(), 1000, sum, std::plus<long>() );
+	BOOST_CHECK_EQUAL( total, long(values.size()) * long(values.size() - 1) / 2 );
+
+	for (size_t i = 0; i<values.size(); ++i) {
+		values[i] = rand();
+	}
+	std::vector<int> sorted(values);
+	std::sort( sorted.begin(), sorted.end() );
+	parallel_sort( pool, values.begin(), values.end(), std::less<int>(), 1000 );
+	BOOST_CHECK( values == sorted );
+}
+
+BOOST_AUTO_TEST_CASE(lock_statistics)
+{
+	instrumented_mutex  mutex("test.mutex");
+	boost::barrier      barrier(4);
+	boost::thread_group threads;
+	int                 counter = 0;
+	for (size_t i = 0; i<4; ++i) {
+		threads.create_thread( boost::bind(&lock_loop, boost::ref(mutex), boost::ref(barrier), boost::ref(counter)) );
+	}
+	threads.join_all();
+	BOOST_CHECK_EQUAL( counter, int(4 * num_tasks) );
+
+	// same name - same statistics
+	BOOST_CHECK_EQUAL( thread::get_lock_statistics("test.mutex"), thread::get_lock_statistics("test.mutex") );
+#ifdef SLON_ENGINE_THREAD_STATISTICS
+	const thread::lock_statistics& statistics = *thread::get_lock_statistics("test.mutex");
+	BOOST_CHECK_EQUAL( statistics.numAcquisitions, long(4 * num_tasks) );
+
+	long numWaits = 0;
+	for (size_t i = 0; i<thread::lock_wait_histogram_size; ++i) {
+		numWaits += statistics.waitHistogram[i];
+	}
+	BOOST_CHECK_EQUAL( numWaits, statistics.numContendedAcquisitions );
+	thread::dump_lock_statistics(std::cout);
+
+	thread::reset_lock_statistics();
+	BOOST_CHECK_EQUAL( statistics.numAcquisitions, 0 );
+#endif
+}
@@ -0,0 +1,28 @@
+#if defined(ENABLE_NORMAL_HEIGHT_MAP) || defined(ENABLE_DIFFUSE_SPECULAR_MAP)
+#define ENABLE_TEXTURING
+#endif
+
+// uniforms
+uniform sampler2D diffuseSpecularMap;
+
+uniform vec4  	materialDiffuseSpecular;
+uniform float 	materialShininess;
+
+// varyings
+varying vec3  	fp_position;
+varying vec3	fp_normal;
+#ifdef ENABLE_TEXTURING
+varying	vec2	fp_texcoord;
+#endif
+
+void main()
+{
+	vec4 diffuseSpecular = materialDiffuseSpecular;
+#ifdef ENABLE_DIFFUSE_SPECULAR_MAP
+	diffuseSpecular     *= texture2D(diffuseSpecularMap, fp_texcoord);
+#endif
+
+	// view space normal packed into [0, 1], shininess is stored divided by 128
+	gl_FragData[0] = diffuseSpecular;
+	gl_FragData[1] = vec4( 0.5 * normalize(fp_normal) + 0.5, materialShininess / 128.0 );
+}
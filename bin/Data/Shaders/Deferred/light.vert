@@ -0,0 +1,10 @@
+// attributes
+attribute vec4 	position;
+
+// uniforms
+uniform mat4	lightVolumeMatrix;
+
+void main()
+{
+	gl_Position = lightVolumeMatrix * position;
+}
@@ -0,0 +1,83 @@
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS 1
+#endif
+
+// uniforms
+uniform sampler2D gbufferDiffuseSpecularMap;
+uniform sampler2D gbufferNormalShininessMap;
+uniform sampler2D gbufferDepthMap;
+uniform vec4	gbufferScaleBias;
+uniform mat4	invProjectionMatrix;
+
+uniform vec4	lightDirectionAmbient[NUM_LIGHTS];
+uniform vec4	lightPositionRadius[NUM_LIGHTS];
+uniform vec4  	lightColorIntensity[NUM_LIGHTS];
+
+vec3 contributeDirectionalLight(int index, vec4 diffuseSpecular, float shininess, vec3 normal, vec3 eyeDir)
+{
+    float dotValue 		 = -dot(lightDirectionAmbient[index].xyz, normal);
+    vec3  ambient        = diffuseSpecular.rgb;
+    vec3  diffuse 		 = diffuseSpecular.rgb * max(dotValue, 0.0);
+    float specular 		 = diffuseSpecular.a * pow( max( -dot(lightDirectionAmbient[index].xyz, reflect(eyeDir, normal)), 0.0), shininess);
+
+	return ambient * lightDirectionAmbient[index].a
+           + (diffuse * lightColorIntensity[index].rgb + specular * lightColorIntensity[index].rgb) * lightColorIntensity[index].a;
+}
+
+vec3 contributePointLight(int index, vec4 diffuseSpecular, float shininess, vec3 normal, vec3 position)
+{
+	// light volume is coarse, so lighting is cut at the radius
+	vec3 lightVec		 = lightPositionRadius[index].xyz - position;
+	if ( dot(lightVec, lightVec) > lightPositionRadius[index].w * lightPositionRadius[index].w ) {
+		return vec3(0.0);
+	}
+
+	vec3 lightDir		 = normalize(lightVec);
+	vec3 eyeDir			 = normalize(position);
+
+    float dotValue 		 = dot(lightDir, normal);
+    vec3  diffuse 		 = diffuseSpecular.rgb * max(dotValue, 0.0);
+    float specular 		 = diffuseSpecular.a * pow( max( dot(lightDir, reflect(eyeDir, normal)), 0.0), shininess);
+
+	return (diffuse * lightColorIntensity[index].rgb + specular * lightColorIntensity[index].rgb) * lightColorIntensity[index].a;
+}
+
+void main()
+{
+	vec2  texcoord = gl_FragCoord.xy * gbufferScaleBias.xy + gbufferScaleBias.zw;
+	float depth    = texture2D(gbufferDepthMap, texcoord).r;
+
+#ifdef RESOLVE
+	// restore scene depth for the forward passes
+	gl_FragDepth = depth;
+	gl_FragColor = vec4(0.0);
+#else
+	// background
+	if (depth == 1.0) {
+		discard;
+	}
+
+	vec4  clipPosition    = vec4(2.0 * texcoord - 1.0, 2.0 * depth - 1.0, 1.0);
+	vec4  viewPosition    = invProjectionMatrix * clipPosition;
+	vec3  position        = viewPosition.xyz / viewPosition.w;
+
+	vec4  diffuseSpecular = texture2D(gbufferDiffuseSpecularMap, texcoord);
+	vec4  normalShininess = texture2D(gbufferNormalShininessMap, texcoord);
+	vec3  normal          = normalize(2.0 * normalShininess.xyz - 1.0);
+	float shininess       = normalShininess.w * 128.0;
+
+	vec3 color = vec3(0.0);
+#ifdef DIRECTIONAL_LIGHTING
+	vec3 eyeDir = normalize(position);
+	for (int i = 0; i<NUM_LIGHTS; ++i) {
+		color += contributeDirectionalLight(i, diffuseSpecular, shininess, normal, eyeDir);
+	}
+#elif defined(POINT_LIGHTING)
+	for (int i = 0; i<NUM_LIGHTS; ++i) {
+		color += contributePointLight(i, diffuseSpecular, shininess, normal, position);
+	}
+#endif
+
+	gl_FragColor = vec4(color, 0.0);
+#endif // RESOLVE
+}
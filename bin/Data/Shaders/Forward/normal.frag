@@ -4,6 +4,14 @@
 
 // uniforms
 uniform float   opacity;
+#ifdef CLUSTERED_LIGHTING
+uniform sampler2D lightGridMap;
+uniform sampler2D lightIndexMap;
+uniform vec4      lightGridScaleBias;
+uniform vec4      lightGridDepthParams;
+uniform vec4      lightGridMapSize;
+uniform vec4      lightIndexMapSize;
+#endif
 
 // varyings
 varying vec3  	fp_position;
@@ -68,6 +76,25 @@ void main()
 									#endif
 										fp_position );										 
 	}
+#elif defined(CLUSTERED_LIGHTING)
+	// find cluster of the fragment, shade lights from the cluster list
+	vec2  tile    = floor(gl_FragCoord.xy * lightGridScaleBias.xy + lightGridScaleBias.zw);
+	float slice   = clamp( floor( log(-fp_position.z * lightGridDepthParams.x) * lightGridDepthParams.y ), 0.0, lightGridDepthParams.z - 1.0 );
+	vec4  cluster = texture2D( lightGridMap, (vec2(tile.x + slice * lightGridDepthParams.w, tile.y) + 0.5) * lightGridMapSize.xy );
+	for (int i = 0; i<int(cluster.y); ++i) 
+	{
+		float index = cluster.x + float(i);
+		float row   = floor(index * lightIndexMapSize.x);
+		float light = texture2D( lightIndexMap, (vec2(index - row * lightIndexMapSize.z, row) + 0.5) * lightIndexMapSize.xy ).r;
+		color += contributePointLight( 	int(light + 0.5),
+									#ifdef ENABLE_TEXTURING
+										fp_texcoord,
+									#endif
+									#ifndef ENABLE_NORMAL_HEIGHT_MAP
+										normalNorm,
+									#endif
+										fp_position );
+	}
 #endif
 
 	gl_FragColor = vec4(color, opacity);